@@ -0,0 +1,339 @@
+#ifndef GPUCULLING_H
+#define GPUCULLING_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "MemoryAllocator.h"
+#include "SceneGraph.h"
+
+// GPU 视锥剔除：计算着色器（shaders/cull.comp）先逐实例测试世界空间包围盒，把可见实例压缩复制到
+// 输出实例缓冲区中所属网格的区间，再按各网格的可见实例数从原始间接绘制命令生成输出命令。
+// 图形通道以输出实例缓冲区作为绑定 1。compact 模式下有可见实例的命令压缩到前部，
+// 图形通道用 vkCmdDrawIndexedIndirectCount 绘制；否则命令写回原位置，没有可见实例的 instanceCount 为 0，
+// 图形通道按固定数量间接绘制。
+// 资源按飞行中的帧分开，每帧的栅栏等待后才重建该帧的资源，因此不需要延迟销毁
+class GpuCuller {
+public:
+    GpuCuller(VkDevice device, DeviceMemoryAllocator* allocator, VkPipelineCache pipelineCache, uint32_t frameCount,
+        const std::vector<char>& shaderCode, bool compact)
+        : device(device), allocator(allocator), compact(compact), frames(frameCount) {
+        VkDescriptorSetLayoutBinding bindings[BINDING_COUNT] = {};
+        for (uint32_t i = 0; i < BINDING_COUNT; i++) {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = BINDING_COUNT;
+        layoutInfo.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("创建剔除描述符集布局失败！");
+        }
+
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.size = sizeof(CullParameters);
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("创建剔除管线布局失败！");
+        }
+
+        VkShaderModuleCreateInfo moduleInfo = {};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = shaderCode.size();
+        moduleInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+        VkShaderModule shaderModule;
+        if (vkCreateShaderModule(device, &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("创建剔除着色器模块失败！");
+        }
+
+        VkComputePipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = shaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = pipelineLayout;
+        VkResult result = vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+        vkDestroyShaderModule(device, shaderModule, nullptr);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("创建剔除计算管线失败！");
+        }
+
+        VkDescriptorPoolSize poolSize = {};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = BINDING_COUNT * frameCount;
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = frameCount;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("创建剔除描述符池失败！");
+        }
+
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, descriptorSetLayout);
+        std::vector<VkDescriptorSet> sets(frameCount);
+        VkDescriptorSetAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = frameCount;
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("分配剔除描述符集失败！");
+        }
+
+        // 可见数量由主机在该帧栅栏等待后读取，作为剔除统计
+        for (uint32_t i = 0; i < frameCount; i++) {
+            frames[i].descriptorSet = sets[i];
+            allocator->createBuffer(sizeof(DrawCounts),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                frames[i].countBuffer, frames[i].countMemory);
+            memset(frames[i].countMemory.mappedData, 0, sizeof(DrawCounts));
+        }
+    }
+
+    ~GpuCuller() {
+        for (FrameResources& frame : frames) {
+            allocator->destroyBuffer(frame.boundsBuffer, frame.boundsMemory);
+            allocator->destroyBuffer(frame.commandBuffer, frame.commandMemory);
+            allocator->destroyBuffer(frame.countBuffer, frame.countMemory);
+            allocator->destroyBuffer(frame.instanceBuffer, frame.instanceMemory);
+            allocator->destroyBuffer(frame.instanceCountBuffer, frame.instanceCountMemory);
+        }
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+    }
+
+    GpuCuller(const GpuCuller&) = delete;
+    GpuCuller& operator=(const GpuCuller&) = delete;
+
+    // 可见命令是否压缩到输出缓冲区前部（配合 vkCmdDrawIndexedIndirectCount）
+    bool isCompact() const {
+        return compact;
+    }
+
+    // 在渲染通道之外录制一帧的剔除。scene 的绘制项与 sourceCommands 中的命令一一对应，实例与 sourceInstances
+    // 中的 MeshInstance 一一对应，两者都需带 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT。调用前该帧的栅栏必须已等待
+    void record(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkBuffer sourceCommands, uint32_t drawCount,
+        VkBuffer sourceInstances, const std::shared_ptr<const SceneData>& scene, const Frustum& frustum) {
+        FrameResources& frame = frames[frameIndex];
+        if (frame.scene != scene || frame.sourceCommands != sourceCommands || frame.sourceInstances != sourceInstances) {
+            updateFrame(frame, sourceCommands, drawCount, sourceInstances, scene);
+        }
+        uint32_t instanceCount = static_cast<uint32_t>(scene->instanceMeshes.size());
+
+        vkCmdFillBuffer(commandBuffer, frame.countBuffer, 0, sizeof(DrawCounts), 0);
+        vkCmdFillBuffer(commandBuffer, frame.instanceCountBuffer, 0, sizeof(uint32_t) * drawCount, 0);
+        VkMemoryBarrier clearBarrier = {};
+        clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+            1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+        CullParameters parameters = {};
+        for (int i = 0; i < 6; i++) {
+            parameters.planes[i][0] = frustum.planes[i].x;
+            parameters.planes[i][1] = frustum.planes[i].y;
+            parameters.planes[i][2] = frustum.planes[i].z;
+            parameters.planes[i][3] = frustum.planes[i].w;
+        }
+        parameters.compact = compact ? 1 : 0;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+
+        // 逐实例剔除，累加各网格的可见实例数
+        parameters.inputCount = instanceCount;
+        parameters.phase = 0;
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(parameters), &parameters);
+        vkCmdDispatch(commandBuffer, (instanceCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+        VkMemoryBarrier instanceBarrier = {};
+        instanceBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        instanceBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        instanceBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+            1, &instanceBarrier, 0, nullptr, 0, nullptr);
+
+        // 逐网格生成命令
+        parameters.inputCount = drawCount;
+        parameters.phase = 1;
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(parameters), &parameters);
+        vkCmdDispatch(commandBuffer, (drawCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+        // 输出命令和数量供间接绘制读取，输出实例作为顶点属性读取，数量同时在栅栏等待后由主机读取
+        VkMemoryBarrier outputBarrier = {};
+        outputBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        outputBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        outputBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0,
+            1, &outputBarrier, 0, nullptr, 0, nullptr);
+        frame.recorded = true;
+    }
+
+    // 该帧的输出间接命令缓冲区
+    VkBuffer getCommandBuffer(uint32_t frameIndex) const {
+        return frames[frameIndex].commandBuffer;
+    }
+
+    // 该帧的绘制数量缓冲区，偏移 0 处的 uint32 为输出命令数量
+    VkBuffer getCountBuffer(uint32_t frameIndex) const {
+        return frames[frameIndex].countBuffer;
+    }
+
+    // 该帧的输出实例缓冲区，绘制时代替原实例缓冲区绑定到绑定 1
+    VkBuffer getInstanceBuffer(uint32_t frameIndex) const {
+        return frames[frameIndex].instanceBuffer;
+    }
+
+    // 该帧上一次执行剔除得到的可见实例数量，只能在该帧栅栏等待后、重新录制前读取；从未执行过时返回 false
+    bool readVisibleCount(uint32_t frameIndex, uint32_t& visible) const {
+        const FrameResources& frame = frames[frameIndex];
+        if (!frame.recorded) {
+            return false;
+        }
+        visible = static_cast<const DrawCounts*>(frame.countMemory.mappedData)->visibleInstances;
+        return true;
+    }
+
+private:
+    static constexpr uint32_t WORKGROUP_SIZE = 64;  // 与 cull.comp 的 local_size_x 一致
+    static constexpr uint32_t BINDING_COUNT = 7;    // 与 cull.comp 的存储缓冲区绑定数量一致
+    static constexpr VkDeviceSize INSTANCE_STRIDE = sizeof(float) * 24;  // MeshInstance 的大小（mat4 + 两个 vec4）
+
+    // 与 cull.comp 中的 InstanceBounds 布局一致
+    struct InstanceBounds {
+        float boundsMin[3];
+        uint32_t mesh;
+        float boundsMax[3];
+        uint32_t padding;
+    };
+
+    // 与 cull.comp 中的 DrawCountBuffer 布局一致
+    struct DrawCounts {
+        uint32_t drawCount;
+        uint32_t visibleInstances;
+    };
+
+    // 与 cull.comp 中的推送常量布局一致
+    struct CullParameters {
+        float planes[6][4];
+        uint32_t inputCount;
+        uint32_t compact;
+        uint32_t phase;
+    };
+
+    struct FrameResources {
+        std::shared_ptr<const SceneData> scene;       // 包围盒数据对应的场景快照
+        VkBuffer sourceCommands = VK_NULL_HANDLE;     // 描述符集引用的原始命令缓冲区
+        VkBuffer sourceInstances = VK_NULL_HANDLE;    // 描述符集引用的原始实例缓冲区
+        VkBuffer boundsBuffer = VK_NULL_HANDLE;       // 逐实例世界空间包围盒，主机可见
+        MemoryAllocation boundsMemory;
+        VkDeviceSize boundsCapacity = 0;
+        VkBuffer commandBuffer = VK_NULL_HANDLE;      // 剔除后的间接命令
+        MemoryAllocation commandMemory;
+        VkDeviceSize commandCapacity = 0;
+        VkBuffer countBuffer = VK_NULL_HANDLE;        // 输出命令数量和可见实例数量
+        MemoryAllocation countMemory;
+        VkBuffer instanceBuffer = VK_NULL_HANDLE;     // 按网格压缩后的可见实例
+        MemoryAllocation instanceMemory;
+        VkDeviceSize instanceCapacity = 0;
+        VkBuffer instanceCountBuffer = VK_NULL_HANDLE;  // 各网格的可见实例数
+        MemoryAllocation instanceCountMemory;
+        VkDeviceSize instanceCountCapacity = 0;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        bool recorded = false;                        // 是否已录制过剔除
+    };
+
+    VkDevice device;
+    DeviceMemoryAllocator* allocator;
+    bool compact;
+    std::vector<FrameResources> frames;
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+
+    // 按需扩容（两倍增长）一个逐帧缓冲区
+    void reserveBuffer(VkBuffer& buffer, MemoryAllocation& memory, VkDeviceSize& capacity, VkDeviceSize size,
+        VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+        if (size <= capacity) {
+            return;
+        }
+        allocator->destroyBuffer(buffer, memory);
+        capacity = std::max(capacity * 2, size);
+        allocator->createBuffer(capacity, usage, properties, buffer, memory);
+    }
+
+    // 场景、命令缓冲区或实例缓冲区变化后重写该帧的包围盒并更新描述符
+    void updateFrame(FrameResources& frame, VkBuffer sourceCommands, uint32_t drawCount, VkBuffer sourceInstances,
+        const std::shared_ptr<const SceneData>& scene) {
+        uint32_t instanceCount = static_cast<uint32_t>(scene->instanceMeshes.size());
+        reserveBuffer(frame.boundsBuffer, frame.boundsMemory, frame.boundsCapacity,
+            std::max<VkDeviceSize>(sizeof(InstanceBounds) * instanceCount, sizeof(InstanceBounds)), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        reserveBuffer(frame.commandBuffer, frame.commandMemory, frame.commandCapacity,
+            std::max<VkDeviceSize>(sizeof(VkDrawIndexedIndirectCommand) * drawCount, sizeof(VkDrawIndexedIndirectCommand)),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        reserveBuffer(frame.instanceBuffer, frame.instanceMemory, frame.instanceCapacity,
+            std::max<VkDeviceSize>(INSTANCE_STRIDE * instanceCount, INSTANCE_STRIDE),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        reserveBuffer(frame.instanceCountBuffer, frame.instanceCountMemory, frame.instanceCountCapacity,
+            std::max<VkDeviceSize>(sizeof(uint32_t) * drawCount, sizeof(uint32_t)),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        InstanceBounds* bounds = static_cast<InstanceBounds*>(frame.boundsMemory.mappedData);
+        for (uint32_t i = 0; i < instanceCount; i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                bounds[i].boundsMin[axis] = scene->instanceBoundsMin[i][axis];
+                bounds[i].boundsMax[axis] = scene->instanceBoundsMax[i][axis];
+            }
+            bounds[i].mesh = scene->instanceMeshes[i];
+            bounds[i].padding = 0;
+        }
+
+        VkDescriptorBufferInfo bufferInfos[BINDING_COUNT] = {};
+        bufferInfos[0].buffer = frame.boundsBuffer;
+        bufferInfos[1].buffer = sourceCommands;
+        bufferInfos[2].buffer = frame.commandBuffer;
+        bufferInfos[3].buffer = frame.countBuffer;
+        bufferInfos[4].buffer = sourceInstances;
+        bufferInfos[5].buffer = frame.instanceBuffer;
+        bufferInfos[6].buffer = frame.instanceCountBuffer;
+        VkWriteDescriptorSet writes[BINDING_COUNT] = {};
+        for (uint32_t i = 0; i < BINDING_COUNT; i++) {
+            bufferInfos[i].range = VK_WHOLE_SIZE;
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = frame.descriptorSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(device, BINDING_COUNT, writes, 0, nullptr);
+
+        frame.scene = scene;
+        frame.sourceCommands = sourceCommands;
+        frame.sourceInstances = sourceInstances;
+        frame.recorded = false;  // 数量属于旧场景，不再作为统计
+    }
+};
+
+#endif // GPUCULLING_H
@@ -0,0 +1,377 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 一个区域最近若干帧的耗时统计（毫秒）
+struct ProfileStats {
+    double min = 0.0;
+    double avg = 0.0;
+    double p99 = 0.0;
+    uint32_t samples = 0;  // 参与统计的样本数
+};
+
+// GPU 时间戳分析器：每个飞行中帧一个时间戳查询池，命令缓冲区中的区域在开始和结束处各写一个时间戳。
+// 查询结果在同一帧槽位下次 beginFrame 时读取，此时该槽位的栅栏已等待，读取不会阻塞；
+// 结果不可用时丢弃这一帧的样本。同时记录 CPU 区域，两条时间线可以导出为 Chrome trace / Perfetto JSON。
+// GPU 时间以录制该帧时的 CPU 时间为起点对齐，只反映帧内各区域的相对位置。
+// 帧之外的 GPU 工作（上传批次）由提交方自行计时后通过 addGpuScope 计入，显示在单独的时间线上
+class GpuProfiler {
+public:
+    static constexpr uint32_t DEFAULT_MAX_SCOPES = 64;
+    static constexpr size_t STATS_WINDOW = 240;        // 统计窗口（帧）
+    static constexpr size_t MAX_TRACE_EVENTS = 200000;  // 捕获的最大事件数，超出后停止记录
+    static constexpr uint32_t GPU_FRAME_TRACK = 0;      // 时间线编号：帧内 GPU 区域
+    static constexpr uint32_t GPU_UPLOAD_TRACK = 1;     // 帧之外提交的 GPU 区域，CPU 线程从 2 开始编号
+
+    GpuProfiler(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamily, uint32_t frameCount,
+        uint32_t maxScopes = DEFAULT_MAX_SCOPES)
+        : device(device), maxScopes(maxScopes), startTime(std::chrono::steady_clock::now()) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        timestampPeriod = properties.limits.timestampPeriod;
+
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+        uint32_t validBits = queueFamily < queueFamilyCount ? queueFamilies[queueFamily].timestampValidBits : 0;
+        timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+        // 队列不支持时间戳时只记录 CPU 区域
+        supported = validBits > 0 && timestampPeriod > 0.0f;
+        frames.resize(frameCount);
+        if (!supported) {
+            return;
+        }
+
+        VkQueryPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = maxScopes * 2;
+        for (auto& frame : frames) {
+            if (vkCreateQueryPool(device, &poolInfo, nullptr, &frame.queryPool) != VK_SUCCESS) {
+                destroy();
+                throw std::runtime_error("创建时间戳查询池失败！");
+            }
+            frame.scopes.reserve(maxScopes);
+        }
+    }
+
+    ~GpuProfiler() {
+        destroy();
+    }
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    bool isGpuSupported() const {
+        return supported;
+    }
+
+    // 开始录制一帧：先取回该槽位上一次的查询结果，再在命令缓冲区开头重置查询池。
+    // 调用前该槽位的栅栏必须已等待
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+        currentSlot = frameIndex;
+        FrameQueries& frame = frames[frameIndex];
+        if (frame.pending) {
+            collect(frame);
+        }
+        frame.scopes.clear();
+        frame.cpuStartMicroseconds = nowMicroseconds();
+        frame.pending = supported;
+        if (supported) {
+            vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, maxScopes * 2);
+            frameScope = beginScope(commandBuffer, "GPU 帧");
+        }
+    }
+
+    void endFrame(VkCommandBuffer commandBuffer) {
+        if (supported) {
+            endScope(commandBuffer, frameScope);
+        }
+    }
+
+    // 开始一个 GPU 区域，返回传给 endScope 的序号。区域数量超出上限时返回 UINT32_MAX，不计时
+    uint32_t beginScope(VkCommandBuffer commandBuffer, const char* name) {
+        FrameQueries& frame = frames[currentSlot];
+        if (!supported || frame.scopes.size() >= maxScopes) {
+            return UINT32_MAX;
+        }
+        uint32_t scope = static_cast<uint32_t>(frame.scopes.size());
+        frame.scopes.push_back({ name, false });
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, scope * 2);
+        return scope;
+    }
+
+    void endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+        FrameQueries& frame = frames[currentSlot];
+        if (scope >= frame.scopes.size()) {
+            return;
+        }
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, scope * 2 + 1);
+        frame.scopes[scope].ended = true;
+    }
+
+    // 记录一个 CPU 区域，可在任意线程调用
+    void addCpuScope(const char* name, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+        double beginMicroseconds = std::chrono::duration<double, std::micro>(begin - startTime).count();
+        double duration = std::chrono::duration<double, std::micro>(end - begin).count();
+        std::lock_guard<std::mutex> lock(mutex);
+        addSample(cpuStats[name], duration / 1000.0);
+        addEvent(name, beginMicroseconds, duration, threadId());
+    }
+
+    // 记录帧之外测得的 GPU 区域（如上传批次），begin 为提交时的 CPU 时间，可在任意线程调用。
+    // 与帧内区域共用统计，按名称查询
+    void addGpuScope(const char* name, std::chrono::steady_clock::time_point begin, double milliseconds) {
+        double beginMicroseconds = std::chrono::duration<double, std::micro>(begin - startTime).count();
+        std::lock_guard<std::mutex> lock(mutex);
+        addSample(gpuStats[name], milliseconds);
+        addEvent(name, beginMicroseconds, milliseconds * 1000.0, GPU_UPLOAD_TRACK);
+    }
+
+    // 最近 STATS_WINDOW 帧的统计，没有样本时全部为 0
+    ProfileStats getGpuStats(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = gpuStats.find(name);
+        return it != gpuStats.end() ? summarize(it->second.samples) : ProfileStats();
+    }
+
+    ProfileStats getCpuStats(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cpuStats.find(name);
+        return it != cpuStats.end() ? summarize(it->second.samples) : ProfileStats();
+    }
+
+    // 开始或停止记录时间线事件，开始时清空之前的记录
+    void setCapture(bool enabled) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (enabled && !capturing) {
+            events.clear();
+        }
+        capturing = enabled;
+    }
+
+    // 把捕获的事件写为 Chrome trace 格式（chrome://tracing 和 Perfetto 都能打开）
+    bool writeChromeTrace(const std::string& path, std::string& error) const {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            error = "无法创建跟踪文件";
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        file << std::fixed << std::setprecision(3);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"RenderManager\"}},\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << GPU_FRAME_TRACK << ",\"args\":{\"name\":\"GPU\"}},\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << GPU_UPLOAD_TRACK << ",\"args\":{\"name\":\"GPU 上传\"}}";
+        for (const auto& thread : threadIds) {
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.second
+                << ",\"args\":{\"name\":\"CPU " << thread.second - GPU_UPLOAD_TRACK << "\"}}";
+        }
+        for (const TraceEvent& event : events) {
+            file << ",\n{\"name\":\"" << escape(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+                << ",\"ts\":" << event.begin << ",\"dur\":" << event.duration << "}";
+        }
+        file << "\n]}\n";
+        if (!file) {
+            error = "写入跟踪文件失败";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    struct ScopeRecord {
+        const char* name;  // 必须指向静态字符串
+        bool ended;
+    };
+
+    struct FrameQueries {
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        std::vector<ScopeRecord> scopes;
+        double cpuStartMicroseconds = 0.0;  // 录制该帧时的 CPU 时间
+        bool pending = false;                // 已录制、结果尚未读取
+    };
+
+    // 环形窗口，最多 STATS_WINDOW 个样本
+    struct RollingSamples {
+        std::vector<double> samples;
+        size_t cursor = 0;
+    };
+
+    struct TraceEvent {
+        std::string name;
+        double begin;     // 微秒
+        double duration;  // 微秒
+        uint32_t thread;  // 时间线编号，见 GPU_FRAME_TRACK
+    };
+
+    VkDevice device;
+    uint32_t maxScopes;
+    float timestampPeriod = 0.0f;  // 每个时间戳计数的纳秒数
+    uint64_t timestampMask = 0;
+    bool supported = false;
+    std::vector<FrameQueries> frames;
+    uint32_t currentSlot = 0;
+    uint32_t frameScope = UINT32_MAX;
+    std::chrono::steady_clock::time_point startTime;
+    std::vector<uint64_t> results;
+
+    mutable std::mutex mutex;  // 保护统计和事件，CPU 区域可能来自工作线程
+    std::map<std::string, RollingSamples> gpuStats;
+    std::map<std::string, RollingSamples> cpuStats;
+    std::vector<TraceEvent> events;
+    std::map<std::thread::id, uint32_t> threadIds;
+    bool capturing = false;
+
+    void destroy() {
+        for (auto& frame : frames) {
+            if (frame.queryPool != VK_NULL_HANDLE) {
+                vkDestroyQueryPool(device, frame.queryPool, nullptr);
+                frame.queryPool = VK_NULL_HANDLE;
+            }
+        }
+    }
+
+    double nowMicroseconds() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    // 不等待地读取一帧的查询结果，转换为毫秒后计入统计和时间线
+    void collect(FrameQueries& frame) {
+        frame.pending = false;
+        uint32_t queryCount = static_cast<uint32_t>(frame.scopes.size()) * 2;
+        if (queryCount == 0) {
+            return;
+        }
+        results.resize(queryCount);
+        if (vkGetQueryPoolResults(device, frame.queryPool, 0, queryCount, results.size() * sizeof(uint64_t), results.data(),
+            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+            return;
+        }
+
+        uint64_t origin = results[0] & timestampMask;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < frame.scopes.size(); i++) {
+            if (!frame.scopes[i].ended) {
+                continue;
+            }
+            uint64_t begin = results[i * 2] & timestampMask;
+            uint64_t end = results[i * 2 + 1] & timestampMask;
+            double beginMicroseconds = ((begin - origin) & timestampMask) * timestampPeriod / 1000.0;
+            double duration = ((end - begin) & timestampMask) * timestampPeriod / 1000.0;
+            addSample(gpuStats[frame.scopes[i].name], duration / 1000.0);
+            addEvent(frame.scopes[i].name, frame.cpuStartMicroseconds + beginMicroseconds, duration, GPU_FRAME_TRACK);
+        }
+    }
+
+    static void addSample(RollingSamples& window, double milliseconds) {
+        if (window.samples.size() < STATS_WINDOW) {
+            window.samples.push_back(milliseconds);
+        }
+        else {
+            window.samples[window.cursor] = milliseconds;
+        }
+        window.cursor = (window.cursor + 1) % STATS_WINDOW;
+    }
+
+    void addEvent(const char* name, double begin, double duration, uint32_t thread) {
+        if (capturing && events.size() < MAX_TRACE_EVENTS) {
+            events.push_back({ name, begin, duration, thread });
+        }
+    }
+
+    // CPU 线程在时间线中的编号，排在 GPU 时间线之后
+    uint32_t threadId() {
+        auto result = threadIds.emplace(std::this_thread::get_id(), static_cast<uint32_t>(threadIds.size()) + GPU_UPLOAD_TRACK + 1);
+        return result.first->second;
+    }
+
+    static ProfileStats summarize(std::vector<double> samples) {
+        ProfileStats stats;
+        if (samples.empty()) {
+            return stats;
+        }
+        std::sort(samples.begin(), samples.end());
+        double total = 0.0;
+        for (double sample : samples) {
+            total += sample;
+        }
+        stats.min = samples.front();
+        stats.avg = total / samples.size();
+        stats.p99 = samples[std::min(samples.size() - 1, static_cast<size_t>(samples.size() * 0.99))];
+        stats.samples = static_cast<uint32_t>(samples.size());
+        return stats;
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string result;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result;
+    }
+};
+
+// 作用域内的 CPU 区域计时
+class CpuProfileScope {
+public:
+    CpuProfileScope(GpuProfiler* profiler, const char* name)
+        : profiler(profiler), name(name), begin(std::chrono::steady_clock::now()) {
+    }
+
+    ~CpuProfileScope() {
+        if (profiler) {
+            profiler->addCpuScope(name, begin, std::chrono::steady_clock::now());
+        }
+    }
+
+    CpuProfileScope(const CpuProfileScope&) = delete;
+    CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+private:
+    GpuProfiler* profiler;
+    const char* name;
+    std::chrono::steady_clock::time_point begin;
+};
+
+// 作用域内的 GPU 区域计时，析构时在同一命令缓冲区写入结束时间戳
+class GpuProfileScope {
+public:
+    GpuProfileScope(GpuProfiler* profiler, VkCommandBuffer commandBuffer, const char* name)
+        : profiler(profiler), commandBuffer(commandBuffer), scope(profiler ? profiler->beginScope(commandBuffer, name) : UINT32_MAX) {
+    }
+
+    ~GpuProfileScope() {
+        if (profiler) {
+            profiler->endScope(commandBuffer, scope);
+        }
+    }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    GpuProfiler* profiler;
+    VkCommandBuffer commandBuffer;
+    uint32_t scope;
+};
+
+#endif // GPUPROFILER_H
@@ -0,0 +1,377 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 任务优先级：帧关键任务（命令录制等）总是先于后台任务（模型加载、流式上传）被取出
+enum class JobPriority : uint32_t {
+    Frame = 0,
+    Background = 1
+};
+
+// 小缓冲优化的可调用对象：捕获不超过 INLINE_SIZE 字节的任务直接存放在内部，不额外分配堆内存
+class JobTask {
+public:
+    static constexpr size_t INLINE_SIZE = 56;
+
+    template <typename Function>
+    explicit JobTask(Function&& function) {
+        using Target = std::decay_t<Function>;
+        if constexpr (sizeof(Target) <= INLINE_SIZE && alignof(Target) <= alignof(std::max_align_t)) {
+            target = new (&storage) Target(std::forward<Function>(function));
+            destroyTarget = [](void* target) { static_cast<Target*>(target)->~Target(); };
+        }
+        else {
+            target = new Target(std::forward<Function>(function));
+            destroyTarget = [](void* target) { delete static_cast<Target*>(target); };
+        }
+        invokeTarget = [](void* target) { (*static_cast<Target*>(target))(); };
+    }
+
+    ~JobTask() {
+        destroyTarget(target);
+    }
+
+    JobTask(const JobTask&) = delete;
+    JobTask& operator=(const JobTask&) = delete;
+
+    void operator()() {
+        invokeTarget(target);
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+    void* target;
+    void (*invokeTarget)(void*);
+    void (*destroyTarget)(void*);
+};
+
+class JobCounter;
+
+// 一个待执行的任务，提交时分配一次，执行后释放
+struct Job {
+    template <typename Function>
+    Job(Function&& function, JobPriority priority, JobCounter* counter)
+        : task(std::forward<Function>(function)), priority(priority), counter(counter) {
+    }
+
+    JobTask task;
+    JobPriority priority;
+    JobCounter* counter;  // 完成时递减的计数器，可为空
+};
+
+// 任务计数器：提交时加一，任务完成时减一，归零表示关联的任务全部完成。
+// 可以作为 wait 的等待对象，也可以作为 submitAfter 的依赖。等待返回后即可销毁
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool isDone() const {
+        return count.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> count{ 0 };
+    std::mutex mutex;
+    std::condition_variable done;
+    std::vector<Job*> continuations;  // 等待计数归零的后续任务
+};
+
+// 单个工作线程的任务双端队列（Chase-Lev）：所属线程在底部无锁压入和弹出，其他线程从顶部窃取。
+// 容量固定，满时由调用方转入全局注入队列
+class WorkStealingDeque {
+public:
+    static constexpr int64_t CAPACITY = 4096;
+
+    bool push(Job* job) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= CAPACITY) {
+            return false;
+        }
+        buffer[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅所属线程调用
+    Job* pop() {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        Job* job = nullptr;
+        if (t <= b) {
+            job = buffer[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+            if (t == b) {
+                // 只剩最后一个，与窃取者竞争
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    job = nullptr;
+                }
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        }
+        else {
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    // 任意线程调用，竞争失败时返回空
+    Job* steal() {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        Job* job = buffer[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+private:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "容量必须是 2 的幂");
+
+    alignas(64) std::atomic<int64_t> top{ 0 };
+    alignas(64) std::atomic<int64_t> bottom{ 0 };
+    std::atomic<Job*> buffer[CAPACITY] = {};
+};
+
+// 工作窃取任务系统：每个工作线程每个优先级一个无锁双端队列，工作线程提交的任务压入自己的队列，
+// 其他线程提交的任务进入全局注入队列；空闲线程依次从自己的队列、注入队列和其他线程的队列取任务，
+// 先取完所有帧关键任务再取后台任务。析构时执行完已提交的任务再退出
+class JobSystem {
+public:
+    static constexpr uint32_t PRIORITY_COUNT = 2;
+
+    explicit JobSystem(uint32_t workerCount) {
+        workerCount = std::max(workerCount, 1u);
+        workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (uint32_t i = 0; i < workerCount; i++) {
+            workers[i]->thread = std::thread([this, i]() { workerLoop(i); });
+        }
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping.store(true);
+        }
+        sleepCondition.notify_all();
+        for (auto& worker : workers) {
+            worker->thread.join();
+        }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    uint32_t getWorkerCount() const {
+        return static_cast<uint32_t>(workers.size());
+    }
+
+    // 提交任务，counter 不为空时任务完成后递减
+    template <typename Function>
+    void submit(Function&& function, JobPriority priority = JobPriority::Background, JobCounter* counter = nullptr) {
+        push(createJob(std::forward<Function>(function), priority, counter));
+    }
+
+    // 提交依赖 dependency 的任务：dependency 归零后才进入队列
+    template <typename Function>
+    void submitAfter(JobCounter& dependency, Function&& function, JobPriority priority = JobPriority::Background,
+        JobCounter* counter = nullptr) {
+        Job* job = createJob(std::forward<Function>(function), priority, counter);
+        {
+            std::lock_guard<std::mutex> lock(dependency.mutex);
+            if (dependency.count.load(std::memory_order_acquire) != 0) {
+                dependency.continuations.push_back(job);
+                return;
+            }
+        }
+        push(job);
+    }
+
+    // 等待计数器归零，期间在当前线程执行优先级不低于 helpPriority 的任务。
+    // 渲染线程默认只帮忙执行帧关键任务，不会被耗时的后台加载任务拖住
+    void wait(JobCounter& counter, JobPriority helpPriority = JobPriority::Frame) {
+        uint32_t index = currentWorkerIndex();
+        while (!counter.isDone()) {
+            if (Job* job = findJob(index, helpPriority)) {
+                execute(job);
+                continue;
+            }
+            // 需要的任务正被其他线程执行，短暂休眠后再检查是否有新的任务可以帮忙
+            std::unique_lock<std::mutex> lock(counter.mutex);
+            counter.done.wait_for(lock, std::chrono::microseconds(100), [&counter]() { return counter.isDone(); });
+        }
+        // 等完成任务的线程释放计数器的锁，之后调用方可以安全销毁计数器
+        std::lock_guard<std::mutex> lock(counter.mutex);
+    }
+
+private:
+    struct Worker {
+        WorkStealingDeque deques[PRIORITY_COUNT];
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex injectionMutex;
+    std::deque<Job*> injectionQueues[PRIORITY_COUNT];  // 非工作线程提交的任务和本地队列溢出的任务
+    std::atomic<int64_t> queuedJobs{ 0 };    // 已入队未取出的任务数
+    std::atomic<uint32_t> sleepingWorkers{ 0 };
+    std::atomic<bool> stopping{ false };
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+
+    // 当前线程所属的任务系统和工作线程序号，用于判断能否压入本地队列
+    static const JobSystem*& currentSystem() {
+        thread_local const JobSystem* system = nullptr;
+        return system;
+    }
+
+    static uint32_t& currentWorker() {
+        thread_local uint32_t worker = 0;
+        return worker;
+    }
+
+    // 当前线程的工作线程序号，不是本系统的工作线程时返回 workers.size()
+    uint32_t currentWorkerIndex() const {
+        return currentSystem() == this ? currentWorker() : static_cast<uint32_t>(workers.size());
+    }
+
+    template <typename Function>
+    Job* createJob(Function&& function, JobPriority priority, JobCounter* counter) {
+        if (counter) {
+            counter->count.fetch_add(1, std::memory_order_relaxed);
+        }
+        return new Job(std::forward<Function>(function), priority, counter);
+    }
+
+    void push(Job* job) {
+        uint32_t priority = static_cast<uint32_t>(job->priority);
+        uint32_t index = currentWorkerIndex();
+        if (index == workers.size() || !workers[index]->deques[priority].push(job)) {
+            std::lock_guard<std::mutex> lock(injectionMutex);
+            injectionQueues[priority].push_back(job);
+        }
+
+        // 与 workerLoop 中先登记休眠再检查 queuedJobs 的顺序配合，不会丢失唤醒
+        queuedJobs.fetch_add(1);
+        if (sleepingWorkers.load() > 0) {
+            { std::lock_guard<std::mutex> lock(sleepMutex); }
+            sleepCondition.notify_one();
+        }
+    }
+
+    // 按优先级查找任务：本地队列、注入队列，再从其他工作线程窃取
+    Job* findJob(uint32_t index, JobPriority lowestPriority) {
+        uint32_t workerCount = static_cast<uint32_t>(workers.size());
+        for (uint32_t priority = 0; priority <= static_cast<uint32_t>(lowestPriority); priority++) {
+            Job* job = nullptr;
+            if (index < workerCount) {
+                job = workers[index]->deques[priority].pop();
+            }
+            if (!job) {
+                std::lock_guard<std::mutex> lock(injectionMutex);
+                if (!injectionQueues[priority].empty()) {
+                    job = injectionQueues[priority].front();
+                    injectionQueues[priority].pop_front();
+                }
+            }
+            for (uint32_t i = 1; !job && i <= workerCount; i++) {
+                uint32_t victim = (index + i) % workerCount;
+                if (victim != index) {
+                    job = workers[victim]->deques[priority].steal();
+                }
+            }
+            if (job) {
+                queuedJobs.fetch_sub(1);
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void execute(Job* job) {
+        try {
+            job->task();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "警告: 任务抛出异常: " << e.what() << std::endl;
+        }
+        catch (...) {
+            std::cerr << "警告: 任务抛出未知异常" << std::endl;
+        }
+
+        JobCounter* counter = job->counter;
+        delete job;
+        if (!counter) {
+            return;
+        }
+
+        // 递减和取出后续任务都在锁内完成，wait 返回后不会再访问计数器
+        std::vector<Job*> ready;
+        {
+            std::lock_guard<std::mutex> lock(counter->mutex);
+            if (counter->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                ready.swap(counter->continuations);
+                counter->done.notify_all();
+            }
+        }
+        for (Job* continuation : ready) {
+            push(continuation);
+        }
+    }
+
+    void workerLoop(uint32_t index) {
+        currentSystem() = this;
+        currentWorker() = index;
+        while (true) {
+            if (Job* job = findJob(index, JobPriority::Background)) {
+                execute(job);
+                continue;
+            }
+            if (stopping.load()) {
+                // 队列已空，仍在执行的任务派生的后续任务由其所在线程自己执行
+                if (queuedJobs.load() == 0) {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepingWorkers.fetch_add(1);
+            sleepCondition.wait(lock, [this]() { return stopping.load() || queuedJobs.load() > 0; });
+            sleepingWorkers.fetch_sub(1);
+        }
+        currentSystem() = nullptr;
+    }
+};
+
+#endif // JOBSYSTEM_H
@@ -0,0 +1,153 @@
+#ifndef LOADSTATS_H
+#define LOADSTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// 定义为 0 时关闭模型加载的分阶段计时和计数，ModelLoadStats 中只保留总耗时和结果
+#ifndef MODEL_LOADER_STATS
+#define MODEL_LOADER_STATS 1
+#endif
+
+// 一次模型加载的分阶段统计。并行阶段（网格转换、纹理解码）的耗时为各任务耗时之和，
+// 可能大于总耗时；其余阶段为墙钟时间。分配次数取自共享的设备内存分配器，
+// 同时有其他加载在上传时会包含它们的分配
+struct ModelLoadStats {
+    bool success = false;              // 加载是否成功
+    bool fromCache = false;            // 是否从烘焙缓存加载
+    double totalMs = 0.0;              // 从提交到发布的总耗时
+    double importMs = 0.0;             // Assimp ReadFile 或读取烘焙缓存
+    double processNodesMs = 0.0;       // 遍历节点层级、收集网格
+    double meshConvertMs = 0.0;        // processMesh（转换、优化、LOD、打包），各任务之和
+    double textureDecodeMs = 0.0;      // 纹理读取和解码（含 CPU mip 生成），各任务之和
+    double textureUploadMs = 0.0;      // 创建纹理并写入暂存区
+    double meshUploadMs = 0.0;         // 创建缓冲区并写入暂存区，包括共享几何和实例缓冲区
+    double submitMs = 0.0;             // 提交上传批次并等待完成
+    uint64_t bytesRead = 0;            // 读取的模型（或缓存）文件和纹理文件字节数
+    uint64_t bytesUploaded = 0;        // 写入暂存区的顶点、索引和纹理字节数
+    uint64_t meshCount = 0;
+    uint64_t vertexCount = 0;
+    uint64_t indexCount = 0;
+    uint64_t textureCount = 0;         // 本次加载上传的纹理数量
+    uint64_t subAllocations = 0;       // 上传阶段的设备内存子分配次数
+    uint64_t deviceAllocations = 0;    // 上传阶段的 vkAllocateMemory 次数
+    uint64_t peakHostBytes = 0;        // 加载完成时进程的峰值常驻内存
+
+    // 输出为单行 JSON
+    std::string toJson() const {
+        char text[1024];
+        snprintf(text, sizeof(text),
+            "{\"success\":%s,\"fromCache\":%s,\"totalMs\":%.3f,\"importMs\":%.3f,\"processNodesMs\":%.3f,"
+            "\"meshConvertMs\":%.3f,\"textureDecodeMs\":%.3f,\"textureUploadMs\":%.3f,\"meshUploadMs\":%.3f,"
+            "\"submitMs\":%.3f,\"bytesRead\":%llu,\"bytesUploaded\":%llu,\"meshCount\":%llu,\"vertexCount\":%llu,"
+            "\"indexCount\":%llu,\"textureCount\":%llu,\"subAllocations\":%llu,\"deviceAllocations\":%llu,"
+            "\"peakHostBytes\":%llu}",
+            success ? "true" : "false", fromCache ? "true" : "false", totalMs, importMs, processNodesMs,
+            meshConvertMs, textureDecodeMs, textureUploadMs, meshUploadMs, submitMs,
+            static_cast<unsigned long long>(bytesRead), static_cast<unsigned long long>(bytesUploaded),
+            static_cast<unsigned long long>(meshCount), static_cast<unsigned long long>(vertexCount),
+            static_cast<unsigned long long>(indexCount), static_cast<unsigned long long>(textureCount),
+            static_cast<unsigned long long>(subAllocations), static_cast<unsigned long long>(deviceAllocations),
+            static_cast<unsigned long long>(peakHostBytes));
+        return text;
+    }
+};
+
+// 进程的峰值常驻内存（字节），不支持时返回 0
+inline uint64_t peakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);  // macOS 以字节为单位
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // Linux 以 KB 为单位
+#endif
+#endif
+}
+
+// 可在多个任务间并发累加的阶段耗时
+class StageTime {
+public:
+    void add(std::chrono::steady_clock::duration duration) {
+        nanoseconds.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()),
+            std::memory_order_relaxed);
+    }
+
+    double milliseconds() const {
+        return nanoseconds.load(std::memory_order_relaxed) / 1e6;
+    }
+
+private:
+    std::atomic<uint64_t> nanoseconds{ 0 };
+};
+
+// 作用域计时，析构时把耗时累加到 StageTime。MODEL_LOADER_STATS 为 0 时不做任何事
+class StageTimer {
+public:
+#if MODEL_LOADER_STATS
+    explicit StageTimer(StageTime& stage)
+        : stage(stage), begin(std::chrono::steady_clock::now()) {
+    }
+
+    ~StageTimer() {
+        stage.add(std::chrono::steady_clock::now() - begin);
+    }
+
+private:
+    StageTime& stage;
+    std::chrono::steady_clock::time_point begin;
+#else
+    explicit StageTimer(StageTime&) {
+    }
+#endif
+
+public:
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+};
+
+// 可并发累加的计数，MODEL_LOADER_STATS 为 0 时不做任何事
+class StageCounter {
+public:
+    void add(uint64_t amount) {
+#if MODEL_LOADER_STATS
+        value.fetch_add(amount, std::memory_order_relaxed);
+#else
+        (void)amount;
+#endif
+    }
+
+    uint64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value{ 0 };
+};
+
+#endif // LOADSTATS_H
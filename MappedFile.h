@@ -0,0 +1,160 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 只读内存映射文件。映射在对象销毁或 close 时解除，可移动不可复制。
+// 空文件是有效的零长度映射：open 成功，data 为空指针，size 为 0
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            mappedData = other.mappedData;
+            mappedSize = other.mappedSize;
+            opened = other.opened;
+            other.mappedData = nullptr;
+            other.mappedSize = 0;
+            other.opened = false;
+        }
+        return *this;
+    }
+
+    // 映射整个文件，失败时返回 false
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            return false;
+        }
+        if (fileSize.QuadPart == 0) {
+            // 不能为空文件创建映射对象
+            CloseHandle(file);
+            opened = true;
+            return true;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) {
+            return false;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);  // 视图会保持映射对象存活
+        if (!view) {
+            return false;
+        }
+        mappedData = view;
+        mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0) {
+            ::close(fd);
+            return false;
+        }
+        if (fileStat.st_size == 0) {
+            // mmap 不接受零长度
+            ::close(fd);
+            opened = true;
+            return true;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // 映射不依赖文件描述符
+        if (view == MAP_FAILED) {
+            return false;
+        }
+        mappedData = view;
+        mappedSize = static_cast<size_t>(fileStat.st_size);
+#endif
+        opened = true;
+        return true;
+    }
+
+    // 提示系统立即预读整个映射。整体读取的文件（纹理、模型）在网络文件系统上可以把逐页缺页合并为大块读取
+    void prefetch() const {
+        if (!mappedData) {
+            return;
+        }
+#ifdef _WIN32
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+        WIN32_MEMORY_RANGE_ENTRY range = { mappedData, mappedSize };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+        posix_madvise(mappedData, mappedSize, POSIX_MADV_WILLNEED);
+#endif
+    }
+
+    void close() {
+        opened = false;
+        if (!mappedData) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(mappedData);
+#else
+        munmap(mappedData, mappedSize);
+#endif
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+
+    bool isOpen() const {
+        return opened;
+    }
+
+    const unsigned char* data() const {
+        return static_cast<const unsigned char*>(mappedData);
+    }
+
+    size_t size() const {
+        return mappedSize;
+    }
+
+private:
+    void* mappedData = nullptr;
+    size_t mappedSize = 0;
+    bool opened = false;  // 空文件没有映射，单独记录是否已打开
+};
+
+#endif // MAPPEDFILE_H
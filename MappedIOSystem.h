@@ -0,0 +1,126 @@
+#ifndef MAPPEDIOSYSTEM_H
+#define MAPPEDIOSYSTEM_H
+
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "MappedFile.h"
+
+// 从内存映射读取的 Assimp 文件流，只读
+class MappedIOStream : public Assimp::IOStream {
+public:
+    explicit MappedIOStream(MappedFile&& file)
+        : file(std::move(file)) {
+    }
+
+    size_t Read(void* buffer, size_t size, size_t count) override {
+        if (size == 0 || count == 0) {
+            return 0;
+        }
+        size_t available = (file.size() - position) / size;  // 与 fread 相同，只读取完整的项
+        count = std::min(count, available);
+        if (count == 0) {
+            return 0;  // 包括空文件，此时没有映射内存
+        }
+        memcpy(buffer, file.data() + position, size * count);
+        position += size * count;
+        return count;
+    }
+
+    size_t Write(const void*, size_t, size_t) override {
+        return 0;
+    }
+
+    aiReturn Seek(size_t offset, aiOrigin origin) override {
+        size_t base = 0;
+        if (origin == aiOrigin_CUR) {
+            base = position;
+        }
+        else if (origin == aiOrigin_END) {
+            base = file.size();
+        }
+        size_t target = base + offset;  // 向前定位时 offset 是回绕后的负数
+        if (target > file.size()) {
+            return aiReturn_FAILURE;
+        }
+        position = target;
+        return aiReturn_SUCCESS;
+    }
+
+    size_t Tell() const override {
+        return position;
+    }
+
+    size_t FileSize() const override {
+        return file.size();
+    }
+
+    void Flush() override {
+    }
+
+private:
+    MappedFile file;
+    size_t position = 0;
+};
+
+// 通过内存映射打开文件的 Assimp IO 系统，用于模型及其引用的外部文件（.bin、.mtl 等）。
+// 映射后整体预读，网络文件系统上以大块读取代替导入器的大量小读取
+class MappedIOSystem : public Assimp::IOSystem {
+public:
+    bool Exists(const char* path) const override {
+        std::error_code ec;
+        return std::filesystem::is_regular_file(std::filesystem::path(path), ec);
+    }
+
+    char getOsSeparator() const override {
+#ifdef _WIN32
+        return '\\';
+#else
+        return '/';
+#endif
+    }
+
+    Assimp::IOStream* Open(const char* path, const char* mode = "rb") override {
+        // 只支持读取
+        if (strchr(mode, 'w') || strchr(mode, 'a') || strchr(mode, '+')) {
+            return nullptr;
+        }
+        MappedFile file;
+        if (!file.open(path)) {
+            return nullptr;
+        }
+        file.prefetch();
+        bytesMapped += file.size();
+        if (std::find(openedFiles.begin(), openedFiles.end(), path) == openedFiles.end()) {
+            openedFiles.push_back(path);
+        }
+        return new MappedIOStream(std::move(file));
+    }
+
+    void Close(Assimp::IOStream* stream) override {
+        delete stream;
+    }
+
+    // 导入过程中映射的文件字节数
+    uint64_t getBytesMapped() const {
+        return bytesMapped;
+    }
+
+    // 导入过程中打开过的文件（模型本身以及 .bin、.mtl 等），按首次打开的顺序排列
+    const std::vector<std::string>& getOpenedFiles() const {
+        return openedFiles;
+    }
+
+private:
+    uint64_t bytesMapped = 0;
+    std::vector<std::string> openedFiles;
+};
+
+#endif // MAPPEDIOSYSTEM_H
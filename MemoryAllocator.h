@@ -0,0 +1,461 @@
+#ifndef MEMORYALLOCATOR_H
+#define MEMORYALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// 一次子分配的结果，缓冲区/图像通过 memory + offset 绑定
+struct MemoryAllocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;  // 所属的设备内存块
+    VkDeviceSize offset = 0;                 // 块内偏移
+    VkDeviceSize size = 0;                   // 分配大小
+    uint32_t memoryTypeIndex = 0;            // 内存类型索引
+    uint32_t poolIndex = 0;                  // 所属内存池
+    uint32_t blockIndex = UINT32_MAX;        // 所属块，UINT32_MAX 表示独立分配
+    void* mappedData = nullptr;              // 主机可见内存的持久映射地址
+};
+
+// 单个内存池的统计信息
+struct MemoryPoolStats {
+    uint32_t memoryTypeIndex = 0;       // 内存类型索引
+    bool linear = true;                 // 线性资源（缓冲区）或最优排列资源（图像）
+    uint32_t blockCount = 0;            // 当前块数量
+    uint32_t allocationCount = 0;       // 当前存活的子分配数量
+    uint32_t dedicatedCount = 0;        // 当前存活的独立分配数量
+    VkDeviceSize blockBytes = 0;        // 块总容量
+    VkDeviceSize usedBytes = 0;         // 已使用字节数
+    VkDeviceSize largestFreeRange = 0;  // 最大的连续空闲区间
+    uint64_t totalAllocations = 0;      // 累计分配次数
+    uint64_t totalFrees = 0;            // 累计释放次数
+};
+
+// 设备内存子分配器：按内存类型维护大块内存，在块内用空闲链表做带对齐的子分配
+class DeviceMemoryAllocator {
+public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+    DeviceMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE)
+        : device(device), preferredBlockSize(blockSize) {
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+        nonCoherentAtomSize = deviceProperties.limits.nonCoherentAtomSize;
+
+        // 每个内存类型分为线性池和最优排列池，避免 bufferImageGranularity 冲突
+        pools.resize(memProperties.memoryTypeCount * 2);
+        for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+            pools[i * 2].memoryTypeIndex = i;
+            pools[i * 2].linear = true;
+            pools[i * 2 + 1].memoryTypeIndex = i;
+            pools[i * 2 + 1].linear = false;
+        }
+    }
+
+    ~DeviceMemoryAllocator() {
+        destroy();
+    }
+
+    DeviceMemoryAllocator(const DeviceMemoryAllocator&) = delete;
+    DeviceMemoryAllocator& operator=(const DeviceMemoryAllocator&) = delete;
+
+    // 按内存需求分配，linear 为 true 表示缓冲区或线性图像
+    MemoryAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear) {
+        uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+        uint32_t poolIndex = memoryTypeIndex * 2 + (linear ? 0 : 1);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Pool& pool = pools[poolIndex];
+        pool.totalAllocations++;
+
+        // 超过块大小一半的请求直接独立分配，避免浪费整块
+        VkDeviceSize blockSize = blockSizeFor(memoryTypeIndex);
+        if (requirements.size > blockSize / 2) {
+            return allocateDedicated(pool, poolIndex, requirements.size);
+        }
+
+        MemoryAllocation allocation;
+        for (uint32_t b = 0; b < pool.blocks.size(); b++) {
+            if (pool.blocks[b] && tryAllocateFromBlock(*pool.blocks[b], requirements, allocation)) {
+                finishAllocation(pool, poolIndex, b, allocation);
+                return allocation;
+            }
+        }
+
+        uint32_t blockIndex = createBlock(pool, blockSize);
+        if (!tryAllocateFromBlock(*pool.blocks[blockIndex], requirements, allocation)) {
+            throw std::runtime_error("设备内存子分配失败！");
+        }
+        finishAllocation(pool, poolIndex, blockIndex, allocation);
+        return allocation;
+    }
+
+    // 释放子分配，相邻空闲区间会被合并
+    void free(MemoryAllocation& allocation) {
+        if (allocation.memory == VK_NULL_HANDLE) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Pool& pool = pools[allocation.poolIndex];
+        pool.totalFrees++;
+
+        if (allocation.blockIndex == UINT32_MAX) {
+            if (allocation.mappedData) {
+                vkUnmapMemory(device, allocation.memory);
+            }
+            vkFreeMemory(device, allocation.memory, nullptr);
+            deviceAllocationCount--;
+            pool.dedicatedCount--;
+            pool.dedicatedBytes -= allocation.size;
+            allocation = MemoryAllocation();
+            return;
+        }
+
+        Block& block = *pool.blocks[allocation.blockIndex];
+        block.allocationCount--;
+        block.usedBytes -= allocation.size;
+        insertFreeRange(block, allocation.offset, allocation.size);
+
+        // 空块只保留一个，其余归还给驱动
+        if (block.allocationCount == 0 && countEmptyBlocks(pool) > 1) {
+            destroyBlock(pool, allocation.blockIndex);
+        }
+
+        allocation = MemoryAllocation();
+    }
+
+    // 创建缓冲区并绑定到子分配的内存
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+        VkBuffer& buffer, MemoryAllocation& allocation) {
+        VkBufferCreateInfo bufferInfo = {};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = size;
+        bufferInfo.usage = usage;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+            throw std::runtime_error("创建缓冲区失败！");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+
+        allocation = allocate(memRequirements, properties, true);
+        vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+    }
+
+    // 创建图像并绑定到子分配的内存
+    void createImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties,
+        VkImage& image, MemoryAllocation& allocation) {
+        if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+            throw std::runtime_error("创建图像失败！");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(device, image, &memRequirements);
+
+        allocation = allocate(memRequirements, properties, imageInfo.tiling == VK_IMAGE_TILING_LINEAR);
+        vkBindImageMemory(device, image, allocation.memory, allocation.offset);
+    }
+
+    // 销毁缓冲区并释放其内存
+    void destroyBuffer(VkBuffer& buffer, MemoryAllocation& allocation) {
+        if (buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, buffer, nullptr);
+            buffer = VK_NULL_HANDLE;
+        }
+        free(allocation);
+    }
+
+    // 销毁图像并释放其内存
+    void destroyImage(VkImage& image, MemoryAllocation& allocation) {
+        if (image != VK_NULL_HANDLE) {
+            vkDestroyImage(device, image, nullptr);
+            image = VK_NULL_HANDLE;
+        }
+        free(allocation);
+    }
+
+    // 查找满足要求的内存类型
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+        for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("无法找到合适的内存类型！");
+    }
+
+    // 获取所有非空内存池的统计信息
+    std::vector<MemoryPoolStats> getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<MemoryPoolStats> result;
+        for (const Pool& pool : pools) {
+            if (pool.totalAllocations == 0) {
+                continue;
+            }
+
+            MemoryPoolStats stats;
+            stats.memoryTypeIndex = pool.memoryTypeIndex;
+            stats.linear = pool.linear;
+            stats.dedicatedCount = pool.dedicatedCount;
+            stats.usedBytes = pool.dedicatedBytes;
+            stats.blockBytes = pool.dedicatedBytes;
+            stats.totalAllocations = pool.totalAllocations;
+            stats.totalFrees = pool.totalFrees;
+            for (const auto& block : pool.blocks) {
+                if (!block) {
+                    continue;
+                }
+                stats.blockCount++;
+                stats.allocationCount += block->allocationCount;
+                stats.blockBytes += block->size;
+                stats.usedBytes += block->usedBytes;
+                for (const auto& range : block->freeRanges) {
+                    stats.largestFreeRange = std::max(stats.largestFreeRange, range.second);
+                }
+            }
+            result.push_back(stats);
+        }
+        return result;
+    }
+
+    // 当前存活的 vkAllocateMemory 次数
+    uint32_t getDeviceAllocationCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return deviceAllocationCount;
+    }
+
+    // 累计的子分配请求次数和 vkAllocateMemory 次数，两次调用的差值即为期间的分配次数
+    void getAllocationTotals(uint64_t& allocations, uint64_t& deviceAllocations) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        allocations = 0;
+        for (const Pool& pool : pools) {
+            allocations += pool.totalAllocations;
+        }
+        deviceAllocations = totalDeviceAllocations;
+    }
+
+    // 打印内存池统计
+    void logStats() const {
+        for (const MemoryPoolStats& stats : getStats()) {
+            std::cout << "内存池[类型 " << stats.memoryTypeIndex << (stats.linear ? ", 线性" : ", 最优") << "] "
+                << "块: " << stats.blockCount
+                << " 子分配: " << stats.allocationCount
+                << " 独立分配: " << stats.dedicatedCount
+                << " 已用: " << stats.usedBytes << "/" << stats.blockBytes
+                << " 最大空闲: " << stats.largestFreeRange
+                << " 累计分配/释放: " << stats.totalAllocations << "/" << stats.totalFrees << std::endl;
+        }
+    }
+
+    // 释放所有内存块
+    void destroy() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Pool& pool : pools) {
+            for (uint32_t b = 0; b < pool.blocks.size(); b++) {
+                if (pool.blocks[b]) {
+                    destroyBlock(pool, b);
+                }
+            }
+            pool.blocks.clear();
+        }
+    }
+
+private:
+    struct Block {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        VkDeviceSize usedBytes = 0;
+        uint32_t allocationCount = 0;
+        void* mappedData = nullptr;
+        std::map<VkDeviceSize, VkDeviceSize> freeRanges;  // 偏移 -> 大小，按偏移排序便于合并
+    };
+
+    struct Pool {
+        uint32_t memoryTypeIndex = 0;
+        bool linear = true;
+        std::vector<std::unique_ptr<Block>> blocks;
+        uint32_t dedicatedCount = 0;
+        VkDeviceSize dedicatedBytes = 0;
+        uint64_t totalAllocations = 0;
+        uint64_t totalFrees = 0;
+    };
+
+    VkDevice device;
+    VkPhysicalDeviceMemoryProperties memProperties;
+    VkDeviceSize preferredBlockSize;
+    VkDeviceSize nonCoherentAtomSize = 1;
+    std::vector<Pool> pools;
+    uint32_t deviceAllocationCount = 0;
+    uint64_t totalDeviceAllocations = 0;  // 累计 vkAllocateMemory 次数
+    mutable std::mutex mutex;
+
+    static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+        return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+    }
+
+    bool isHostVisible(uint32_t memoryTypeIndex) const {
+        return (memProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    }
+
+    // 小内存堆上缩小块大小，避免一个块占满整个堆
+    VkDeviceSize blockSizeFor(uint32_t memoryTypeIndex) const {
+        uint32_t heapIndex = memProperties.memoryTypes[memoryTypeIndex].heapIndex;
+        VkDeviceSize heapSize = memProperties.memoryHeaps[heapIndex].size;
+        return std::min(preferredBlockSize, heapSize / 8);
+    }
+
+    // 最佳适配查找空闲区间
+    bool tryAllocateFromBlock(Block& block, const VkMemoryRequirements& requirements, MemoryAllocation& allocation) {
+        // 主机可见内存按 nonCoherentAtomSize 对齐，便于日后 flush 非一致内存
+        VkDeviceSize alignment = std::max(requirements.alignment, block.mappedData ? nonCoherentAtomSize : VkDeviceSize(1));
+
+        auto best = block.freeRanges.end();
+        VkDeviceSize bestWaste = 0;
+        for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it) {
+            VkDeviceSize alignedOffset = alignUp(it->first, alignment);
+            VkDeviceSize padding = alignedOffset - it->first;
+            if (padding + requirements.size > it->second) {
+                continue;
+            }
+            VkDeviceSize waste = it->second - requirements.size;
+            if (best == block.freeRanges.end() || waste < bestWaste) {
+                best = it;
+                bestWaste = waste;
+            }
+        }
+
+        if (best == block.freeRanges.end()) {
+            return false;
+        }
+
+        VkDeviceSize rangeOffset = best->first;
+        VkDeviceSize rangeSize = best->second;
+        VkDeviceSize alignedOffset = alignUp(rangeOffset, alignment);
+        VkDeviceSize allocationEnd = alignedOffset + requirements.size;
+        block.freeRanges.erase(best);
+
+        // 对齐填充和剩余部分放回空闲链表
+        if (alignedOffset > rangeOffset) {
+            block.freeRanges[rangeOffset] = alignedOffset - rangeOffset;
+        }
+        if (rangeOffset + rangeSize > allocationEnd) {
+            block.freeRanges[allocationEnd] = rangeOffset + rangeSize - allocationEnd;
+        }
+
+        allocation.memory = block.memory;
+        allocation.offset = alignedOffset;
+        allocation.size = requirements.size;
+        allocation.mappedData = block.mappedData ? static_cast<char*>(block.mappedData) + alignedOffset : nullptr;
+        block.allocationCount++;
+        block.usedBytes += requirements.size;
+        return true;
+    }
+
+    void finishAllocation(const Pool& pool, uint32_t poolIndex, uint32_t blockIndex, MemoryAllocation& allocation) {
+        allocation.memoryTypeIndex = pool.memoryTypeIndex;
+        allocation.poolIndex = poolIndex;
+        allocation.blockIndex = blockIndex;
+    }
+
+    // 放回空闲区间并与前后相邻区间合并
+    void insertFreeRange(Block& block, VkDeviceSize offset, VkDeviceSize size) {
+        auto next = block.freeRanges.lower_bound(offset);
+        if (next != block.freeRanges.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset) {
+                offset = prev->first;
+                size += prev->second;
+                block.freeRanges.erase(prev);
+            }
+        }
+        if (next != block.freeRanges.end() && offset + size == next->first) {
+            size += next->second;
+            block.freeRanges.erase(next);
+        }
+        block.freeRanges[offset] = size;
+    }
+
+    VkDeviceMemory allocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, void** mappedData) {
+        VkMemoryAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = size;
+        allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+        VkDeviceMemory memory;
+        if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+            throw std::runtime_error("分配设备内存失败！");
+        }
+        deviceAllocationCount++;
+        totalDeviceAllocations++;
+
+        // 主机可见内存整块持久映射，子分配直接使用偏移后的指针
+        *mappedData = nullptr;
+        if (isHostVisible(memoryTypeIndex)) {
+            vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mappedData);
+        }
+        return memory;
+    }
+
+    MemoryAllocation allocateDedicated(Pool& pool, uint32_t poolIndex, VkDeviceSize size) {
+        MemoryAllocation allocation;
+        allocation.memory = allocateDeviceMemory(pool.memoryTypeIndex, size, &allocation.mappedData);
+        allocation.offset = 0;
+        allocation.size = size;
+        allocation.memoryTypeIndex = pool.memoryTypeIndex;
+        allocation.poolIndex = poolIndex;
+        allocation.blockIndex = UINT32_MAX;
+        pool.dedicatedCount++;
+        pool.dedicatedBytes += size;
+        return allocation;
+    }
+
+    uint32_t createBlock(Pool& pool, VkDeviceSize size) {
+        auto block = std::make_unique<Block>();
+        block->memory = allocateDeviceMemory(pool.memoryTypeIndex, size, &block->mappedData);
+        block->size = size;
+        block->freeRanges[0] = size;
+
+        // 复用已销毁块留下的槽位，保证已有分配的 blockIndex 不变
+        for (uint32_t b = 0; b < pool.blocks.size(); b++) {
+            if (!pool.blocks[b]) {
+                pool.blocks[b] = std::move(block);
+                return b;
+            }
+        }
+        pool.blocks.push_back(std::move(block));
+        return static_cast<uint32_t>(pool.blocks.size() - 1);
+    }
+
+    void destroyBlock(Pool& pool, uint32_t blockIndex) {
+        Block& block = *pool.blocks[blockIndex];
+        if (block.mappedData) {
+            vkUnmapMemory(device, block.memory);
+        }
+        vkFreeMemory(device, block.memory, nullptr);
+        deviceAllocationCount--;
+        pool.blocks[blockIndex].reset();
+    }
+
+    uint32_t countEmptyBlocks(const Pool& pool) const {
+        uint32_t count = 0;
+        for (const auto& block : pool.blocks) {
+            if (block && block->allocationCount == 0) {
+                count++;
+            }
+        }
+        return count;
+    }
+};
+
+#endif // MEMORYALLOCATOR_H
@@ -0,0 +1,340 @@
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 导入后的网格优化：三角形按顶点变换后缓存重排（Forsyth 线性时间算法），
+// 可选地按簇排序以减少过度绘制（Sander 等人的 Tipsify 簇排序），最后按首次使用顺序重排顶点以提高读取局部性。
+// 都在解码线程上对 CPU 端数组执行，不依赖 Vulkan
+
+// 优化前后的平均缓存未命中率（ACMR，每个三角形的顶点缓存未命中数，越低越好）
+struct MeshOptimizationStats {
+    size_t triangleCount = 0;  // 三角形数量
+    float acmrBefore = 0.0f;   // 优化前的 ACMR
+    float acmrAfter = 0.0f;    // 优化后的 ACMR
+};
+
+// 统计时模拟的 FIFO 顶点缓存大小，接近常见硬件的实际表现
+constexpr uint32_t MESH_OPTIMIZER_FIFO_SIZE = 16;
+
+namespace mesh_optimizer_detail {
+
+// 打分时使用的 LRU 缓存大小
+constexpr int CACHE_SIZE = 32;
+
+// Forsyth 顶点得分：越靠近缓存头部、剩余三角形越少的顶点得分越高；没有剩余三角形时为 -1
+inline float vertexScore(int cachePosition, uint32_t liveTriangles) {
+    if (liveTriangles == 0) {
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = 0.75f;  // 刚使用过的三个顶点得分固定，避免偏向某一个
+        }
+        else {
+            float scaler = 1.0f / (CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scaler, 1.5f);
+        }
+    }
+    return score + 2.0f / std::sqrt(static_cast<float>(liveTriangles));
+}
+
+// FIFO 缓存模拟：timestamps 记录顶点进入缓存时的计数，返回本次访问是否未命中
+inline bool fifoMiss(std::vector<uint32_t>& timestamps, uint32_t vertex, uint32_t& counter, uint32_t cacheSize) {
+    if (timestamps[vertex] != 0 && counter - timestamps[vertex] < cacheSize) {
+        return false;
+    }
+    timestamps[vertex] = ++counter;
+    return true;
+}
+
+}  // namespace mesh_optimizer_detail
+
+// 模拟 FIFO 顶点缓存计算 ACMR
+inline float computeACMR(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+    uint32_t cacheSize = MESH_OPTIMIZER_FIFO_SIZE) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return 0.0f;
+    }
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t counter = 0;
+    size_t misses = 0;
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        misses += mesh_optimizer_detail::fifoMiss(timestamps, indices[i], counter, cacheSize) ? 1 : 0;
+    }
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+// 重排三角形以提高顶点变换后缓存的命中率，原地修改 indices
+inline void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+    using namespace mesh_optimizer_detail;
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // 每个顶点引用的未输出三角形，存放在 [offsets[v], offsets[v] + liveTriangles[v]) 中
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        liveTriangles[indices[i]]++;
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + liveTriangles[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        vertexScores[v] = vertexScore(-1, liveTriangles[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+    }
+
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<uint32_t> result;
+    result.reserve(triangleCount * 3);
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(CACHE_SIZE + 3);
+    newCache.reserve(CACHE_SIZE + 3);
+    size_t inputCursor = 0;
+
+    long long bestTriangle = 0;
+    while (bestTriangle >= 0) {
+        size_t triangle = static_cast<size_t>(bestTriangle);
+        const uint32_t* corners = indices + triangle * 3;
+        emitted[triangle] = 1;
+        result.insert(result.end(), corners, corners + 3);
+
+        // 新缓存：三角形的顶点在前，其余按原顺序后移
+        newCache.clear();
+        for (int k = 0; k < 3; k++) {
+            if (std::find(newCache.begin(), newCache.end(), corners[k]) == newCache.end()) {
+                newCache.push_back(corners[k]);
+            }
+        }
+        for (uint32_t vertex : cache) {
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+                newCache.push_back(vertex);
+            }
+        }
+
+        // 从三个顶点的邻接表中移除该三角形
+        for (int k = 0; k < 3; k++) {
+            uint32_t vertex = corners[k];
+            uint32_t* begin = adjacency.data() + offsets[vertex];
+            uint32_t* end = begin + liveTriangles[vertex];
+            uint32_t* found = std::find(begin, end, static_cast<uint32_t>(triangle));
+            if (found != end) {
+                *found = *(end - 1);
+                liveTriangles[vertex]--;
+            }
+        }
+
+        // 更新缓存位置和受影响顶点的得分，并把得分变化累加到其剩余三角形上
+        for (size_t i = 0; i < newCache.size(); i++) {
+            uint32_t vertex = newCache[i];
+            cachePositions[vertex] = i < static_cast<size_t>(CACHE_SIZE) ? static_cast<int>(i) : -1;
+            float score = vertexScore(cachePositions[vertex], liveTriangles[vertex]);
+            float delta = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+            for (uint32_t j = 0; j < liveTriangles[vertex]; j++) {
+                triangleScores[adjacency[offsets[vertex] + j]] += delta;
+            }
+        }
+        if (newCache.size() > static_cast<size_t>(CACHE_SIZE)) {
+            newCache.resize(CACHE_SIZE);
+        }
+        cache.swap(newCache);
+
+        // 下一个三角形优先从缓存中顶点的剩余三角形里选得分最高的
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (uint32_t vertex : cache) {
+            for (uint32_t j = 0; j < liveTriangles[vertex]; j++) {
+                uint32_t candidate = adjacency[offsets[vertex] + j];
+                if (triangleScores[candidate] > bestScore) {
+                    bestScore = triangleScores[candidate];
+                    bestTriangle = candidate;
+                }
+            }
+        }
+
+        // 缓存中没有可用三角形时按输入顺序取下一个未输出的三角形
+        if (bestTriangle < 0) {
+            while (inputCursor < triangleCount && emitted[inputCursor]) {
+                inputCursor++;
+            }
+            if (inputCursor < triangleCount) {
+                bestTriangle = static_cast<long long>(inputCursor);
+            }
+        }
+    }
+
+    std::copy(result.begin(), result.end(), indices);
+}
+
+// 在缓存优化后的顺序上划分三角形簇并按朝外程度排序，先绘制更可能遮挡其他簇的部分以减少过度绘制。
+// 簇边界只放在 ACMR 不超过原来 threshold 倍的位置，positions 指向第一个顶点的位置，positionStride 为顶点间字节距离
+inline void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount,
+    size_t positionStride, float threshold = 1.05f) {
+    using namespace mesh_optimizer_detail;
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    auto position = [&](uint32_t vertex) {
+        return reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + vertex * positionStride);
+    };
+
+    // 硬边界：三个顶点全部未命中的三角形，缓存在此处相当于被清空
+    std::vector<size_t> hardBoundaries;
+    {
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t counter = 0;
+        for (size_t t = 0; t < triangleCount; t++) {
+            int misses = 0;
+            for (int k = 0; k < 3; k++) {
+                misses += fifoMiss(timestamps, indices[t * 3 + k], counter, MESH_OPTIMIZER_FIFO_SIZE) ? 1 : 0;
+            }
+            if (t == 0 || misses == 3) {
+                hardBoundaries.push_back(t);
+            }
+        }
+        hardBoundaries.push_back(triangleCount);
+    }
+
+    // 软边界：在硬簇内部，当前子簇的 ACMR 不超过 threshold 倍簇 ACMR 时即可切分
+    std::vector<size_t> clusters;
+    {
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t counter = 0;
+        for (size_t c = 0; c + 1 < hardBoundaries.size(); c++) {
+            size_t start = hardBoundaries[c];
+            size_t end = hardBoundaries[c + 1];
+
+            counter += MESH_OPTIMIZER_FIFO_SIZE + 1;  // 簇开始时缓存视为清空
+            size_t clusterMisses = 0;
+            for (size_t t = start; t < end; t++) {
+                for (int k = 0; k < 3; k++) {
+                    clusterMisses += fifoMiss(timestamps, indices[t * 3 + k], counter, MESH_OPTIMIZER_FIFO_SIZE) ? 1 : 0;
+                }
+            }
+            float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+            counter += MESH_OPTIMIZER_FIFO_SIZE + 1;
+            size_t subStart = start;
+            size_t subMisses = 0;
+            clusters.push_back(start);
+            for (size_t t = start; t < end; t++) {
+                for (int k = 0; k < 3; k++) {
+                    subMisses += fifoMiss(timestamps, indices[t * 3 + k], counter, MESH_OPTIMIZER_FIFO_SIZE) ? 1 : 0;
+                }
+                if (t + 1 < end && static_cast<float>(subMisses) / static_cast<float>(t + 1 - subStart) <= clusterThreshold) {
+                    clusters.push_back(t + 1);
+                    subStart = t + 1;
+                    subMisses = 0;
+                    counter += MESH_OPTIMIZER_FIFO_SIZE + 1;
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+    }
+    size_t clusterCount = clusters.size() - 1;
+    if (clusterCount < 2) {
+        return;
+    }
+
+    // 网格面积加权中心
+    float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+    std::vector<float> clusterCentroids(clusterCount * 3, 0.0f);
+    std::vector<float> clusterNormals(clusterCount * 3, 0.0f);
+    for (size_t c = 0; c < clusterCount; c++) {
+        float clusterArea = 0.0f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; t++) {
+            const float* p0 = position(indices[t * 3]);
+            const float* p1 = position(indices[t * 3 + 1]);
+            const float* p2 = position(indices[t * 3 + 2]);
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (int axis = 0; axis < 3; axis++) {
+                float center = (p0[axis] + p1[axis] + p2[axis]) / 3.0f;
+                clusterCentroids[c * 3 + axis] += center * area;
+                meshCentroid[axis] += center * area;
+                clusterNormals[c * 3 + axis] += normal[axis];  // 未归一化的法线长度即面积，求和即面积加权
+            }
+            clusterArea += area;
+        }
+        meshArea += clusterArea;
+        for (int axis = 0; axis < 3; axis++) {
+            clusterCentroids[c * 3 + axis] = clusterArea > 0.0f ? clusterCentroids[c * 3 + axis] / clusterArea : 0.0f;
+        }
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        meshCentroid[axis] = meshArea > 0.0f ? meshCentroid[axis] / meshArea : 0.0f;
+    }
+
+    // 簇中心相对网格中心的偏移在簇平均法线上的投影越大，越靠外、越可能遮挡其他簇
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        const float* n = &clusterNormals[c * 3];
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        float key = 0.0f;
+        for (int axis = 0; axis < 3; axis++) {
+            key += (clusterCentroids[c * 3 + axis] - meshCentroid[axis]) * n[axis];
+        }
+        sortKeys[c] = length > 0.0f ? key / length : 0.0f;
+    }
+    std::vector<size_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(triangleCount * 3);
+    for (size_t c : order) {
+        result.insert(result.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+    }
+    std::copy(result.begin(), result.end(), indices);
+}
+
+// 按索引中首次出现的顺序重排顶点，使顶点读取尽量顺序访问；未被引用的顶点被丢弃
+template <typename VertexType>
+inline void optimizeVertexFetch(uint32_t* indices, size_t indexCount, std::vector<VertexType>& vertices) {
+    const uint32_t unused = ~0u;
+    std::vector<uint32_t> remap(vertices.size(), unused);
+    std::vector<VertexType> reordered;
+    reordered.reserve(vertices.size());
+    for (size_t i = 0; i < indexCount; i++) {
+        uint32_t& target = remap[indices[i]];
+        if (target == unused) {
+            target = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[indices[i]]);
+        }
+        indices[i] = target;
+    }
+    vertices.swap(reordered);
+}
+
+#endif // MESHOPTIMIZER_H
@@ -0,0 +1,253 @@
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 基于二次误差度量（QEM）的边折叠简化，用于生成 LOD。
+// 顶点只折叠到边的另一个端点上，不产生新顶点，因此简化结果只是一组新的索引，可与原网格共享顶点缓冲区。
+// 开放边界和非流形边上的顶点（包括 UV/法线接缝处拆开的顶点）保持不动，避免出现裂缝
+
+namespace mesh_simplifier_detail {
+
+// 面积加权的平面二次型，error(p) = (pᵀAp + 2bᵀp + c) / weight 为到相关平面的加权均方距离
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0;
+
+    void addPlane(const double n[3], double d, double w) {
+        a00 += w * n[0] * n[0]; a01 += w * n[0] * n[1]; a02 += w * n[0] * n[2];
+        a11 += w * n[1] * n[1]; a12 += w * n[1] * n[2]; a22 += w * n[2] * n[2];
+        b0 += w * n[0] * d; b1 += w * n[1] * d; b2 += w * n[2] * d;
+        c += w * d * d;
+        weight += w;
+    }
+
+    void add(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2;
+        c += q.c;
+        weight += q.weight;
+    }
+
+    double error(const double p[3]) const {
+        if (weight <= 0) {
+            return 0;
+        }
+        double value = a00 * p[0] * p[0] + a11 * p[1] * p[1] + a22 * p[2] * p[2]
+            + 2 * (a01 * p[0] * p[1] + a02 * p[0] * p[2] + a12 * p[1] * p[2])
+            + 2 * (b0 * p[0] + b1 * p[1] + b2 * p[2]) + c;
+        return std::max(value, 0.0) / weight;
+    }
+};
+
+struct Collapse {
+    uint32_t from;  // 被移除的顶点
+    uint32_t to;    // 保留的顶点
+    double cost;    // 折叠后的误差（距离平方）
+};
+
+inline void cross(const double a[3], const double b[3], double out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+}  // namespace mesh_simplifier_detail
+
+// 把网格简化到不超过 targetIndexCount 个索引，或在误差达到 targetError（与顶点位置同单位的距离）时停止。
+// 结果写入 result，返回实际产生的最大误差。positions 指向第一个顶点的位置，positionStride 为顶点间字节距离
+inline float simplifyMesh(const uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount,
+    size_t positionStride, size_t targetIndexCount, float targetError, std::vector<uint32_t>& result) {
+    using namespace mesh_simplifier_detail;
+    result.assign(indices, indices + indexCount / 3 * 3);
+    if (result.size() <= targetIndexCount || vertexCount == 0) {
+        return 0.0f;
+    }
+
+    std::vector<double> points(vertexCount * 3);
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + v * positionStride);
+        points[v * 3] = p[0];
+        points[v * 3 + 1] = p[1];
+        points[v * 3 + 2] = p[2];
+    }
+    auto point = [&](uint32_t vertex) { return &points[vertex * 3]; };
+
+    // 三角形法线（未归一化，长度为面积的两倍）
+    auto faceNormal = [&](const double* p0, const double* p1, const double* p2, double normal[3]) {
+        double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        cross(e1, e2, normal);
+    };
+
+    // 每个顶点的二次型：相邻三角形平面按面积加权
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        const double* p0 = point(result[i]);
+        double normal[3];
+        faceNormal(p0, point(result[i + 1]), point(result[i + 2]), normal);
+        double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length <= 0) {
+            continue;
+        }
+        double n[3] = { normal[0] / length, normal[1] / length, normal[2] / length };
+        double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+        for (int k = 0; k < 3; k++) {
+            quadrics[result[i + k]].addPlane(n, d, length * 0.5);
+        }
+    }
+
+    // 只被一个三角形或超过两个三角形使用的边视为边界，其顶点锁定
+    std::vector<char> locked(vertexCount, 0);
+    {
+        std::unordered_map<uint64_t, uint32_t> edgeUses;
+        edgeUses.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = result[i + k];
+                uint32_t b = result[i + (k + 1) % 3];
+                uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+                edgeUses[key]++;
+            }
+        }
+        for (const auto& edge : edgeUses) {
+            if (edge.second != 2) {
+                locked[static_cast<uint32_t>(edge.first >> 32)] = 1;
+                locked[static_cast<uint32_t>(edge.first & 0xffffffffu)] = 1;
+            }
+        }
+    }
+
+    double errorLimit = static_cast<double>(targetError) * targetError;
+    double maxError = 0;
+    std::vector<uint32_t> offsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<char> touched(vertexCount);
+
+    // 每一轮并行地执行一批互不相邻的最低代价折叠，直到达到目标或没有可用的折叠
+    while (result.size() > targetIndexCount) {
+        size_t triangleCount = result.size() / 3;
+
+        // 顶点到三角形的邻接表
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (uint32_t vertex : result) {
+            offsets[vertex + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < result.size(); i++) {
+                adjacency[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // 候选折叠：每条边取代价较低的方向
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = result[i + k];
+                uint32_t b = result[i + (k + 1) % 3];
+                if (a >= b || (locked[a] && locked[b])) {
+                    continue;
+                }
+                Quadric merged = quadrics[a];
+                merged.add(quadrics[b]);
+                double costToB = locked[a] ? -1 : merged.error(point(b));
+                double costToA = locked[b] ? -1 : merged.error(point(a));
+                if (costToA < 0 || (costToB >= 0 && costToB <= costToA)) {
+                    collapses.push_back({ a, b, costToB });
+                }
+                else {
+                    collapses.push_back({ b, a, costToA });
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        for (size_t v = 0; v < vertexCount; v++) {
+            remap[v] = static_cast<uint32_t>(v);
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+
+        // 每次折叠大约移除两个三角形
+        size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+        size_t removed = 0;
+        for (const Collapse& collapse : collapses) {
+            if (collapse.cost > errorLimit || removed >= trianglesToRemove) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to]) {
+                continue;
+            }
+
+            // 拒绝会使相邻三角形翻转或退化的折叠
+            bool flips = false;
+            for (uint32_t j = offsets[collapse.from]; j < offsets[collapse.from + 1] && !flips; j++) {
+                const uint32_t* corners = &result[adjacency[j] * 3];
+                if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to) {
+                    continue;
+                }
+                const double* before[3];
+                const double* after[3];
+                for (int k = 0; k < 3; k++) {
+                    before[k] = point(corners[k]);
+                    after[k] = corners[k] == collapse.from ? point(collapse.to) : before[k];
+                }
+                double normalBefore[3];
+                double normalAfter[3];
+                faceNormal(before[0], before[1], before[2], normalBefore);
+                faceNormal(after[0], after[1], after[2], normalAfter);
+                double dot = normalBefore[0] * normalAfter[0] + normalBefore[1] * normalAfter[1] + normalBefore[2] * normalAfter[2];
+                flips = dot <= 0;
+            }
+            if (flips) {
+                continue;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            maxError = std::max(maxError, collapse.cost);
+            removed += 2;
+
+            // 同一轮内不再折叠受影响三角形上的顶点，保证翻转检查仍然有效
+            for (uint32_t j = offsets[collapse.from]; j < offsets[collapse.from + 1]; j++) {
+                const uint32_t* corners = &result[adjacency[j] * 3];
+                touched[corners[0]] = touched[corners[1]] = touched[corners[2]] = 1;
+            }
+        }
+        if (removed == 0) {
+            break;
+        }
+
+        // 应用折叠并移除退化三角形
+        size_t write = 0;
+        for (size_t t = 0; t < triangleCount; t++) {
+            uint32_t a = remap[result[t * 3]];
+            uint32_t b = remap[result[t * 3 + 1]];
+            uint32_t c = remap[result[t * 3 + 2]];
+            if (a == b || b == c || a == c) {
+                continue;
+            }
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    return static_cast<float>(std::sqrt(maxError));
+}
+
+#endif // MESHSIMPLIFIER_H
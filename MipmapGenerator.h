@@ -0,0 +1,90 @@
+#ifndef MIPMAPGENERATOR_H
+#define MIPMAPGENERATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 定义 MIPMAP_NO_SIMD 时总是使用标量路径，测试用它验证两条路径的结果一致
+#if !defined(MIPMAP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define MIPMAP_USE_SSE2 1
+#endif
+
+// CPU 端 mip 链生成：设备不支持对纹理格式做线性过滤的 blit 时使用，在解码线程上执行
+
+// 完整 mip 链的层数
+inline uint32_t mipLevelCount(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    uint32_t size = std::max(width, height);
+    while (size > 1) {
+        size >>= 1;
+        levels++;
+    }
+    return levels;
+}
+
+// RGBA8 图像按 2x2 盒式滤波缩小一级，奇数边长时最后一行/列与自身平均
+inline void downsampleRGBA8(const unsigned char* src, uint32_t srcWidth, uint32_t srcHeight, unsigned char* dst) {
+    uint32_t dstWidth = std::max(1u, srcWidth / 2);
+    uint32_t dstHeight = std::max(1u, srcHeight / 2);
+    size_t srcStride = static_cast<size_t>(srcWidth) * 4;
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        const unsigned char* row0 = src + std::min(2 * y, srcHeight - 1) * srcStride;
+        const unsigned char* row1 = src + std::min(2 * y + 1, srcHeight - 1) * srcStride;
+        unsigned char* out = dst + static_cast<size_t>(y) * dstWidth * 4;
+        uint32_t x = 0;
+
+#ifdef MIPMAP_USE_SSE2
+        // 每次读取两行各 4 个像素，输出 2 个像素；按 16 位累加保证结果与标量路径一致
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rounding = _mm_set1_epi16(2);
+        for (; 2 * x + 4 <= srcWidth && x + 2 <= dstWidth; x += 2) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x));
+            __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            low = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+            high = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+            __m128i sum = _mm_unpacklo_epi64(low, high);
+            sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 4 * x), _mm_packus_epi16(sum, zero));
+        }
+#endif
+
+        for (; x < dstWidth; x++) {
+            uint32_t x0 = std::min(2 * x, srcWidth - 1) * 4;
+            uint32_t x1 = std::min(2 * x + 1, srcWidth - 1) * 4;
+            for (uint32_t c = 0; c < 4; c++) {
+                uint32_t sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                out[4 * x + c] = static_cast<unsigned char>((sum + 2) >> 2);
+            }
+        }
+    }
+}
+
+// 生成第 1 级到最后一级，按层级顺序紧密排列到 mipChain 中
+inline void generateMipChainRGBA8(const unsigned char* pixels, uint32_t width, uint32_t height, std::vector<unsigned char>& mipChain) {
+    uint32_t levels = mipLevelCount(width, height);
+    size_t totalSize = 0;
+    for (uint32_t level = 1, w = width, h = height; level < levels; level++) {
+        w = std::max(1u, w / 2);
+        h = std::max(1u, h / 2);
+        totalSize += static_cast<size_t>(w) * h * 4;
+    }
+    mipChain.resize(totalSize);
+
+    const unsigned char* src = pixels;
+    unsigned char* dst = mipChain.data();
+    for (uint32_t level = 1, w = width, h = height; level < levels; level++) {
+        downsampleRGBA8(src, w, h, dst);
+        w = std::max(1u, w / 2);
+        h = std::max(1u, h / 2);
+        src = dst;
+        dst += static_cast<size_t>(w) * h * 4;
+    }
+}
+
+#endif // MIPMAPGENERATOR_H
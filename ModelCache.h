@@ -0,0 +1,506 @@
+#ifndef MODELCACHE_H
+#define MODELCACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "MappedFile.h"
+
+// 烘焙模型缓存：保存 processMesh 的最终顶点/索引数组、网格的材质索引以及材质引用的纹理，
+// 重新加载时映射文件后直接把数据交给上传阶段，不再经过 Assimp。
+//
+// 文件布局（小端）：
+//   ModelCacheHeader
+//   依赖文件 [dependencyCount] × { DependencyRecord, path }
+//   MeshRecord[meshCount]
+//   纹理引用 [textureCount] × { uint32 typeNameLength, uint32 pathLength, typeName, path }
+//   SceneNodeData[nodeCount]
+//   顶点数据（16 字节对齐，所有网格依次排列，格式由 vertexStride 区分）
+//   索引数据（16 字节对齐，所有网格依次排列，每个网格按 4 字节对齐，16 位或 32 位）
+
+// 单个网格最多的 LOD 层数（含原始网格）
+constexpr uint32_t MAX_MESH_LODS = 8;
+
+// 一级 LOD 在网格索引数据中的范围，所有层级共享同一组顶点
+struct MeshLod {
+    uint32_t firstIndex = 0;  // 首个索引
+    uint32_t indexCount = 0;  // 索引数量
+    float error = 0.0f;       // 相对原始网格的简化误差（模型空间距离）
+};
+
+// 网格数据的只读视图，指向 MeshData 的数组或映射的缓存文件
+struct MeshDataView {
+    const void* vertices = nullptr;       // 顶点数据，布局与 Vertex 或 PackedVertex 相同
+    uint32_t vertexCount = 0;             // 顶点数量
+    const void* indices = nullptr;        // 索引数据
+    uint32_t indexCount = 0;              // 索引数量
+    uint32_t indexSize = 4;               // 单个索引的字节数，2 或 4
+    uint32_t materialIndex = 0;           // 材质索引
+    float boundsMin[3] = {};              // 包围盒最小点
+    float boundsMax[3] = {};              // 包围盒最大点
+    uint32_t lodCount = 0;                // LOD 层数，0 时整个索引数据为唯一一级
+    MeshLod lods[MAX_MESH_LODS];          // 各级 LOD 在 indices 中的范围，第 0 级为原始网格
+    const uint32_t* instanceNodes = nullptr;  // 引用该网格的场景节点，每个节点绘制一个实例
+    uint32_t instanceCount = 0;           // 实例数量
+};
+
+// 场景节点，按深度优先顺序排列，父节点总在子节点之前
+struct SceneNodeData {
+    int32_t parent = -1;              // 父节点序号，根节点为 -1
+    uint32_t reserved = 0;
+    float localTransform[16] = {};    // 相对父节点的变换，列主序
+};
+
+// 材质引用的一个纹理
+struct TextureReference {
+    std::string typeName;        // 纹理类型
+    std::string path;            // 纹理路径
+    uint32_t materialIndex = 0;  // 引用该纹理的材质
+    const unsigned char* embeddedData = nullptr;  // 内嵌纹理的数据，指向 aiScene 或映射的缓存文件，外部文件时为空
+    uint64_t embeddedSize = 0;   // 内嵌纹理的字节数
+    uint32_t embeddedWidth = 0;  // 不为 0 时内嵌数据是未压缩的 BGRA8 像素（aiTexel），否则是 PNG、JPEG 等图像文件
+    uint32_t embeddedHeight = 0;
+};
+
+// 导入时读取的其他文件（.bin、.mtl 等）
+struct ModelCacheDependency {
+    std::string path;   // 导入器打开时使用的路径
+    uint64_t size = 0;  // 文件大小
+    int64_t time = 0;   // 修改时间
+};
+
+// 判断缓存是否仍然有效的信息：源文件或依赖文件变化、导入参数或后处理选项变化、顶点布局变化都会使缓存失效
+struct ModelCacheKey {
+    uint64_t sourceSize = 0;    // 源文件大小
+    int64_t sourceTime = 0;     // 源文件修改时间
+    uint32_t importFlags = 0;   // Assimp 后处理标志
+    uint32_t vertexStride = 0;  // sizeof(Vertex) 或 sizeof(PackedVertex)
+    uint32_t processFlags = 0;  // 导入后由 ModelLoader 执行的处理（网格优化等）
+    uint64_t processParameters = 0;  // 这些处理使用的浮点参数的哈希（过度绘制阈值、LOD 简化比例和误差等）
+    std::vector<ModelCacheDependency> dependencies;  // 写入时记录，读取时从缓存文件中取出并逐个校验
+};
+
+class ModelCache {
+public:
+    // 缓存格式版本，文件布局或 Vertex 字段含义变化时递增
+    static constexpr uint32_t VERSION = 10;
+
+    // 缓存文件路径
+    static std::string cachePath(const std::string& sourcePath) {
+        return sourcePath + ".kskcache";
+    }
+
+    // 根据源文件生成缓存键，源文件不存在时返回 false
+    static bool makeKey(const std::string& sourcePath, uint32_t importFlags, uint32_t vertexStride, uint32_t processFlags,
+        uint64_t processParameters, ModelCacheKey& key) {
+        if (!statFile(sourcePath, key.sourceSize, key.sourceTime)) {
+            return false;
+        }
+        key.importFlags = importFlags;
+        key.vertexStride = vertexStride;
+        key.processFlags = processFlags;
+        key.processParameters = processParameters;
+        key.dependencies.clear();
+        return true;
+    }
+
+    // 把导入时读取的文件加入缓存键，重复的路径只记录一次，文件不存在时返回 false
+    static bool addDependency(const std::string& path, ModelCacheKey& key) {
+        for (const auto& dependency : key.dependencies) {
+            if (dependency.path == path) {
+                return true;
+            }
+        }
+        ModelCacheDependency dependency;
+        dependency.path = path;
+        if (!statFile(path, dependency.size, dependency.time)) {
+            return false;
+        }
+        key.dependencies.push_back(std::move(dependency));
+        return true;
+    }
+
+    // 写入缓存：先写临时文件再替换，避免并发读取到不完整的文件
+    static bool write(const std::string& path, const ModelCacheKey& key, const std::vector<MeshDataView>& meshes,
+        const std::vector<TextureReference>& textures, const std::vector<SceneNodeData>& nodes, std::string& error) {
+        std::vector<unsigned char> metadata;
+        for (const auto& dependency : key.dependencies) {
+            DependencyRecord record = {};
+            record.size = dependency.size;
+            record.time = dependency.time;
+            record.pathLength = static_cast<uint32_t>(dependency.path.size());
+            append(metadata, &record, sizeof(record));
+            append(metadata, dependency.path.data(), dependency.path.size());
+        }
+        uint64_t totalVertices = 0;
+        uint64_t indexBytes = 0;
+        uint32_t totalInstances = 0;
+        for (const auto& mesh : meshes) {
+            MeshRecord record = {};
+            record.materialIndex = mesh.materialIndex;
+            record.vertexCount = mesh.vertexCount;
+            record.indexCount = mesh.indexCount;
+            record.indexSize = mesh.indexSize;
+            record.firstVertex = totalVertices;
+            record.indexOffset = indexBytes;
+            memcpy(record.boundsMin, mesh.boundsMin, sizeof(record.boundsMin));
+            memcpy(record.boundsMax, mesh.boundsMax, sizeof(record.boundsMax));
+            record.lodCount = mesh.lodCount;
+            memcpy(record.lods, mesh.lods, sizeof(record.lods));
+            record.firstInstance = totalInstances;
+            record.instanceCount = mesh.instanceCount;
+            append(metadata, &record, sizeof(record));
+            totalVertices += mesh.vertexCount;
+            totalInstances += mesh.instanceCount;
+            indexBytes += alignIndexData(static_cast<uint64_t>(mesh.indexCount) * mesh.indexSize);
+        }
+        for (const auto& texture : textures) {
+            TextureRecord record = {};
+            record.typeNameLength = static_cast<uint32_t>(texture.typeName.size());
+            record.pathLength = static_cast<uint32_t>(texture.path.size());
+            record.materialIndex = texture.materialIndex;
+            record.embeddedWidth = texture.embeddedWidth;
+            record.embeddedHeight = texture.embeddedHeight;
+            record.embeddedSize = texture.embeddedData ? texture.embeddedSize : 0;
+            append(metadata, &record, sizeof(record));
+            append(metadata, texture.typeName.data(), texture.typeName.size());
+            append(metadata, texture.path.data(), texture.path.size());
+            if (texture.embeddedData) {
+                append(metadata, texture.embeddedData, static_cast<size_t>(texture.embeddedSize));  // 内嵌纹理随缓存保存，之后无需导入场景
+            }
+        }
+        append(metadata, nodes.data(), nodes.size() * sizeof(SceneNodeData));
+        for (const auto& mesh : meshes) {
+            append(metadata, mesh.instanceNodes, sizeof(uint32_t) * mesh.instanceCount);
+        }
+
+        ModelCacheHeader header = {};
+        memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = VERSION;
+        header.vertexStride = key.vertexStride;
+        header.importFlags = key.importFlags;
+        header.processFlags = key.processFlags;
+        header.meshCount = static_cast<uint32_t>(meshes.size());
+        header.textureCount = static_cast<uint32_t>(textures.size());
+        header.nodeCount = static_cast<uint32_t>(nodes.size());
+        header.dependencyCount = static_cast<uint32_t>(key.dependencies.size());
+        header.instanceCount = totalInstances;
+        header.sourceSize = key.sourceSize;
+        header.sourceTime = key.sourceTime;
+        header.processParameters = key.processParameters;
+        header.vertexDataOffset = alignUp(sizeof(header) + metadata.size());
+        header.indexDataOffset = alignUp(header.vertexDataOffset + totalVertices * key.vertexStride);
+        header.fileSize = header.indexDataOffset + indexBytes;
+
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                error = "无法创建缓存文件";
+                return false;
+            }
+            static const char padding[16] = {};
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(metadata.data()), metadata.size());
+            file.write(padding, header.vertexDataOffset - sizeof(header) - metadata.size());
+            for (const auto& mesh : meshes) {
+                file.write(static_cast<const char*>(mesh.vertices), static_cast<std::streamsize>(mesh.vertexCount) * key.vertexStride);
+            }
+            file.write(padding, header.indexDataOffset - (header.vertexDataOffset + totalVertices * key.vertexStride));
+            for (const auto& mesh : meshes) {
+                uint64_t size = static_cast<uint64_t>(mesh.indexCount) * mesh.indexSize;
+                file.write(static_cast<const char*>(mesh.indices), static_cast<std::streamsize>(size));
+                file.write(padding, alignIndexData(size) - size);
+            }
+            if (!file) {
+                error = "写入缓存文件失败";
+                file.close();
+                std::filesystem::remove(tempPath);
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            std::filesystem::remove(tempPath, ec);
+            error = "替换缓存文件失败";
+            return false;
+        }
+        return true;
+    }
+
+    // 校验并解析已映射的缓存文件，返回的视图指向映射内存，file 必须比它们存活得久。
+    // 网格的 instanceNodes 指向 instanceNodes 中读出的实例节点表，同样需要保持存活
+    static bool read(const MappedFile& file, const ModelCacheKey& key, std::vector<MeshDataView>& meshes,
+        std::vector<TextureReference>& textures, std::vector<SceneNodeData>& nodes, std::vector<uint32_t>& instanceNodes,
+        std::string& error) {
+        ModelCacheHeader header;
+        if (file.size() < sizeof(header)) {
+            error = "缓存文件过小";
+            return false;
+        }
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION) {
+            error = "缓存版本不匹配";
+            return false;
+        }
+        if (header.vertexStride != key.vertexStride || header.importFlags != key.importFlags || header.processFlags != key.processFlags
+            || header.processParameters != key.processParameters || header.sourceSize != key.sourceSize
+            || header.sourceTime != key.sourceTime) {
+            error = "源文件或导入参数已变化";
+            return false;
+        }
+        if (header.fileSize != file.size() || header.vertexDataOffset > header.indexDataOffset
+            || header.indexDataOffset > header.fileSize || header.vertexDataOffset % 16 != 0 || header.indexDataOffset % 16 != 0) {
+            error = "缓存文件已损坏";
+            return false;
+        }
+
+        uint64_t vertexCapacity = (header.indexDataOffset - header.vertexDataOffset) / header.vertexStride;
+        uint64_t indexBytes = header.fileSize - header.indexDataOffset;
+        size_t cursor = sizeof(header);
+
+        // 依赖文件的大小或修改时间变化（包括被删除）时缓存失效
+        for (uint32_t i = 0; i < header.dependencyCount; i++) {
+            DependencyRecord record;
+            if (cursor + sizeof(record) > header.vertexDataOffset) {
+                error = "缓存文件已损坏";
+                return false;
+            }
+            memcpy(&record, file.data() + cursor, sizeof(record));
+            cursor += sizeof(record);
+            if (record.pathLength > header.vertexDataOffset - cursor) {
+                error = "缓存文件已损坏";
+                return false;
+            }
+            std::string path(reinterpret_cast<const char*>(file.data() + cursor), record.pathLength);
+            cursor += record.pathLength;
+            uint64_t size;
+            int64_t time;
+            if (!statFile(path, size, time) || size != record.size || time != record.time) {
+                error = "依赖文件已变化: " + path;
+                return false;
+            }
+        }
+
+        meshes.clear();
+        meshes.reserve(header.meshCount);
+        std::vector<uint32_t> firstInstances;
+        firstInstances.reserve(header.meshCount);
+        for (uint32_t i = 0; i < header.meshCount; i++) {
+            MeshRecord record;
+            if (cursor + sizeof(record) > header.vertexDataOffset) {
+                error = "缓存文件已损坏";
+                return false;
+            }
+            memcpy(&record, file.data() + cursor, sizeof(record));
+            cursor += sizeof(record);
+            if ((record.indexSize != 2 && record.indexSize != 4) || record.indexOffset % 4 != 0
+                || record.firstVertex > vertexCapacity || record.vertexCount > vertexCapacity - record.firstVertex
+                || record.indexOffset > indexBytes || static_cast<uint64_t>(record.indexCount) * record.indexSize > indexBytes - record.indexOffset
+                || record.lodCount > MAX_MESH_LODS || record.instanceCount == 0
+                || record.firstInstance > header.instanceCount || record.instanceCount > header.instanceCount - record.firstInstance) {
+                error = "缓存文件已损坏";
+                return false;
+            }
+            for (uint32_t lod = 0; lod < record.lodCount; lod++) {
+                if (record.lods[lod].firstIndex > record.indexCount || record.lods[lod].indexCount > record.indexCount - record.lods[lod].firstIndex) {
+                    error = "缓存文件已损坏";
+                    return false;
+                }
+            }
+            // 各级 LOD 都在 indexCount 范围内，检查整个索引数组即可覆盖所有层级
+            const unsigned char* indexData = file.data() + header.indexDataOffset + record.indexOffset;
+            bool indicesValid = record.indexSize == 2
+                ? indicesInRange(reinterpret_cast<const uint16_t*>(indexData), record.indexCount, record.vertexCount)
+                : indicesInRange(reinterpret_cast<const uint32_t*>(indexData), record.indexCount, record.vertexCount);
+            if (!indicesValid) {
+                error = "缓存文件已损坏";
+                return false;
+            }
+
+            MeshDataView mesh;
+            mesh.vertices = file.data() + header.vertexDataOffset + record.firstVertex * header.vertexStride;
+            mesh.vertexCount = record.vertexCount;
+            mesh.indices = file.data() + header.indexDataOffset + record.indexOffset;
+            mesh.indexCount = record.indexCount;
+            mesh.indexSize = record.indexSize;
+            mesh.materialIndex = record.materialIndex;
+            memcpy(mesh.boundsMin, record.boundsMin, sizeof(mesh.boundsMin));
+            memcpy(mesh.boundsMax, record.boundsMax, sizeof(mesh.boundsMax));
+            mesh.lodCount = record.lodCount;
+            memcpy(mesh.lods, record.lods, sizeof(mesh.lods));
+            mesh.instanceCount = record.instanceCount;
+            meshes.push_back(mesh);
+            firstInstances.push_back(record.firstInstance);
+        }
+
+        textures.clear();
+        for (uint32_t i = 0; i < header.textureCount; i++) {
+            TextureRecord record;
+            if (cursor + sizeof(record) > header.vertexDataOffset) {
+                error = "缓存文件已损坏";
+                return false;
+            }
+            memcpy(&record, file.data() + cursor, sizeof(record));
+            cursor += sizeof(record);
+            uint64_t textLength = static_cast<uint64_t>(record.typeNameLength) + record.pathLength;
+            if (textLength > header.vertexDataOffset - cursor || record.embeddedSize > header.vertexDataOffset - cursor - textLength) {
+                error = "缓存文件已损坏";
+                return false;
+            }
+            const char* text = reinterpret_cast<const char*>(file.data() + cursor);
+            TextureReference texture;
+            texture.typeName.assign(text, record.typeNameLength);
+            texture.path.assign(text + record.typeNameLength, record.pathLength);
+            texture.materialIndex = record.materialIndex;
+            cursor += textLength;
+            if (record.embeddedSize > 0) {
+                texture.embeddedData = file.data() + cursor;  // 指向映射的缓存文件
+                texture.embeddedSize = record.embeddedSize;
+                texture.embeddedWidth = record.embeddedWidth;
+                texture.embeddedHeight = record.embeddedHeight;
+                cursor += record.embeddedSize;
+            }
+            textures.push_back(std::move(texture));
+        }
+
+        if (static_cast<uint64_t>(header.nodeCount) * sizeof(SceneNodeData) > header.vertexDataOffset - cursor) {
+            error = "缓存文件已损坏";
+            return false;
+        }
+        nodes.resize(header.nodeCount);
+        memcpy(nodes.data(), file.data() + cursor, nodes.size() * sizeof(SceneNodeData));
+        cursor += nodes.size() * sizeof(SceneNodeData);
+        for (uint32_t i = 0; i < header.nodeCount; i++) {
+            // 父节点必须在前，保证按顺序累乘世界矩阵
+            if (nodes[i].parent >= static_cast<int32_t>(i) || nodes[i].parent < -1) {
+                error = "缓存文件已损坏";
+                return false;
+            }
+        }
+
+        // 实例节点表在元数据中不一定按 4 字节对齐，拷贝出来再让网格指向它
+        if (static_cast<uint64_t>(header.instanceCount) * sizeof(uint32_t) > header.vertexDataOffset - cursor) {
+            error = "缓存文件已损坏";
+            return false;
+        }
+        instanceNodes.resize(header.instanceCount);
+        memcpy(instanceNodes.data(), file.data() + cursor, instanceNodes.size() * sizeof(uint32_t));
+        for (uint32_t node : instanceNodes) {
+            if (node >= header.nodeCount) {
+                error = "缓存文件已损坏";
+                return false;
+            }
+        }
+        for (size_t i = 0; i < meshes.size(); i++) {
+            meshes[i].instanceNodes = instanceNodes.data() + firstInstances[i];
+        }
+        return true;
+    }
+
+private:
+    static constexpr char MAGIC[8] = { 'K', 'S', 'K', 'M', 'O', 'D', 'E', 'L' };
+
+    struct ModelCacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t vertexStride;
+        uint32_t importFlags;
+        uint32_t meshCount;
+        uint32_t textureCount;
+        uint32_t processFlags;
+        uint32_t nodeCount;
+        uint32_t instanceCount;
+        uint32_t dependencyCount;
+        uint32_t reserved;
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint64_t processParameters;
+        uint64_t vertexDataOffset;
+        uint64_t indexDataOffset;
+        uint64_t fileSize;
+    };
+
+    struct MeshRecord {
+        uint32_t materialIndex;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t indexSize;    // 单个索引的字节数
+        uint64_t firstVertex;  // 在顶点数据中的首个顶点
+        uint64_t indexOffset;  // 在索引数据中的字节偏移
+        float boundsMin[3];    // 包围盒最小点
+        float boundsMax[3];    // 包围盒最大点
+        uint32_t lodCount;     // LOD 层数
+        uint32_t firstInstance;  // 在实例节点表中的起始位置，实例节点表在场景节点之后
+        uint32_t instanceCount;  // 实例数量
+        MeshLod lods[MAX_MESH_LODS];  // 各级 LOD 在该网格索引中的范围
+    };
+
+    // 纹理引用，其后依次是类型名、路径和内嵌纹理数据
+    struct TextureRecord {
+        uint32_t typeNameLength;
+        uint32_t pathLength;
+        uint32_t materialIndex;
+        uint32_t embeddedWidth;   // 见 TextureReference
+        uint32_t embeddedHeight;
+        uint32_t reserved;
+        uint64_t embeddedSize;    // 内嵌纹理字节数，外部文件为 0
+    };
+
+    // 依赖文件，其后是路径
+    struct DependencyRecord {
+        uint64_t size;
+        int64_t time;
+        uint32_t pathLength;
+        uint32_t reserved;
+    };
+
+    static bool statFile(const std::string& path, uint64_t& size, int64_t& time) {
+        std::error_code ec;
+        uintmax_t fileSize = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return false;
+        }
+        auto writeTime = std::filesystem::last_write_time(path, ec);
+        if (ec) {
+            return false;
+        }
+        size = static_cast<uint64_t>(fileSize);
+        time = static_cast<int64_t>(writeTime.time_since_epoch().count());
+        return true;
+    }
+
+    // 索引数据按 4 字节对齐存放，可以直接按索引类型访问
+    template <typename Index>
+    static bool indicesInRange(const Index* indices, uint32_t indexCount, uint32_t vertexCount) {
+        for (uint32_t i = 0; i < indexCount; i++) {
+            if (indices[i] >= vertexCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static uint64_t alignUp(uint64_t offset) {
+        return (offset + 15) & ~static_cast<uint64_t>(15);
+    }
+
+    // 每个网格的索引数据按 4 字节对齐，奇数个 16 位索引后补齐
+    static uint64_t alignIndexData(uint64_t size) {
+        return (size + 3) & ~static_cast<uint64_t>(3);
+    }
+
+    static void append(std::vector<unsigned char>& buffer, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+};
+
+#endif // MODELCACHE_H
@@ -1,344 +1,1661 @@
-#include <vulkan/vulkan.h>
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-#include <glm/glm.hpp>
+// stb_image ʵַ뵥Ԫ ModelLoader Ŀ겻Ҫٶ STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "ModelLoader.h"
 #include <QThread>
-#include <QMutex>
-#include <QMutexLocker>
-#include <iostream>
-#include <vector>
-#include <string>
-#include <unordered_map>
-#include <fstream>
-#include <stb_image.h>
-
-struct Vertex {
-    glm::vec3 Position;  // λ
-    glm::vec3 Normal;    // 㷨
-    glm::vec2 TexCoords; // 
-    glm::vec3 Tangent;   // 
-    glm::vec3 Bitangent; // 
+#include <filesystem>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+void MeshInstance::getWorldAttributeDescriptions(VkVertexInputAttributeDescription* attributeDescriptions) {
+    for (uint32_t column = 0; column < 4; column++) {
+        attributeDescriptions[column] = { 7 + column, 1, VK_FORMAT_R32G32B32A32_SFLOAT,
+            static_cast<uint32_t>(offsetof(MeshInstance, world) + sizeof(glm::vec4) * column) };
+    }
+}
+
+std::array<VkVertexInputBindingDescription, 2> Vertex::getBindingDescriptions() {
+    std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {};
+    bindingDescriptions[0] = { 0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX };
+    bindingDescriptions[1] = { 1, sizeof(MeshInstance), VK_VERTEX_INPUT_RATE_INSTANCE };
+    return bindingDescriptions;
+}
+
+std::array<VkVertexInputAttributeDescription, 9> Vertex::getAttributeDescriptions() {
+    std::array<VkVertexInputAttributeDescription, 9> attributeDescriptions = {};
+    attributeDescriptions[0] = { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, static_cast<uint32_t>(offsetof(Vertex, Position)) };
+    attributeDescriptions[1] = { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, static_cast<uint32_t>(offsetof(Vertex, Normal)) };
+    attributeDescriptions[2] = { 2, 0, VK_FORMAT_R32G32_SFLOAT, static_cast<uint32_t>(offsetof(Vertex, TexCoords)) };
+    attributeDescriptions[3] = { 3, 0, VK_FORMAT_R32G32B32_SFLOAT, static_cast<uint32_t>(offsetof(Vertex, Tangent)) };
+    attributeDescriptions[4] = { 4, 0, VK_FORMAT_R32G32B32_SFLOAT, static_cast<uint32_t>(offsetof(Vertex, Bitangent)) };
+    MeshInstance::getWorldAttributeDescriptions(&attributeDescriptions[5]);
+    return attributeDescriptions;
+}
+
+std::array<VkVertexInputBindingDescription, 2> PackedVertex::getBindingDescriptions() {
+    std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {};
+    bindingDescriptions[0] = { 0, sizeof(PackedVertex), VK_VERTEX_INPUT_RATE_VERTEX };
+    bindingDescriptions[1] = { 1, sizeof(MeshInstance), VK_VERTEX_INPUT_RATE_INSTANCE };
+    return bindingDescriptions;
+}
+
+std::array<VkVertexInputAttributeDescription, 10> PackedVertex::getAttributeDescriptions() {
+    std::array<VkVertexInputAttributeDescription, 10> attributeDescriptions = {};
+    attributeDescriptions[0] = { 0, 0, VK_FORMAT_R16G16B16A16_UNORM, static_cast<uint32_t>(offsetof(PackedVertex, Position)) };
+    attributeDescriptions[1] = { 1, 0, VK_FORMAT_R16G16_SNORM, static_cast<uint32_t>(offsetof(PackedVertex, Normal)) };
+    attributeDescriptions[2] = { 2, 0, VK_FORMAT_R16G16_SFLOAT, static_cast<uint32_t>(offsetof(PackedVertex, TexCoords)) };
+    attributeDescriptions[3] = { 3, 0, VK_FORMAT_R16G16_SNORM, static_cast<uint32_t>(offsetof(PackedVertex, Tangent)) };
+    attributeDescriptions[4] = { 5, 1, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(MeshInstance, scale)) };
+    attributeDescriptions[5] = { 6, 1, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(MeshInstance, offset)) };
+    MeshInstance::getWorldAttributeDescriptions(&attributeDescriptions[6]);
+    return attributeDescriptions;
+}
+
+PackedVertex PackedVertex::pack(const Vertex& vertex, const glm::vec3& boundsMin, const glm::vec3& invExtent) {
+    PackedVertex packed;
+    glm::vec3 position = glm::clamp((vertex.Position - boundsMin) * invExtent, 0.0f, 1.0f);
+    packed.Position[0] = glm::packUnorm1x16(position.x);
+    packed.Position[1] = glm::packUnorm1x16(position.y);
+    packed.Position[2] = glm::packUnorm1x16(position.z);
+    packed.Position[3] = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < 0.0f ? 0 : 65535;
+    encodeOctahedral(vertex.Normal, packed.Normal);
+    encodeOctahedral(vertex.Tangent, packed.Tangent);
+    packed.TexCoords[0] = glm::packHalf1x16(vertex.TexCoords.x);
+    packed.TexCoords[1] = glm::packHalf1x16(vertex.TexCoords.y);
+    return packed;
+}
+
+void PackedVertex::encodeOctahedral(const glm::vec3& v, int16_t encoded[2]) {
+    float length = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    glm::vec2 e(0.0f);
+    if (length > 0.0f) {
+        e = glm::vec2(v.x, v.y) / length;
+        if (v.z < 0.0f) {
+            glm::vec2 wrapped = 1.0f - glm::abs(glm::vec2(e.y, e.x));
+            e = glm::vec2(e.x >= 0.0f ? wrapped.x : -wrapped.x, e.y >= 0.0f ? wrapped.y : -wrapped.y);
+        }
+    }
+    encoded[0] = static_cast<int16_t>(glm::packSnorm1x16(e.x));
+    encoded[1] = static_cast<int16_t>(glm::packSnorm1x16(e.y));
+}
+
+//  RGBA8 
+struct ModelLoader::DecodedImage {
+    int width = 0;
+    int height = 0;
+    std::unique_ptr<unsigned char, void(*)(void*)> pixels{ nullptr, stbi_image_free };
+    std::vector<unsigned char> mipChain;  // CPU ɵĵ 1 Ժ֧ GPU ʱʹ
+    CompressedImage compressed;  // Ԥѹformat Ϊ UNDEFINED ʱ pixels ʹ
 };
 
-struct Texture {
-    VkImage image;                 // Vulkan ͼ
-    VkDeviceMemory imageMemory;    // ͼڴ
-    VkImageView imageView;         // ͼͼ
-    VkSampler sampler;             // 
-    std::string type;              // 
-    std::string path;              // ·
+// һڽͬһ·ʱͬһĿ
+struct ModelLoader::TextureDecodeEntry {
+    std::string path;                           // ·
+    std::string typeName;                       // 
+    DecodedImage image;                         // 
+    uint64_t sourceBytes = 0;                   // ȡԴļֽ
+    bool streamed = false;                      // ǷΪʽϴ CPU  mip 
+    uint64_t samplerVariant = 0;                // еĲ
+    TextureHandle cached;                       // еʱ
+    bool cacheable = false;                     // ϴǷǼǵ
+    uint64_t cacheKey = 0;                      // Ǽʹõļ
+    const unsigned char* embeddedData = nullptr;  // Ƕݣ TextureReferenceⲿļʱΪ
+    uint64_t embeddedSize = 0;
+    uint32_t embeddedWidth = 0;
+    uint32_t embeddedHeight = 0;
+    bool done = false;                          // Ƿɣ mutex 
+    std::vector<std::function<void()>> waiters; // ɺĻص mutex 
 };
 
-class ModelLoader {
-public:
-    // 캯ʼ Vulkan 豸豸ͼζк
-    ModelLoader(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool)
-        : device(device), physicalDevice(physicalDevice), graphicsQueue(graphicsQueue), commandPool(commandPool) {}
+// һ첽ڸ乲״̬
+struct ModelLoader::AsyncLoadState {
+    std::string filePath;                       // ģ·
+    ModelLoadOptions options;                   // ѡ
+    Assimp::Importer importer;                  // гֱϴ
+    const aiScene* scene = nullptr;             // ĳ
+    std::vector<aiMesh*> meshes;                // ڵ˳ռ
+    std::vector<std::vector<uint32_t>> meshNodes;  // ÿʵĽڵ
+    std::unordered_map<unsigned int, uint32_t> meshSlots;  // Assimp ŵ meshes λõӳ
+    std::vector<SceneNodeData> nodes;           // ڵ㼶
+    std::vector<MeshData> meshData;             // ÿת
+    std::vector<std::shared_ptr<TextureDecodeEntry>> textures;  // μҪϴ
+    std::vector<std::shared_ptr<TextureDecodeEntry>> claimedTextures;  // ɱμ첢
+    std::vector<TextureReference> textureRefs;  // õȫд뻺
+    bool fromCache = false;                     // ǷӺ決
+    std::vector<std::string> importedFiles;     // ʱȡļд뻺ʱΪ¼
+    MappedFile cacheFile;                       // ӳĻļϴǰӳ
+    std::vector<MeshDataView> cachedMeshes;     // ָ򻺴ļ
+    std::vector<uint32_t> cachedInstanceNodes;  // иʵڵ
+    std::atomic<size_t> remainingTasks{ 0 };    // ϴǰδɵ
+    std::atomic<bool> failed{ false };          // Ƿʧ
+    std::promise<bool> promise;                 // ؽ
+    std::chrono::steady_clock::time_point startTime;  // ύʱ
+    std::shared_ptr<ModelLoadStats> statsOut;   // ÷ͳƵĶ󣬿Ϊ
+    StageTime importTime;                       // Ϊֽ׶ͳƣ ModelLoadStats
+    StageTime processNodesTime;
+    StageTime meshConvertTime;
+    StageTime textureDecodeTime;
+    StageTime textureUploadTime;
+    StageTime meshUploadTime;
+    StageTime submitTime;
+    StageCounter bytesRead;
+    StageCounter bytesUploaded;
+    StageCounter vertexCount;
+    StageCounter indexCount;
+    StageCounter textureCount;
+    StageCounter subAllocations;
+    StageCounter deviceAllocations;
+};
 
-    // ȷͷ Vulkan Դ
-    ~ModelLoader() {
-        cleanup();  // ȷ Vulkan Դͷ
+// 캯ʼ Vulkan 豸豸ͼζк
+// allocator Ϊʱдһ豸ڴӷ
+ModelLoader::ModelLoader(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool,
+    DeviceMemoryAllocator* allocator)
+    : device(device), physicalDevice(physicalDevice), graphicsQueue(graphicsQueue), commandPool(commandPool), allocator(allocator) {
+    if (!this->allocator) {
+        ownedAllocator = std::make_unique<DeviceMemoryAllocator>(device, physicalDevice);
+        this->allocator = ownedAllocator.get();
     }
+    resourceCache = std::make_shared<ResourceCache>(device, this->allocator);
 
-    // ģļ
-    bool loadModel(const std::string& filePath) {
-        try {
-            Assimp::Importer importer;
-            const aiScene* scene = importer.ReadFile(filePath,
-                aiProcess_Triangulate |
-                aiProcess_FlipUVs |
-                aiProcess_CalcTangentSpace |
-                aiProcess_OptimizeMeshes |
-                aiProcess_JoinIdenticalVertices);
-
-            // ģǷɹ
-            if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-                logError("ģͳ: " + std::string(filePath));
-                return false;
-            }
-            // ڵ
-            processNode(scene->mRootNode, scene);
-            return true;
+    //  blit  mip Ҫʽ֧Ϊ blit Դ/ĿԼԹ
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_UNORM, &formatProperties);
+    VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT
+        | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    gpuMipmaps = (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures;
+}
+
+// ȷͷ Vulkan Դ
+ModelLoader::~ModelLoader() {
+    waitForAsyncLoads();  // ȴδɵ첽
+    cleanup();  // ȷ Vulkan Դͷ
+    resourceCache.reset();
+    // зҪӳٵԴͷź٣ӳٶЩԴ֮
+    if (ownedAllocator && asyncContext.deferDestroy) {
+        std::shared_ptr<DeviceMemoryAllocator> retiredAllocator(std::move(ownedAllocator));
+        asyncContext.deferDestroy([retiredAllocator]() {});
+    }
+}
+
+// 첽ʹõ̳߳ءӳٺͶ
+void ModelLoader::setAsyncContext(const AsyncLoadContext& context) {
+    asyncContext = context;
+    if (context.resourceCache) {
+        resourceCache = context.resourceCache;
+    }
+    else if (context.deferDestroy) {
+        // лڼǰؽʹͷʱͬӳ
+        resourceCache = std::make_shared<ResourceCache>(device, allocator, context.deferDestroy);
+    }
+}
+
+// ģļֱɡ̳߳ʱתԲִУ
+// ˲̳߳صĹ߳е
+bool ModelLoader::loadModel(const std::string& filePath, const ModelLoadOptions& options) {
+    return loadModelAsync(filePath, options).get();
+}
+
+// ͬϣطֽ׶ͳ
+bool ModelLoader::loadModel(const std::string& filePath, const ModelLoadOptions& options, ModelLoadStats& stats) {
+    auto result = std::make_shared<ModelLoadStats>();
+    bool success = loadModelAsync(filePath, options, result).get();
+    stats = *result;
+    return success;
+}
+
+// 첽ģļ롢תϴΪִ̳߳У
+// ɺŰԴȾ
+std::shared_future<bool> ModelLoader::loadModelAsync(const std::string& filePath, const ModelLoadOptions& options) {
+    return loadModelAsync(filePath, options, nullptr);
+}
+
+// ͬϣstats Ϊʱڽǰдֽ׶ͳ
+std::shared_future<bool> ModelLoader::loadModelAsync(const std::string& filePath, const ModelLoadOptions& options,
+    std::shared_ptr<ModelLoadStats> stats) {
+    auto state = std::make_shared<AsyncLoadState>();
+    state->filePath = filePath;
+    state->options = options;
+    state->startTime = std::chrono::steady_clock::now();
+    state->statsOut = std::move(stats);
+    std::shared_future<bool> future = state->promise.get_future().share();
+
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        pendingAsyncLoads++;
+    }
+    runTask([this, state]() { runAsyncImport(state); });
+    return future;
+}
+
+// ȴ첽
+void ModelLoader::waitForAsyncLoads() {
+    std::unique_lock<std::mutex> lock(asyncMutex);
+    asyncCondition.wait(lock, [this]() { return pendingAsyncLoads == 0; });
+}
+
+// ȡѷĻݿգȾ߳е
+std::shared_ptr<const ModelDrawData> ModelLoader::getDrawData() const {
+    return std::atomic_load(&drawData);
+}
+
+// ȡ決棬治ڡѹڻʱ false
+bool ModelLoader::loadCookedModel(AsyncLoadState& state) {
+    ModelCacheKey key;
+    if (!ModelCache::makeKey(state.filePath, IMPORT_FLAGS, vertexStride(state.options), processFlags(state.options),
+        processParameters(state.options), key)) {
+        return false;
+    }
+    std::string cachePath = ModelCache::cachePath(state.filePath);
+    if (!state.cacheFile.open(cachePath)) {
+        return false;
+    }
+    std::string error;
+    if (!ModelCache::read(state.cacheFile, key, state.cachedMeshes, state.textureRefs, state.nodes,
+        state.cachedInstanceNodes, error)) {
+        state.cacheFile.close();
+        state.cachedMeshes.clear();
+        state.cachedInstanceNodes.clear();
+        state.textureRefs.clear();
+        state.nodes.clear();
+        return false;
+    }
+    state.fromCache = true;
+    return true;
+}
+
+// ״εɹд決棬ʧֻ¼
+void ModelLoader::writeCookedModel(const AsyncLoadState& state) {
+    ModelCacheKey key;
+    if (!ModelCache::makeKey(state.filePath, IMPORT_FLAGS, vertexStride(state.options), processFlags(state.options),
+        processParameters(state.options), key)) {
+        return;
+    }
+    for (const std::string& path : state.importedFiles) {
+        if (!ModelCache::addDependency(path, key)) {
+            return;
         }
-        catch (const std::exception& e) {
-            logError("ģʱ쳣: " + std::string(e.what()));
-            return false;
+    }
+    std::string error;
+    if (!ModelCache::write(ModelCache::cachePath(state.filePath), key, makeMeshViews(state.meshData), state.textureRefs, state.nodes, error)) {
+        logError("дģͻʧ: " + state.filePath + " (" + error + ")");
+    }
+}
+
+std::vector<MeshDataView> ModelLoader::makeMeshViews(const std::vector<MeshData>& meshData) {
+    std::vector<MeshDataView> views;
+    views.reserve(meshData.size());
+    for (const MeshData& mesh : meshData) {
+        MeshDataView view;
+        if (!mesh.packedVertices.empty()) {
+            view.vertices = mesh.packedVertices.data();
+            view.vertexCount = static_cast<uint32_t>(mesh.packedVertices.size());
+        }
+        else {
+            view.vertices = mesh.vertices.data();
+            view.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+        }
+        if (!mesh.shortIndices.empty()) {
+            view.indices = mesh.shortIndices.data();
+            view.indexCount = static_cast<uint32_t>(mesh.shortIndices.size());
+            view.indexSize = sizeof(uint16_t);
         }
+        else {
+            view.indices = mesh.indices.data();
+            view.indexCount = static_cast<uint32_t>(mesh.indices.size());
+            view.indexSize = sizeof(uint32_t);
+        }
+        view.materialIndex = mesh.materialIndex;
+        view.instanceNodes = mesh.instanceNodes.data();
+        view.instanceCount = static_cast<uint32_t>(mesh.instanceNodes.size());
+        view.lodCount = mesh.lodCount;
+        std::copy(mesh.lods, mesh.lods + MAX_MESH_LODS, view.lods);
+        for (int axis = 0; axis < 3; axis++) {
+            view.boundsMin[axis] = mesh.boundsMin[axis];
+            view.boundsMax[axis] = mesh.boundsMax[axis];
+        }
+        views.push_back(view);
     }
+    return views;
+}
 
-private:
-    VkDevice device;  // Vulkan 豸
-    VkPhysicalDevice physicalDevice;  // Vulkan 豸
-    VkQueue graphicsQueue;  // Vulkan ͼζ
-    VkCommandPool commandPool;  // Vulkan 
-    std::unordered_map<std::string, Texture> loadedTextures;  // ѼĹϣӳ
-    std::vector<VkBuffer> vertexBuffers;  // 㻺
-    std::vector<VkDeviceMemory> vertexBufferMemories;  // 㻺ڴ
-    std::vector<VkBuffer> indexBuffers;  // 
-    std::vector<VkDeviceMemory> indexBufferMemories;  // ڴ
-    QMutex mutex;  // ̰߳ȫĻ
+// ѡӦĶʽС
+uint32_t ModelLoader::vertexStride(const ModelLoadOptions& options) {
+    return options.compactVertices ? sizeof(PackedVertex) : sizeof(Vertex);
+}
 
-    // ݹ鴦ڵ
-    void processNode(aiNode* node, const aiScene* scene) {
-        // ڵеÿ
-        for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            processMesh(mesh, scene);
-        }
-        // ݹ鴦ӽڵ
-        for (unsigned int i = 0; i < node->mNumChildren; i++) {
-            processNode(node->mChildren[i], scene);
+// ӰݵĺѡΪ決һ
+uint32_t ModelLoader::processFlags(const ModelLoadOptions& options) {
+    uint32_t flags = 0;
+    if (options.optimizeMeshes) {
+        flags |= 1u << 0;
+        if (options.optimizeOverdraw) {
+            flags |= 1u << 1;
         }
     }
+    flags |= std::min(options.lodLevels, MAX_MESH_LODS - 1) << 8;
+    return flags;
+}
+
+// ʹõĸĹϣΪ決һֻ֡õĴδʱ仯Ӱ컺
+uint64_t ModelLoader::processParameters(const ModelLoadOptions& options) {
+    uint64_t hash = 0;
+    if (options.optimizeMeshes && options.optimizeOverdraw) {
+        hash = hashBytes(&options.overdrawThreshold, sizeof(options.overdrawThreshold), hash);
+    }
+    if (options.lodLevels > 0) {
+        hash = hashBytes(&options.lodReduction, sizeof(options.lodReduction), hash);
+        hash = hashBytes(&options.lodTargetError, sizeof(options.lodTargetError), hash);
+    }
+    return hash;
+}
+
+// 볡ļģͼõⲿļ.bin.mtl ȣͨڴӳȡbytesRead ӳֽ
+// openedFiles ضȡļ
+const aiScene* ModelLoader::importScene(Assimp::Importer& importer, const std::string& filePath, uint64_t& bytesRead,
+    std::vector<std::string>& openedFiles) {
+    MappedIOSystem* ioSystem = new MappedIOSystem();
+    importer.SetIOHandler(ioSystem);  //  importer вͷ
+    const aiScene* scene = importer.ReadFile(filePath, IMPORT_FLAGS);
+    bytesRead = ioSystem->getBytesMapped();
+    openedFiles = ioSystem->getOpenedFiles();
+
+    // ģǷɹ
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        logError("ģͳ: " + std::string(filePath));
+        return nullptr;
+    }
+    return scene;
+}
+
+// ִ̳߳û̳߳ʱֱִ
+void ModelLoader::runTask(std::function<void()> task) {
+    if (asyncContext.enqueueTask) {
+        asyncContext.enqueueTask(std::move(task));
+    }
+    else {
+        task();
+    }
+}
 
-    // 
-    void processMesh(aiMesh* mesh, const aiScene* scene) {
-        std::vector<Vertex> vertices;  // 洢
-        std::vector<uint32_t> indices;  // 洢
+// 첽׶һ볡ȻΪÿͶת
+void ModelLoader::runAsyncImport(std::shared_ptr<AsyncLoadState> state) {
+    //  1 ʼֹȫͶǰʹϴ׶
+    state->remainingTasks = 1;
 
-        // ÿ㣬ȡ
-        for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-            Vertex vertex;
-            vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);  // λ
-            if (mesh->HasNormals()) {
-                vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);  // 㷨
+    try {
+        // Чʱ Assimp ת
+        bool cached;
+        uint64_t importBytes = 0;
+        {
+            StageTimer timer(state->importTime);
+            cached = state->options.useModelCache && loadCookedModel(*state);
+            if (!cached) {
+                state->scene = importScene(state->importer, state->filePath, importBytes, state->importedFiles);
             }
-            // 
-            if (mesh->mTextureCoords[0]) {
-                vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
-                // ߺ͸
-                if (mesh->HasTangentsAndBitangents()) {
-                    vertex.Tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
-                    vertex.Bitangent = glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
-                }
+        }
+        if (cached) {
+            state->bytesRead.add(state->cacheFile.size());
+        }
+        else {
+            if (!state->scene) {
+                finishAsyncLoad(state, false);
+                return;
             }
-            else {
-                vertex.TexCoords = glm::vec2(0.0f, 0.0f);  // û꣬ʹĬֵ
+            state->bytesRead.add(importBytes);
+
+            StageTimer timer(state->processNodesTime);
+            processNode(state->scene->mRootNode, state->scene, -1, *state);
+        }
+
+        // ռȫʵ·ٲн
+        if (state->fromCache) {
+            for (const auto& reference : state->textureRefs) {
+                claimTexture(reference, state, state->claimedTextures);
+            }
+        }
+        else {
+            for (unsigned int i = 0; i < state->scene->mNumMaterials; i++) {
+                collectMaterialTextures(state->scene->mMaterials[i], i, state, state->claimedTextures);
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        logError("ģʱ쳣: " + std::string(e.what()));
+        // ٽ룬Ҫͷţμصȴɺϴ׶ΰʧܽ
+        state->failed = true;
+        releaseClaimedTextures(*state);
+        completeAsyncTask(state);
+        return;
+    }
+
+    size_t meshCount = state->meshes.size();
+    state->meshData.resize(meshCount);
+    for (size_t i = 0; i < meshCount; i++) {
+        state->meshData[i].instanceNodes = std::move(state->meshNodes[i]);
+        state->remainingTasks++;
+        runTask([this, state, i]() {
+            try {
+                StageTimer timer(state->meshConvertTime);
+                processMesh(state->meshes[i], state->meshData[i], state->options);
+            }
+            catch (const std::exception& e) {
+                logError("ʱ쳣: " + std::string(e.what()));
+                state->failed = true;
+            }
+            completeAsyncTask(state);
+        });
+    }
+
+    for (const auto& entry : state->claimedTextures) {
+        runTask([this, state, entry]() {
+            {
+                StageTimer timer(state->textureDecodeTime);
+                decodeTexture(*entry);
             }
-            vertices.push_back(vertex);  // 洢
+            state->bytesRead.add(entry->sourceBytes);
+            completeAsyncTask(state);
+        });
+    }
+
+    completeAsyncTask(state);
+}
+
+// һϴǰɣһɵͶϴ׶
+void ModelLoader::completeAsyncTask(const std::shared_ptr<AsyncLoadState>& state) {
+    if (--state->remainingTasks == 0) {
+        runTask([this, state]() { runAsyncUpload(state); });
+    }
+}
+
+// 첽׶ζϴͼݲ
+void ModelLoader::runAsyncUpload(std::shared_ptr<AsyncLoadState> state) {
+    if (state->failed) {
+        releaseClaimedTextures(*state);
+        finishAsyncLoad(state, false);
+        return;
+    }
+    try {
+        if (state->options.optimizeMeshes && !state->fromCache) {
+            reportOptimizationStats(*state);
         }
+        uploadModel(*state);
+        if (state->options.useModelCache && !state->fromCache) {
+            writeCookedModel(*state);
+        }
+        finishAsyncLoad(state, true);
+    }
+    catch (const std::exception& e) {
+        logError("ģʱ쳣: " + std::string(e.what()));
+        releaseClaimedTextures(*state);
+        finishAsyncLoad(state, false);
+    }
+}
+
+// ģ͵ŻЧACMR Ȩ
+void ModelLoader::reportOptimizationStats(const AsyncLoadState& state) {
+    size_t triangleCount = 0;
+    double missesBefore = 0.0;
+    double missesAfter = 0.0;
+    for (const MeshData& mesh : state.meshData) {
+        const MeshOptimizationStats& stats = mesh.optimizationStats;
+        triangleCount += stats.triangleCount;
+        missesBefore += static_cast<double>(stats.acmrBefore) * stats.triangleCount;
+        missesAfter += static_cast<double>(stats.acmrAfter) * stats.triangleCount;
+    }
+    if (triangleCount == 0) {
+        return;
+    }
+    char text[128];
+    snprintf(text, sizeof(text), "%zu ΣACMR %.3f -> %.3f%u  FIFO 棩", triangleCount,
+        missesBefore / triangleCount, missesAfter / triangleCount, MESH_OPTIMIZER_FIFO_SIZE);
+    logInfo("Ż: " + state.filePath + " " + text);
+}
+
+void ModelLoader::finishAsyncLoad(const std::shared_ptr<AsyncLoadState>& state, bool result) {
+    if (state->statsOut || state->options.logLoadStats) {
+        ModelLoadStats stats = collectLoadStats(*state, result);
+        if (state->options.logLoadStats) {
+            logInfo("ͳ: " + state->filePath + " " + stats.toJson());
+        }
+        if (state->statsOut) {
+            *state->statsOut = stats;
+        }
+    }
+    state->promise.set_value(result);
+    std::lock_guard<std::mutex> lock(asyncMutex);
+    pendingAsyncLoads--;
+    asyncCondition.notify_all();
+}
 
-        // 
-        for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-            aiFace face = mesh->mFaces[i];
-            for (unsigned int j = 0; j < face.mNumIndices; j++) {
-                indices.push_back(face.mIndices[j]);  // 洢
+// һμصķֽ׶ͳ
+ModelLoadStats ModelLoader::collectLoadStats(const AsyncLoadState& state, bool result) {
+    ModelLoadStats stats;
+    stats.success = result;
+    stats.fromCache = state.fromCache;
+    stats.totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - state.startTime).count();
+    stats.importMs = state.importTime.milliseconds();
+    stats.processNodesMs = state.processNodesTime.milliseconds();
+    stats.meshConvertMs = state.meshConvertTime.milliseconds();
+    stats.textureDecodeMs = state.textureDecodeTime.milliseconds();
+    stats.textureUploadMs = state.textureUploadTime.milliseconds();
+    stats.meshUploadMs = state.meshUploadTime.milliseconds();
+    stats.submitMs = state.submitTime.milliseconds();
+    stats.bytesRead = state.bytesRead.get();
+    stats.bytesUploaded = state.bytesUploaded.get();
+    stats.meshCount = state.fromCache ? state.cachedMeshes.size() : state.meshData.size();
+    stats.vertexCount = state.vertexCount.get();
+    stats.indexCount = state.indexCount.get();
+    stats.textureCount = state.textureCount.get();
+    stats.subAllocations = state.subAllocations.get();
+    stats.deviceAllocations = state.deviceAllocations.get();
+#if MODEL_LOADER_STATS
+    stats.peakHostBytes = peakResidentBytes();
+#endif
+    return stats;
+}
+
+// ϴ׶Σͻȫɺ󷢲µĻ
+void ModelLoader::uploadModel(AsyncLoadState& state) {
+    QMutexLocker uploadLocker(&uploadMutex);
+    loadOptions = state.options;
+    ensureUploadBatcher();
+    if (loadOptions.streamTextures) {
+        ensureTextureStreamer();
+    }
+    pendingTextures.clear();
+    pendingMeshes.clear();
+
+#if MODEL_LOADER_STATS
+    uint64_t allocationsBefore, deviceAllocationsBefore;
+    allocator->getAllocationTotals(allocationsBefore, deviceAllocationsBefore);
+#endif
+
+    {
+        StageTimer timer(state.textureUploadTime);
+        for (const auto& entry : state.textures) {
+            VkDeviceSize bytes = uploadTexture(*entry);
+            if (bytes > 0) {
+                state.bytesUploaded.add(bytes);
+                state.textureCount.add(1);
             }
         }
+    }
 
-        // вʣز
-        if (mesh->mMaterialIndex >= 0) {
-            aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-            loadMaterialTextures(material, scene);
+    // ʱֱӴӳڴдݴ
+    std::vector<MeshDataView> meshes = state.fromCache ? state.cachedMeshes : makeMeshViews(state.meshData);
+    size_t firstRange = meshRanges.size();
+    {
+        StageTimer timer(state.meshUploadTime);
+        for (const MeshDataView& mesh : meshes) {
+            uploadMesh(mesh);
+            appendMeshTextures(mesh.materialIndex, state.textureRefs);
+            state.vertexCount.add(mesh.vertexCount);
+            state.indexCount.add(mesh.indexCount);
+            state.bytesUploaded.add(static_cast<uint64_t>(vertexStride(loadOptions)) * mesh.vertexCount
+                + static_cast<uint64_t>(mesh.indexSize) * mesh.indexCount);
         }
 
-        // 㻺
-        createVertexBuffer(vertices);
-        createIndexBuffer(indices);
+        // ģʽһϴģ͵Ķ/
+        if (loadOptions.unifiedGeometry) {
+            flushUnifiedGeometry();
+        }
+    }
+    appendScene(state.nodes, meshes, firstRange);
+    {
+        StageTimer timer(state.meshUploadTime);
+        updateInstanceBuffer();  // ʹ appendScene ʵ
     }
 
-    // زʵ
-    void loadMaterialTextures(aiMaterial* material, const aiScene* scene) {
-        loadTexture(material, aiTextureType_DIFFUSE, "texture_diffuse");  // 
-        loadTexture(material, aiTextureType_NORMALS, "texture_normal");   // ط
-        loadTexture(material, aiTextureType_SPECULAR, "texture_specular");  // ظ߹
+    // ģ͵Ŀһύȴɺ󷢲۱滻ľɻ
+    {
+        StageTimer timer(state.submitTime);
+        uploadBatcher->flush();
+    }
+    // ϴɺŵǼǵ棬ʱԴѾ
+    for (const auto& pending : pendingTextures) {
+        resourceCache->publishTexture(pending.first, pending.second);
+    }
+    for (const auto& pending : pendingMeshes) {
+        resourceCache->publishMesh(pending.first, pending.second);
     }
+    pendingTextures.clear();
+    pendingMeshes.clear();
+#if MODEL_LOADER_STATS
+    uint64_t allocationsAfter, deviceAllocationsAfter;
+    allocator->getAllocationTotals(allocationsAfter, deviceAllocationsAfter);
+    state.subAllocations.add(allocationsAfter - allocationsBefore);
+    state.deviceAllocations.add(deviceAllocationsAfter - deviceAllocationsBefore);
+#endif
 
-    // ص
-    void loadTexture(aiMaterial* material, aiTextureType type, const std::string& typeName) {
-        for (unsigned int i = 0; i < material->GetTextureCount(type); i++) {
-            aiString str;
-            material->GetTexture(type, i, &str);
+    // ֮ǰȾ߳̿ڰɿ¼ƣɻ¿շ֮
+    publishDrawData();
+    for (auto& retired : retiredBuffers) {
+        retireBuffer(retired.first, retired.second);
+    }
+    retiredBuffers.clear();
+}
+
+// ÷ uploadMutex
+void ModelLoader::ensureUploadBatcher() {
+    if (!uploadBatcher) {
+        UploadQueue graphicsUpload;
+        graphicsUpload.queue = graphicsQueue;
+        graphicsUpload.commandPool = commandPool;
+        graphicsUpload.familyIndex = asyncContext.graphicsQueueFamily;
+        graphicsUpload.mutex = asyncContext.queueMutex;
+        uploadBatcher = std::make_unique<UploadBatcher>(device, physicalDevice, allocator, graphicsUpload,
+            asyncContext.transferQueue);
+        uploadBatcher->setProfiler(asyncContext.profiler);
+    }
+}
+
+// ʽԤβСȡ״ʽصѡ÷ uploadMutex
+void ModelLoader::ensureTextureStreamer() {
+    if (textureStreamer) {
+        return;
+    }
+    TextureStreamerContext context;
+    context.enqueueTask = asyncContext.enqueueTask;
+    context.deferDestroy = asyncContext.deferDestroy;
+    context.decode = [this](const std::string& path, DecodedTextureLevels& levels) {
+        return decodeStreamedTexture(path, levels);
+    };
+    // 㼶лʽĺ̨еύģϴ
+    context.upload = [this](const std::function<void(UploadBatcher&)>& record) {
+        QMutexLocker uploadLocker(&uploadMutex);
+        ensureUploadBatcher();
+        try {
+            record(*uploadBatcher);
+        }
+        catch (...) {
+            uploadBatcher->flush();  // ¼ƵĿɺ÷Ŀͼ
+            throw;
+        }
+        uploadBatcher->flush();
+    };
+    VkDeviceSize budget = loadOptions.textureBudget > 0 ? loadOptions.textureBudget : asyncContext.textureMemoryBudget;
+    textureStreamer = std::make_unique<TextureStreamer>(device, allocator, context, budget, loadOptions.streamingTailSize);
+}
 
-            // ǷѾ
-            if (loadedTextures.find(str.C_Str()) != loadedTextures.end()) {
-                continue;  // Ѽأ
+// ¼õʽÿϴһ
+void ModelLoader::appendMeshTextures(uint32_t materialIndex, const std::vector<TextureReference>& textureRefs) {
+    QMutexLocker locker(&mutex);
+    size_t first = meshTextures.size();
+    meshTextureOffsets.push_back(static_cast<uint32_t>(first));
+    for (const auto& reference : textureRefs) {
+        if (reference.materialIndex != materialIndex) {
+            continue;
+        }
+        auto it = streamedTextures.find(reference.path);
+        if (it != streamedTextures.end() && std::find(meshTextures.begin() + first, meshTextures.end(), it->second) == meshTextures.end()) {
+            meshTextures.push_back(it->second);
+        }
+    }
+}
+
+// õǰԴµĿղԭ滻
+void ModelLoader::publishDrawData() {
+    auto data = std::make_shared<ModelDrawData>();
+    data->vertexBuffers = vertexBuffers;
+    data->indexBuffers = indexBuffers;
+    data->meshRanges = meshRanges;
+    data->unifiedVertexBuffer = unifiedGeometry.vertexBuffer;
+    data->unifiedIndexBuffer = unifiedGeometry.indexBuffer;
+    data->indirectBuffer = unifiedGeometry.indirectBuffer;
+    data->drawCount = unifiedGeometry.drawCount;
+    data->packedVertices = loadOptions.compactVertices;
+    data->instanceBuffer = instanceBuffer;
+    for (const MeshRange& range : meshRanges) {
+        data->hasLods = data->hasLods || range.lodCount > 1;
+    }
+    data->scene = std::make_shared<const SceneData>(sceneData);
+    data->textureStreamer = textureStreamer.get();
+    if (textureStreamer) {
+        QMutexLocker locker(&mutex);
+        data->meshTextureOffsets = meshTextureOffsets;
+        data->meshTextureOffsets.push_back(static_cast<uint32_t>(meshTextures.size()));
+        data->meshTextures = meshTextures;
+    }
+    std::atomic_store(&drawData, std::shared_ptr<const ModelDrawData>(std::move(data)));
+}
+
+// ѱμصĽڵ㼶׷ӵʵռΧСȫʵΧеĲ
+// ʵؽΧ
+void ModelLoader::appendScene(const std::vector<SceneNodeData>& nodes, const std::vector<MeshDataView>& meshes, size_t firstRange) {
+    int32_t nodeOffset = static_cast<int32_t>(sceneData.nodeParents.size());
+    for (const SceneNodeData& node : nodes) {
+        glm::mat4 local = glm::make_mat4(node.localTransform);
+        int32_t parent = node.parent < 0 ? -1 : node.parent + nodeOffset;
+        sceneData.nodeParents.push_back(parent);
+        sceneData.nodeLocalMatrices.push_back(local);
+        // ڵǰ棬Ѿ
+        sceneData.nodeWorldMatrices.push_back(parent < 0 ? local : sceneData.nodeWorldMatrices[parent] * local);
+    }
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const MeshRange& range = meshRanges[firstRange + i];
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+        float scale = 0.0f;
+        for (uint32_t k = 0; k < meshes[i].instanceCount; k++) {
+            uint32_t node = meshes[i].instanceNodes[k] + static_cast<uint32_t>(nodeOffset);
+            const glm::mat4& world = sceneData.nodeWorldMatrices[node];
+            glm::vec3 worldMin;
+            glm::vec3 worldMax;
+            transformBounds(world, range.boundsMin, range.boundsMax, worldMin, worldMax);
+            boundsMin = glm::min(boundsMin, worldMin);
+            boundsMax = glm::max(boundsMax, worldMax);
+            scale = std::max(scale, maxScale(world));
+            sceneData.instanceNodes.push_back(node);
+            sceneData.instanceMeshes.push_back(static_cast<uint32_t>(firstRange + i));
+            sceneData.instanceMatrices.push_back(world);
+            sceneData.instanceBoundsMin.push_back(worldMin);
+            sceneData.instanceBoundsMax.push_back(worldMax);
+        }
+        sceneData.worldScales.push_back(scale);
+        sceneData.worldBoundsMin.push_back(boundsMin);
+        sceneData.worldBoundsMax.push_back(boundsMax);
+    }
+    sceneData.bvh.build(sceneData.instanceBoundsMin, sceneData.instanceBoundsMax);
+}
+
+// ٿԱ;֡õĻ
+void ModelLoader::retireBuffer(VkBuffer& buffer, MemoryAllocation& bufferMemory) {
+    if (buffer == VK_NULL_HANDLE) {
+        return;
+    }
+    if (asyncContext.deferDestroy) {
+        VkBuffer retiredBuffer = buffer;
+        MemoryAllocation retiredMemory = bufferMemory;
+        DeviceMemoryAllocator* retiredAllocator = allocator;
+        asyncContext.deferDestroy([retiredAllocator, retiredBuffer, retiredMemory]() mutable {
+            retiredAllocator->destroyBuffer(retiredBuffer, retiredMemory);
+        });
+        buffer = VK_NULL_HANDLE;
+        bufferMemory = MemoryAllocation();
+    }
+    else {
+        allocator->destroyBuffer(buffer, bufferMemory);
+    }
+}
+
+// ݹ鴦ڵ㣬˳¼ڵ㼶;ֲ任ռÿڵõ
+// ڵõֻռһΣÿΪһʵ
+void ModelLoader::processNode(aiNode* node, const aiScene* scene, int32_t parent, AsyncLoadState& state) {
+    // Assimp Ϊglm Ϊ
+    const aiMatrix4x4& m = node->mTransformation;
+    glm::mat4 local(m.a1, m.b1, m.c1, m.d1, m.a2, m.b2, m.c2, m.d2, m.a3, m.b3, m.c3, m.d3, m.a4, m.b4, m.c4, m.d4);
+    SceneNodeData nodeData;
+    nodeData.parent = parent;
+    memcpy(nodeData.localTransform, glm::value_ptr(local), sizeof(nodeData.localTransform));
+    int32_t index = static_cast<int32_t>(state.nodes.size());
+    state.nodes.push_back(nodeData);
+
+    // ڵеÿ
+    for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+        auto slot = state.meshSlots.emplace(node->mMeshes[i], static_cast<uint32_t>(state.meshes.size()));
+        if (slot.second) {
+            state.meshes.push_back(scene->mMeshes[node->mMeshes[i]]);
+            state.meshNodes.emplace_back();
+        }
+        state.meshNodes[slot.first->second].push_back(static_cast<uint32_t>(index));
+    }
+    // ݹ鴦ӽڵ
+    for (unsigned int i = 0; i < node->mNumChildren; i++) {
+        processNode(node->mChildren[i], scene, index, state);
+    }
+}
+
+// ֻ CPU תڹִ̲߳
+void ModelLoader::processMesh(aiMesh* mesh, MeshData& meshData, const ModelLoadOptions& options) {
+    std::vector<Vertex>& vertices = meshData.vertices;  // 洢
+    std::vector<uint32_t>& indices = meshData.indices;  // 洢
+    vertices.reserve(mesh->mNumVertices);
+    indices.reserve(mesh->mNumFaces * 3);
+
+    // ÿ㣬ȡ
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+        Vertex vertex;
+        vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);  // λ
+        if (mesh->HasNormals()) {
+            vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);  // 㷨
+        }
+        // 
+        if (mesh->mTextureCoords[0]) {
+            vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+            // ߺ͸
+            if (mesh->HasTangentsAndBitangents()) {
+                vertex.Tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+                vertex.Bitangent = glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
             }
+        }
+        else {
+            vertex.TexCoords = glm::vec2(0.0f, 0.0f);  // û꣬ʹĬֵ
+        }
+        vertices.push_back(vertex);  // 洢
+    }
+
+    // 
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+        aiFace face = mesh->mFaces[i];
+        for (unsigned int j = 0; j < face.mNumIndices; j++) {
+            indices.push_back(face.mIndices[j]);  // 洢
+        }
+    }
 
-            //  Vulkan 
-            Texture texture = createVulkanTexture(str.C_Str());
-            texture.type = typeName;
-            texture.path = str.C_Str();
+    meshData.materialIndex = mesh->mMaterialIndex;
 
-            // ʹûز
-            QMutexLocker locker(&mutex);
-            loadedTextures[str.C_Str()] = texture;
+    // ֻд԰źͼ
+    bool trianglesOnly = (mesh->mPrimitiveTypes & (aiPrimitiveType_POINT | aiPrimitiveType_LINE)) == 0;
+    if (options.optimizeMeshes && trianglesOnly) {
+        optimizeMesh(meshData, options);
+    }
+
+    // ΧУոʽΪΧ
+    if (!vertices.empty()) {
+        meshData.boundsMin = meshData.boundsMax = vertices[0].Position;
+        for (const Vertex& vertex : vertices) {
+            meshData.boundsMin = glm::min(meshData.boundsMin, vertex.Position);
+            meshData.boundsMax = glm::max(meshData.boundsMax, vertex.Position);
         }
     }
 
-    //  Vulkan 
-    Texture createVulkanTexture(const char* path) {
-        Texture texture{};
-        int width, height, channels;
-        unsigned char* pixels = stbi_load(path, &width, &height, &channels, STBI_rgb_alpha);  // ͼ
-        if (!pixels) {
-            logError("ʧ: " + std::string(path));  // ʧܣ¼
-            return texture;
+    meshData.lodCount = 1;
+    meshData.lods[0].indexCount = static_cast<uint32_t>(indices.size());
+    if (options.lodLevels > 0 && trianglesOnly) {
+        generateLods(meshData, options);
+    }
+
+    if (options.compactVertices) {
+        packMesh(meshData);
+    }
+}
+
+// ñ۵𼶼ԭʼ񣬼򻯺׷ԭʼ֮ԭʼ㡣
+// ޻ʹĳһ޷Լʱֹͣ
+void ModelLoader::generateLods(MeshData& meshData, const ModelLoadOptions& options) {
+    std::vector<uint32_t>& indices = meshData.indices;
+    const std::vector<Vertex>& vertices = meshData.vertices;
+    if (vertices.empty() || indices.size() < 3) {
+        return;
+    }
+
+    float targetError = options.lodTargetError * glm::length(meshData.boundsMax - meshData.boundsMin);
+    uint32_t lodLevels = std::min(options.lodLevels, MAX_MESH_LODS - 1);
+    size_t baseCount = indices.size();
+    size_t previousCount = baseCount;
+    std::vector<uint32_t> lod;
+    for (uint32_t level = 1; level <= lodLevels; level++) {
+        size_t targetCount = static_cast<size_t>(baseCount * std::pow(options.lodReduction, static_cast<float>(level))) / 3 * 3;
+        float error = simplifyMesh(indices.data(), baseCount, &vertices[0].Position.x, vertices.size(), sizeof(Vertex),
+            targetCount, targetError, lod);
+        if (lod.empty() || lod.size() > previousCount * 9 / 10) {
+            break;
         }
+        optimizeVertexCache(lod.data(), lod.size(), vertices.size());
 
-        VkDeviceSize imageSize = width * height * 4;  // ͼС
+        MeshLod& entry = meshData.lods[meshData.lodCount++];
+        entry.firstIndex = static_cast<uint32_t>(indices.size());
+        entry.indexCount = static_cast<uint32_t>(lod.size());
+        entry.error = error;
+        indices.insert(indices.end(), lod.begin(), lod.end());
+        previousCount = lod.size();
+    }
+}
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
+// Ż׶Σ㻺šѡĹȻ״ʹ˳Ŷ
+void ModelLoader::optimizeMesh(MeshData& meshData, const ModelLoadOptions& options) {
+    std::vector<Vertex>& vertices = meshData.vertices;
+    std::vector<uint32_t>& indices = meshData.indices;
+    if (vertices.empty() || indices.size() < 3) {
+        return;
+    }
 
-        // ݴ滺ڴ
-        createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer, stagingBufferMemory);
+    MeshOptimizationStats& stats = meshData.optimizationStats;
+    stats.triangleCount = indices.size() / 3;
+    stats.acmrBefore = computeACMR(indices.data(), indices.size(), vertices.size());
+    optimizeVertexCache(indices.data(), indices.size(), vertices.size());
+    if (options.optimizeOverdraw) {
+        optimizeOverdraw(indices.data(), indices.size(), &vertices[0].Position.x, vertices.size(), sizeof(Vertex),
+            options.overdrawThreshold);
+    }
+    stats.acmrAfter = computeACMR(indices.data(), indices.size(), vertices.size());
+    optimizeVertexFetch(indices.data(), indices.size(), vertices);
+}
 
-        // ݿݴ滺
-        void* data;
-        vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-        memcpy(data, pixels, static_cast<size_t>(imageSize));
-        vkUnmapMemory(device, stagingBufferMemory);
+// תΪնʽ 65536 ʱͬʱ 16 λ
+void ModelLoader::packMesh(MeshData& meshData) {
+    glm::vec3 extent = meshData.boundsMax - meshData.boundsMin;
+    glm::vec3 invExtent(extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+        extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+        extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+    meshData.packedVertices.reserve(meshData.vertices.size());
+    for (const Vertex& vertex : meshData.vertices) {
+        meshData.packedVertices.push_back(PackedVertex::pack(vertex, meshData.boundsMin, invExtent));
+    }
+    std::vector<Vertex>().swap(meshData.vertices);
 
-        stbi_image_free(pixels);  // ͷͼ
+    if (meshData.packedVertices.size() < 65536) {
+        meshData.shortIndices.assign(meshData.indices.begin(), meshData.indices.end());
+        std::vector<uint32_t>().swap(meshData.indices);
+    }
+}
 
-        //  Vulkan ͼ
-        createImage(width, height, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.image, texture.imageMemory);
+// ϴ
+void ModelLoader::uploadMesh(const MeshDataView& mesh) {
+    const unsigned char* vertices = static_cast<const unsigned char*>(mesh.vertices);
+    VkDeviceSize vertexBytes = static_cast<VkDeviceSize>(vertexStride(loadOptions)) * mesh.vertexCount;
 
-        //  Vulkan ͼͼ
-        createImageView(texture.image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, texture.imageView);
+    MeshRange range = {};
+    range.vertexCount = mesh.vertexCount;
+    range.materialIndex = mesh.materialIndex;
+    range.indexType = mesh.indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    range.boundsMin = glm::vec3(mesh.boundsMin[0], mesh.boundsMin[1], mesh.boundsMin[2]);
+    range.boundsMax = glm::vec3(mesh.boundsMax[0], mesh.boundsMax[1], mesh.boundsMax[2]);
 
-        //  Vulkan 
-        createSampler(texture.sampler);
+    //  0 ΪԭʼindexCount ֻһ򻯲㼶֮
+    range.lodCount = std::max(mesh.lodCount, 1u);
+    range.lods[0].indexCount = mesh.indexCount;
+    std::copy(mesh.lods, mesh.lods + mesh.lodCount, range.lods);
+    range.indexCount = range.lods[0].indexCount;
 
-        // ݴ滺
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+    // ʵʵа˳
+    range.firstInstance = meshRanges.empty() ? 0 : meshRanges.back().firstInstance + meshRanges.back().instanceCount;
+    range.instanceCount = mesh.instanceCount;
 
-        return texture;
+    // ģʽֻ¼ƫƣģʹͳһϴ
+    // ֻһͣ16 λչΪ 32 λ
+    if (loadOptions.unifiedGeometry) {
+        range.firstIndex = unifiedGeometry.indexCount + static_cast<uint32_t>(pendingIndices.size());
+        range.vertexOffset = static_cast<int32_t>(unifiedGeometry.vertexCount + pendingVertices.size() / vertexStride(loadOptions));
+        range.indexType = VK_INDEX_TYPE_UINT32;
+        for (uint32_t lod = 0; lod < range.lodCount; lod++) {
+            range.lods[lod].firstIndex += range.firstIndex;
+        }
+        pendingVertices.insert(pendingVertices.end(), vertices, vertices + vertexBytes);
+        if (mesh.indexSize == sizeof(uint16_t)) {
+            const uint16_t* indices = static_cast<const uint16_t*>(mesh.indices);
+            pendingIndices.insert(pendingIndices.end(), indices, indices + mesh.indexCount);
+        }
+        else {
+            const uint32_t* indices = static_cast<const uint32_t*>(mesh.indices);
+            pendingIndices.insert(pendingIndices.end(), indices, indices + mesh.indexCount);
+        }
+        meshRanges.push_back(range);
+        return;
+    }
+
+    // 㻺ͬ񣨱λ򻺴УͬһԻ
+    VkDeviceSize indexBytes = static_cast<VkDeviceSize>(mesh.indexSize) * mesh.indexCount;
+    uint64_t key = ResourceCache::meshKey(vertices, static_cast<size_t>(vertexBytes), vertexStride(loadOptions),
+        mesh.indices, static_cast<size_t>(indexBytes), mesh.indexSize);
+    MeshHandle resource;
+    auto pending = pendingMeshes.find(key);
+    if (pending != pendingMeshes.end()) {
+        resource = pending->second;
+        resourceCache->countMeshHit();
+    }
+    else {
+        resource = resourceCache->findMesh(key);
     }
+    if (!resource) {
+        CachedMesh created;
+        createDeviceLocalBuffer(vertices, vertexBytes, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, created.vertexBuffer, created.vertexMemory);
+        createDeviceLocalBuffer(mesh.indices, indexBytes, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, created.indexBuffer, created.indexMemory);
+        resource = resourceCache->wrapMesh(created);
+        pendingMeshes[key] = resource;
+    }
+    vertexBuffers.push_back(resource->vertexBuffer);
+    indexBuffers.push_back(resource->indexBuffer);
+    meshResources.push_back(resource);
+    meshRanges.push_back(range);
+}
 
-    //  Vulkan 
-    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-        VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
-        VkBufferCreateInfo bufferInfo = {};
-        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufferInfo.size = size;
-        bufferInfo.usage = usage;
-        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+// ǰȫʵؽʵ firstInstance һ¡Ⱦļ޳Դ洢ȡʵ
+void ModelLoader::updateInstanceBuffer() {
+    std::vector<MeshInstance> instances;
+    instances.reserve(sceneData.instanceMatrices.size());
+    for (const MeshRange& range : meshRanges) {
+        MeshInstance instance;
+        instance.scale = glm::vec4(range.boundsMax - range.boundsMin, 0.0f);
+        instance.offset = glm::vec4(range.boundsMin, 1.0f);
+        for (uint32_t i = 0; i < range.instanceCount; i++) {
+            instance.world = sceneData.instanceMatrices[range.firstInstance + i];
+            instances.push_back(instance);
+        }
+    }
 
-        vkCreateBuffer(device, &bufferInfo, nullptr, &buffer);
+    // ʵԱѷĻãݺ
+    if (instanceBuffer != VK_NULL_HANDLE) {
+        retiredBuffers.emplace_back(instanceBuffer, instanceMemory);
+        instanceBuffer = VK_NULL_HANDLE;
+        instanceMemory = MemoryAllocation();
+    }
+    if (!instances.empty()) {
+        createDeviceLocalBuffer(instances.data(), sizeof(MeshInstance) * instances.size(),
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, instanceBuffer, instanceMemory);
+    }
+}
 
-        VkMemoryRequirements memRequirements;
-        vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+// ϴĶ/׷ӵؽӻ
+void ModelLoader::flushUnifiedGeometry() {
+    if (!pendingVertices.empty()) {
+        VkDeviceSize stride = vertexStride(loadOptions);
+        VkDeviceSize usedBytes = stride * unifiedGeometry.vertexCount;
+        appendToUnifiedBuffer(unifiedGeometry.vertexBuffer, unifiedGeometry.vertexMemory, unifiedGeometry.vertexCapacity,
+            usedBytes, pendingVertices.data(), pendingVertices.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        unifiedGeometry.vertexCount += static_cast<uint32_t>(pendingVertices.size() / stride);
+    }
+    if (!pendingIndices.empty()) {
+        VkDeviceSize usedBytes = sizeof(uint32_t) * unifiedGeometry.indexCount;
+        appendToUnifiedBuffer(unifiedGeometry.indexBuffer, unifiedGeometry.indexMemory, unifiedGeometry.indexCapacity,
+            usedBytes, pendingIndices.data(), sizeof(uint32_t) * pendingIndices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        unifiedGeometry.indexCount += static_cast<uint32_t>(pendingIndices.size());
+    }
+    pendingVertices.clear();
+    pendingIndices.clear();
 
-        VkMemoryAllocateInfo allocInfo = {};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+    // ÿһʵļӻfirstInstance Ϊ׸ʵȾļ޳Դ洢ȡЩ
+    std::vector<VkDrawIndexedIndirectCommand> commands;
+    commands.reserve(meshRanges.size());
+    for (size_t i = 0; i < meshRanges.size(); i++) {
+        VkDrawIndexedIndirectCommand command = {};
+        command.indexCount = meshRanges[i].indexCount;
+        command.instanceCount = meshRanges[i].instanceCount;
+        command.firstIndex = meshRanges[i].firstIndex;
+        command.vertexOffset = meshRanges[i].vertexOffset;
+        command.firstInstance = meshRanges[i].firstInstance;
+        commands.push_back(command);
+    }
 
-        vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory);
-        vkBindBufferMemory(device, buffer, bufferMemory, 0);
+    if (unifiedGeometry.indirectBuffer != VK_NULL_HANDLE) {
+        retiredBuffers.emplace_back(unifiedGeometry.indirectBuffer, unifiedGeometry.indirectMemory);
+        unifiedGeometry.indirectBuffer = VK_NULL_HANDLE;
+        unifiedGeometry.indirectMemory = MemoryAllocation();
+    }
+    unifiedGeometry.drawCount = static_cast<uint32_t>(commands.size());
+    if (!commands.empty()) {
+        createDeviceLocalBuffer(commands.data(), sizeof(VkDrawIndexedIndirectCommand) * commands.size(),
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, unifiedGeometry.indirectBuffer,
+            unifiedGeometry.indirectMemory);
     }
+}
 
-    //  Vulkan ͼ
-    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
-        VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) {
-        VkImageCreateInfo imageInfo = {};
-        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-        imageInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageInfo.format = format;
-        imageInfo.extent.width = width;
-        imageInfo.extent.height = height;
-        imageInfo.extent.depth = 1;
-        imageInfo.mipLevels = 1;
-        imageInfo.arrayLayers = 1;
-        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-        imageInfo.tiling = tiling;
-        imageInfo.usage = usage;
-        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        vkCreateImage(device, &imageInfo, nullptr, &image);
-
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(device, image, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo = {};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory);
-        vkBindImageMemory(device, image, imageMemory, 0);
+// ĩβ׷ݣʱݲ GPU Ͽ
+void ModelLoader::appendToUnifiedBuffer(VkBuffer& buffer, MemoryAllocation& bufferMemory, VkDeviceSize& capacity,
+    VkDeviceSize usedBytes, const void* data, VkDeviceSize size, VkBufferUsageFlags usage) {
+    VkBufferUsageFlags bufferUsage = usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (usedBytes + size > capacity) {
+        VkDeviceSize newCapacity = std::max(capacity * 2, usedBytes + size);
+        VkBuffer newBuffer;
+        MemoryAllocation newBufferMemory;
+        createBuffer(newCapacity, bufferUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, newBuffer, newBufferMemory);
+        if (usedBytes > 0) {
+            uploadBatcher->copyBuffer(buffer, newBuffer, usedBytes);
+        }
+        if (buffer != VK_NULL_HANDLE) {
+            retiredBuffers.emplace_back(buffer, bufferMemory);
+        }
+        buffer = newBuffer;
+        bufferMemory = newBufferMemory;
+        capacity = newCapacity;
     }
 
-    //  Vulkan ͼͼ
-    void createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask, VkImageView& imageView) {
-        VkImageViewCreateInfo viewInfo = {};
-        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        viewInfo.image = image;
-        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewInfo.format = format;
-        viewInfo.subresourceRange.aspectMask = aspectMask;
-        viewInfo.subresourceRange.baseMipLevel = 0;
-        viewInfo.subresourceRange.levelCount = 1;
-        viewInfo.subresourceRange.baseArrayLayer = 0;
-        viewInfo.subresourceRange.layerCount = 1;
+    uploadBatcher->uploadBuffer(buffer, usedBytes, data, size);
+}
 
-        vkCreateImageView(device, &viewInfo, nullptr, &imageView);
+// ռʵ
+void ModelLoader::collectMaterialTextures(aiMaterial* material, uint32_t materialIndex, const std::shared_ptr<AsyncLoadState>& state,
+    std::vector<std::shared_ptr<TextureDecodeEntry>>& claimed) {
+    collectTexture(material, materialIndex, aiTextureType_DIFFUSE, "texture_diffuse", state, claimed);  // 
+    collectTexture(material, materialIndex, aiTextureType_NORMALS, "texture_normal", state, claimed);   // 
+    collectTexture(material, materialIndex, aiTextureType_SPECULAR, "texture_specular", state, claimed);  // ߹
+}
+
+// ռ͵¼
+void ModelLoader::collectTexture(aiMaterial* material, uint32_t materialIndex, aiTextureType type, const std::string& typeName,
+    const std::shared_ptr<AsyncLoadState>& state, std::vector<std::shared_ptr<TextureDecodeEntry>>& claimed) {
+    for (unsigned int i = 0; i < material->GetTextureCount(type); i++) {
+        aiString str;
+        material->GetTexture(type, i, &str);
+
+        TextureReference reference;
+        reference.typeName = typeName;
+        reference.path = str.C_Str();
+        reference.materialIndex = materialIndex;
+        // Ƕ"*0" ʽţ FBX Ƕļͬ·ֱóе
+        const aiTexture* embedded = state->scene->GetEmbeddedTexture(str.C_Str());
+        if (embedded && embedded->pcData && embedded->mWidth > 0) {
+            reference.embeddedData = reinterpret_cast<const unsigned char*>(embedded->pcData);
+            if (embedded->mHeight > 0) {
+                reference.embeddedWidth = embedded->mWidth;
+                reference.embeddedHeight = embedded->mHeight;
+                reference.embeddedSize = static_cast<uint64_t>(embedded->mWidth) * embedded->mHeight * sizeof(aiTexel);
+            }
+            else {
+                reference.embeddedSize = embedded->mWidth;  // mHeight Ϊ 0 ʱ mWidth ѹݵֽ
+            }
+        }
+
+        state->textureRefs.push_back(reference);
+        claimTexture(reference, state, claimed);
     }
+}
 
-    //  Vulkan 
-    void createSampler(VkSampler& sampler) {
-        VkSamplerCreateInfo samplerInfo = {};
-        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-        samplerInfo.magFilter = VK_FILTER_LINEAR;
-        samplerInfo.minFilter = VK_FILTER_LINEAR;
-        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-        samplerInfo.unnormalizedCoordinates = VK_FALSE;
-        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-        samplerInfo.mipLodBias = 0.0f;
-        samplerInfo.minLod = 0.0f;
-        samplerInfo.maxLod = 1.0f;
-
-        vkCreateSampler(device, &samplerInfo, nullptr, &sampler);
-    }
-
-    // ڴ
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-        VkPhysicalDeviceMemoryProperties memProperties;
-        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-        for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-            if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-                return i;
+// ȴһѼصڽĵȴɣɱμ첢
+void ModelLoader::claimTexture(const TextureReference& reference,
+    const std::shared_ptr<AsyncLoadState>& state, std::vector<std::shared_ptr<TextureDecodeEntry>>& claimed) {
+    // Ƕ·ֻģ壨 "*0"ģ·Ϊ
+    std::string path = reference.embeddedData ? state->filePath + "::" + reference.path : reference.path;
+    QMutexLocker locker(&mutex);
+
+    // ǷѾ
+    if (loadedTextures.find(path) != loadedTextures.end() || streamedTextures.find(path) != streamedTextures.end()) {
+        return;  // Ѽأ
+    }
+
+    auto it = decodingTextures.find(path);
+    if (it != decodingTextures.end()) {
+        // ͬһģظã
+        const std::shared_ptr<TextureDecodeEntry>& entry = it->second;
+        if (std::find(state->textures.begin(), state->textures.end(), entry) != state->textures.end()) {
+            return;
+        }
+        state->textures.push_back(entry);
+        if (!entry->done) {
+            state->remainingTasks++;
+            entry->waiters.push_back([this, state]() { completeAsyncTask(state); });
+        }
+        return;
+    }
+
+    auto entry = std::make_shared<TextureDecodeEntry>();
+    entry->path = path;
+    entry->typeName = reference.typeName;
+    entry->streamed = state->options.streamTextures && !reference.embeddedData;  // ʽҪ·¶ȡ
+    entry->embeddedData = reference.embeddedData;
+    entry->embeddedSize = reference.embeddedSize;
+    entry->embeddedWidth = reference.embeddedWidth;
+    entry->embeddedHeight = reference.embeddedHeight;
+    entry->samplerVariant = samplerVariant(state->options);
+    decodingTextures[path] = entry;
+    state->textures.push_back(entry);
+    state->remainingTasks++;
+    claimed.push_back(entry);
+}
+
+// أڹִ̲߳
+void ModelLoader::decodeTexture(TextureDecodeEntry& entry) {
+    // Ȳ鹲棺·ԤʱȡļӳļݲңδʱֱӴӳڴ롣
+    // Ƕֻݲңʽ TextureStreamer У
+    MappedFile content;
+    const unsigned char* source = entry.embeddedData;
+    size_t sourceSize = static_cast<size_t>(entry.embeddedSize);
+    if (source) {
+        entry.cached = resourceCache->findTextureByContent(std::string(), source, sourceSize, entry.samplerVariant, entry.cacheKey);
+        entry.cacheable = !entry.cached;
+    }
+    else if (!entry.streamed) {
+        entry.cached = resourceCache->findTextureByPath(entry.path, entry.samplerVariant);
+        if (!entry.cached && openTextureFile(entry, content)) {
+            source = content.data();
+            sourceSize = content.size();
+            entry.cached = resourceCache->findTextureByContent(entry.path, source, sourceSize,
+                entry.samplerVariant, entry.cacheKey);
+            entry.cacheable = !entry.cached;
+        }
+    }
+    if (entry.cached) {
+        finishDecode(entry);  // ʱֱӹϴ
+        return;
+    }
+
+    // 豸ֵ֧Ԥѹ汾ʱֱʹݣٽ
+    if (!entry.embeddedData && loadCompressedTexture(entry.path, entry.image.compressed)) {
+        entry.sourceBytes += entry.image.compressed.data.size();
+    }
+    else {
+        if (!source && openTextureFile(entry, content)) {
+            source = content.data();
+            sourceSize = content.size();
+        }
+        int width = 0, height = 0;
+        if (entry.embeddedWidth > 0) {
+            width = static_cast<int>(entry.embeddedWidth);
+            height = static_cast<int>(entry.embeddedHeight);
+            entry.image.pixels = { convertTexels(source, sourceSize, entry.embeddedWidth, entry.embeddedHeight), std::free };
+        }
+        else {
+            entry.image.pixels.reset(decodeImage(source, sourceSize, width, height));
+        }
+        if (!entry.image.pixels) {
+            logError("ʧ: " + entry.path);  // ʧܣ¼
+        }
+        else {
+            entry.image.width = width;
+            entry.image.height = height;
+            if (!gpuMipmaps || entry.streamed) {
+                generateMipChainRGBA8(entry.image.pixels.get(), static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                    entry.image.mipChain);
             }
         }
+    }
+    finishDecode(entry);
+}
+
+// ӳļԤ¼ȡֽ
+bool ModelLoader::openTextureFile(TextureDecodeEntry& entry, MappedFile& file) {
+    if (!file.open(entry.path)) {
+        return false;
+    }
+    file.prefetch();
+    entry.sourceBytes = file.size();
+    return true;
+}
 
-        throw std::runtime_error("޷ҵʵڴͣ");
+// ڴеͼļPNGJPEG ȣ RGBA8 أʧʱؿգ stbi_image_free ͷ
+unsigned char* ModelLoader::decodeImage(const unsigned char* data, size_t size, int& width, int& height) {
+    if (!data || size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        return nullptr;
     }
+    int channels = 0;
+    return stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, STBI_rgb_alpha);
+}
 
-    //  Vulkan Դ
-    void cleanup() {
-        for (auto& texturePair : loadedTextures) {
-            vkDestroySampler(device, texturePair.second.sampler, nullptr);
-            vkDestroyImageView(device, texturePair.second.imageView, nullptr);
-            vkDestroyImage(device, texturePair.second.image, nullptr);
-            vkFreeMemory(device, texturePair.second.imageMemory, nullptr);
+// δѹǶ aiTexelBGRA8תΪ RGBA8ݲʱؿգ std::free ͷ
+unsigned char* ModelLoader::convertTexels(const unsigned char* texels, size_t size, uint32_t width, uint32_t height) {
+    if (!texels || size / 4 / width < height) {
+        return nullptr;
+    }
+    size_t count = static_cast<size_t>(width) * height;
+    unsigned char* pixels = static_cast<unsigned char*>(std::malloc(count * 4));
+    if (!pixels) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < count; i++) {
+        pixels[i * 4 + 0] = texels[i * 4 + 2];
+        pixels[i * 4 + 1] = texels[i * 4 + 1];
+        pixels[i * 4 + 2] = texels[i * 4 + 0];
+        pixels[i * 4 + 3] = texels[i * 4 + 3];
+    }
+    return pixels;
+}
+
+// ǽɲ֪ͨȴļ
+void ModelLoader::finishDecode(TextureDecodeEntry& entry) {
+    std::vector<std::function<void()>> waiters;
+    {
+        QMutexLocker locker(&mutex);
+        entry.done = true;
+        waiters.swap(entry.waiters);
+    }
+    for (auto& waiter : waiters) {
+        waiter();
+    }
+}
+
+// ʧʱƳ decodingTextures֮ļعһԶϴĿ
+// δĿΪɲ֪ͨȴߣǻᰴʧܴ
+void ModelLoader::releaseClaimedTextures(AsyncLoadState& state) {
+    {
+        QMutexLocker locker(&mutex);
+        for (const auto& entry : state.claimedTextures) {
+            auto it = decodingTextures.find(entry->path);
+            if (it != decodingTextures.end() && it->second == entry) {
+                decodingTextures.erase(it);
+            }
         }
+    }
+    for (const auto& entry : state.claimedTextures) {
+        finishDecode(*entry);
+    }
+}
+
+// ӰԴĴΪһ֣ͬһͼڲͬĸʹòͬĲ
+uint64_t ModelLoader::samplerVariant(const ModelLoadOptions& options) const {
+    float maxAnisotropy = std::min(options.maxAnisotropy, asyncContext.maxSamplerAnisotropy);
+    maxAnisotropy = std::max(maxAnisotropy, 1.0f);  //  1 ʱǹر
+    uint32_t bits;
+    memcpy(&bits, &maxAnisotropy, sizeof(bits));
+    return bits;
+}
 
-        for (size_t i = 0; i < vertexBuffers.size(); i++) {
-            vkDestroyBuffer(device, vertexBuffers[i], nullptr);
-            vkFreeMemory(device, vertexBufferMemories[i], nullptr);
+// ϴѽֻϴ׶δִУдݴֽϴ򻺴ʱΪ 0
+VkDeviceSize ModelLoader::uploadTexture(TextureDecodeEntry& entry) {
+    {
+        QMutexLocker locker(&mutex);
+        if (loadedTextures.find(entry.path) != loadedTextures.end() || streamedTextures.find(entry.path) != streamedTextures.end()) {
+            return 0;  // ͬһĿѾϴ
         }
+    }
 
-        for (size_t i = 0; i < indexBuffers.size(); i++) {
-            vkDestroyBuffer(device, indexBuffers[i], nullptr);
-            vkFreeMemory(device, indexBufferMemories[i], nullptr);
+    if (entry.streamed && textureStreamer && (entry.image.pixels || entry.image.compressed.format != VK_FORMAT_UNDEFINED)) {
+        return uploadStreamedTexture(entry);
+    }
+
+    if (entry.cached) {
+        Texture texture;
+        texture.resource = entry.cached;
+        texture.type = entry.typeName;
+        texture.path = entry.path;
+        QMutexLocker locker(&mutex);
+        loadedTextures[entry.path] = texture;
+        decodingTextures.erase(entry.path);
+        return 0;
+    }
+
+    VkDeviceSize bytes = 0;
+    if (entry.image.compressed.format != VK_FORMAT_UNDEFINED) {
+        bytes = entry.image.compressed.data.size();
+    }
+    else if (entry.image.pixels) {
+        bytes = static_cast<VkDeviceSize>(entry.image.width) * entry.image.height * 4 + entry.image.mipChain.size();
+    }
+
+    //  Vulkan ύǼǵ
+    Texture texture;
+    CachedTexture created = createVulkanTexture(entry.image);
+    if (created.image != VK_NULL_HANDLE) {
+        texture.resource = resourceCache->wrapTexture(created);
+        if (entry.cacheable) {
+            pendingTextures.push_back({ entry.cacheKey, texture.resource });
         }
     }
+    texture.type = entry.typeName;
+    texture.path = entry.path;
+    entry.image.pixels.reset();  // ͷͼ
+    std::vector<unsigned char>().swap(entry.image.mipChain);
+    entry.image.compressed = CompressedImage();
+
+    // ʹûز
+    QMutexLocker locker(&mutex);
+    loadedTextures[entry.path] = texture;
+    decodingTextures.erase(entry.path);
+    return bytes;
+}
+
+// Ϊʽϴֻдβ㼶дݴֽ
+VkDeviceSize ModelLoader::uploadStreamedTexture(TextureDecodeEntry& entry) {
+    std::vector<ImageLevel> levels = makeImageLevels(entry.image);
+    VkSampler sampler;
+    createSampler(static_cast<uint32_t>(levels.size()), sampler);
+    uint32_t id = textureStreamer->addTexture(entry.path, imageFormat(entry.image), levels, sampler, *uploadBatcher);
+    entry.image.pixels.reset();
+    std::vector<unsigned char>().swap(entry.image.mipChain);
+    entry.image.compressed = CompressedImage();
 
-    // ¼־
-    void logError(const std::string& message) {
-        std::cerr << ": " << message << std::endl;
+    QMutexLocker locker(&mutex);
+    streamedTextures[entry.path] = id;
+    decodingTextures.erase(entry.path);
+    return textureStreamer->getTexture(id).residentBytes;
+}
+
+// ¶ȡʽ mip ʽĺִ̨
+bool ModelLoader::decodeStreamedTexture(const std::string& path, DecodedTextureLevels& result) {
+    auto image = std::make_shared<DecodedImage>();
+    if (!loadCompressedTexture(path, image->compressed)) {
+        MappedFile content;
+        int width = 0, height = 0;
+        unsigned char* pixels = nullptr;
+        if (content.open(path)) {
+            content.prefetch();
+            pixels = decodeImage(content.data(), content.size(), width, height);
+        }
+        if (!pixels) {
+            logError("¼ʧ: " + path);
+            return false;
+        }
+        image->width = width;
+        image->height = height;
+        image->pixels.reset(pixels);
+        generateMipChainRGBA8(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height), image->mipChain);
     }
-};
+    result.format = imageFormat(*image);
+    result.levels = makeImageLevels(*image);
+    result.owner = image;
+    return true;
+}
+
+VkFormat ModelLoader::imageFormat(const DecodedImage& image) {
+    return image.compressed.format != VK_FORMAT_UNDEFINED ? image.compressed.format : VK_FORMAT_R8G8B8A8_UNORM;
+}
+
+// еĸ mip 㼶RGBA8 û CPU ɵ mip ʱֻе 0 
+std::vector<ImageLevel> ModelLoader::makeImageLevels(const DecodedImage& image) {
+    std::vector<ImageLevel> levels;
+    if (image.compressed.format != VK_FORMAT_UNDEFINED) {
+        for (const auto& level : image.compressed.levels) {
+            levels.push_back({ level.width, level.height, image.compressed.data.data() + level.offset, level.size });
+        }
+        return levels;
+    }
+
+    uint32_t levelWidth = static_cast<uint32_t>(image.width);
+    uint32_t levelHeight = static_cast<uint32_t>(image.height);
+    levels.push_back({ levelWidth, levelHeight, image.pixels.get(), static_cast<VkDeviceSize>(levelWidth) * levelHeight * 4 });
+    const unsigned char* levelPixels = image.mipChain.data();
+    uint32_t mipLevels = image.mipChain.empty() ? 1 : mipLevelCount(levelWidth, levelHeight);
+    for (uint32_t level = 1; level < mipLevels; level++) {
+        levelWidth = std::max(1u, levelWidth / 2);
+        levelHeight = std::max(1u, levelHeight / 2);
+        VkDeviceSize levelSize = static_cast<VkDeviceSize>(levelWidth) * levelHeight * 4;
+        levels.push_back({ levelWidth, levelHeight, levelPixels, levelSize });
+        levelPixels += levelSize;
+    }
+    return levels;
+}
+
+// ҲȡԤѹ汾· KTX2/DDS ʱֱӶȡγͬ .ktx2  .dds
+// ֻ豸ֲ֧Թ˵ĸʽʱ falseɵ÷˵ stb_image 
+bool ModelLoader::loadCompressedTexture(const std::string& path, CompressedImage& image) {
+    std::vector<std::string> candidates;
+    if (isCompressedTextureFile(path)) {
+        candidates.push_back(path);
+    }
+    else {
+        size_t dot = path.find_last_of('.');
+        size_t slash = path.find_last_of("/\\");
+        std::string stem = (dot != std::string::npos && (slash == std::string::npos || dot > slash)) ? path.substr(0, dot) : path;
+        candidates.push_back(stem + ".ktx2");
+        candidates.push_back(stem + ".dds");
+    }
+
+    for (const auto& candidate : candidates) {
+        if (!std::ifstream(candidate, std::ios::binary)) {
+            continue;
+        }
+        std::string error;
+        if (!::loadCompressedTexture(candidate, image, error)) {
+            logError("ȡѹʧ: " + candidate + " (" + error + ")");
+            continue;
+        }
+        if (!isSampledFormatSupported(image.format)) {
+            logError("豸֧ѹʽ " + std::to_string(static_cast<uint32_t>(image.format)) + ": " + candidate);
+            continue;
+        }
+        return true;
+    }
+    image = CompressedImage();
+    return false;
+}
+
+// ʽƽǷֲ֧Թ
+bool ModelLoader::isSampledFormatSupported(VkFormat format) {
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (formatProperties.optimalTilingFeatures & required) == required;
+}
+
+//  Vulkan 
+CachedTexture ModelLoader::createVulkanTexture(const DecodedImage& image) {
+    if (image.compressed.format != VK_FORMAT_UNDEFINED) {
+        return createCompressedTexture(image.compressed);
+    }
+
+    CachedTexture texture;
+    if (!image.pixels) {
+        return texture;
+    }
+
+    int width = image.width;
+    int height = image.height;
+    texture.mipLevels = mipLevelCount(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+
+    //  Vulkan ͼ
+    createImage(width, height, texture.mipLevels, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.image, texture.memory);
+
+    // ϴݣдݴ滷λϴһύ
+    // ֻϴ 0 ʱ㼶 GPU  blit ɣ򸽴 CPU ɵ mip 
+    std::vector<ImageLevel> levels = makeImageLevels(image);
+    uploadBatcher->uploadImage(texture.image, levels, texture.mipLevels);
+
+    //  Vulkan ͼͼ
+    createImageView(texture.image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, texture.mipLevels, texture.imageView);
+
+    //  Vulkan 
+    createSampler(texture.mipLevels, texture.sampler);
+
+    return texture;
+}
+
+// ԤѹĿݴÿ mip 㼶һοʱ mip
+CachedTexture ModelLoader::createCompressedTexture(const CompressedImage& image) {
+    CachedTexture texture;
+    texture.mipLevels = static_cast<uint32_t>(image.levels.size());
+
+    createImage(image.width, image.height, texture.mipLevels, image.format, VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.image, texture.memory);
+
+    std::vector<ImageLevel> levels;
+    for (const auto& level : image.levels) {
+        levels.push_back({ level.width, level.height, image.data.data() + level.offset, level.size });
+    }
+    uploadBatcher->uploadImage(texture.image, levels, texture.mipLevels);
+
+    createImageView(texture.image, image.format, VK_IMAGE_ASPECT_COLOR_BIT, texture.mipLevels, texture.imageView);
+    createSampler(texture.mipLevels, texture.sampler);
+    return texture;
+}
+
+// 豸ػݾݴϴύǰã
+void ModelLoader::createDeviceLocalBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage,
+    VkBuffer& buffer, MemoryAllocation& bufferMemory) {
+    createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, bufferMemory);
+    uploadBatcher->uploadBuffer(buffer, 0, data, size);
+}
+
+//  Vulkan 
+void ModelLoader::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+    VkBuffer& buffer, MemoryAllocation& bufferMemory) {
+    allocator->createBuffer(size, usage, properties, buffer, bufferMemory);
+}
+
+//  Vulkan ͼ
+void ModelLoader::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
+    VkMemoryPropertyFlags properties, VkImage& image, MemoryAllocation& imageMemory) {
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent.width = width;
+    imageInfo.extent.height = height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = tiling;
+    imageInfo.usage = usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    allocator->createImage(imageInfo, properties, image, imageMemory);
+}
+
+//  Vulkan ͼͼ
+void ModelLoader::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask, uint32_t mipLevels, VkImageView& imageView) {
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = aspectMask;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = mipLevels;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    vkCreateImageView(device, &viewInfo, nullptr, &imageView);
+}
+
+//  Vulkan 
+void ModelLoader::createSampler(uint32_t mipLevels, VkSampler& sampler) {
+    VkSamplerCreateInfo samplerInfo = {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(mipLevels);
+
+    // ԹҪ豸 samplerAnisotropyȡѡ豸ƵĽСֵ
+    float maxAnisotropy = std::min(loadOptions.maxAnisotropy, asyncContext.maxSamplerAnisotropy);
+    if (maxAnisotropy > 1.0f) {
+        samplerInfo.anisotropyEnable = VK_TRUE;
+        samplerInfo.maxAnisotropy = maxAnisotropy;
+    }
+
+    vkCreateSampler(device, &samplerInfo, nullptr, &sampler);
+}
+
+//  Vulkan Դ
+void ModelLoader::cleanup() {
+    textureStreamer.reset();  // ȴеĲ㼶лʹϴ
+    streamedTextures.clear();
+    meshTextureOffsets.clear();
+    meshTextures.clear();
+    uploadBatcher.reset();
+    decodingTextures.clear();
+    // 񻺳ɾУûʱһ
+    loadedTextures.clear();
+    pendingTextures.clear();
+    pendingMeshes.clear();
+    meshResources.clear();
+    vertexBuffers.clear();
+    indexBuffers.clear();
+
+    // ;֡Щ滻ʱһӳ
+    retireBuffer(unifiedGeometry.vertexBuffer, unifiedGeometry.vertexMemory);
+    retireBuffer(unifiedGeometry.indexBuffer, unifiedGeometry.indexMemory);
+    retireBuffer(unifiedGeometry.indirectBuffer, unifiedGeometry.indirectMemory);
+    unifiedGeometry = UnifiedGeometry();
+    retireBuffer(instanceBuffer, instanceMemory);
+    instanceBuffer = VK_NULL_HANDLE;
+    meshRanges.clear();
+    sceneData = SceneData();
+    std::atomic_store(&drawData, std::shared_ptr<const ModelDrawData>());
+}
+
+// ¼־
+void ModelLoader::logError(const std::string& message) {
+    std::cerr << ": " << message << std::endl;
+}
 
+// ¼Ϣ־
+void ModelLoader::logInfo(const std::string& message) {
+    std::cout << "Ϣ: " << message << std::endl;
+}
@@ -6,6 +6,8 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <QMutex>
 #include <QMutexLocker>
 #include <iostream>
@@ -14,80 +16,447 @@
 #include <unordered_map>
 #include <fstream>
 #include <stb_image.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include "MemoryAllocator.h"
+#include "UploadBatcher.h"
+#include "MipmapGenerator.h"
+#include "TextureContainer.h"
+#include "ModelCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "SceneGraph.h"
+#include "LoadStats.h"
+#include "TextureStreamer.h"
+#include "ResourceCache.h"
+#include "MappedIOSystem.h"
 
 // 结构体声明
+// 逐实例数据，按实例序号排列，两种顶点格式的管线都在绑定 1 上以逐实例属性读取。
+// 网格的实例为 [firstInstance, firstInstance + instanceCount)，顶点着色器以位置 7~10 读取世界矩阵的四列：
+//   worldPosition = mat4(world0, world1, world2, world3) * vec4(position, 1.0)
+// 紧凑格式同时以位置 5/6 读取所属网格的反量化参数
+struct MeshInstance {
+    glm::mat4 world;   // 世界矩阵
+    glm::vec4 scale;   // 所属网格的包围盒尺寸
+    glm::vec4 offset;  // 所属网格的包围盒最小点
+
+    // 世界矩阵四列的属性描述，写入 attributeDescriptions[0..3]
+    static void getWorldAttributeDescriptions(VkVertexInputAttributeDescription* attributeDescriptions);
+};
+
 struct Vertex {
     glm::vec3 Position;  // 顶点位置
     glm::vec3 Normal;    // 顶点法线
     glm::vec2 TexCoords; // 纹理坐标
     glm::vec3 Tangent;   // 切线
     glm::vec3 Bitangent; // 副切线
+
+    // 顶点绑定描述：绑定 0 为逐顶点数据，绑定 1 为逐实例的 MeshInstance
+    static std::array<VkVertexInputBindingDescription, 2> getBindingDescriptions();
+
+    // 顶点属性描述，位置 7~10 为实例的世界矩阵
+    static std::array<VkVertexInputAttributeDescription, 9> getAttributeDescriptions();
+};
+
+// 紧凑顶点格式（20 字节）：位置相对网格包围盒量化为 UNORM16，法线和切线使用八面体编码，
+// 纹理坐标为半精度浮点，副切线只保存符号。顶点着色器中的解码：
+//   position  = Position.xyz * scale.xyz + offset.xyz（scale/offset 为绑定 1 上逐实例读取的所属网格反量化参数）
+//   normal    = octDecode(Normal)，tangent = octDecode(Tangent)，
+//               octDecode(e): n = vec3(e, 1 - |e.x| - |e.y|)；n.z < 0 时 n.xy = (1 - |n.yx|) * sign(n.xy)；再归一化
+//   bitangent = cross(normal, tangent) * (Position.w * 2 - 1)
+struct PackedVertex {
+    uint16_t Position[4];   // 量化位置，w 为副切线符号（0 为负，65535 为正）
+    int16_t Normal[2];      // 八面体编码法线
+    uint16_t TexCoords[2];  // 半精度纹理坐标
+    int16_t Tangent[2];     // 八面体编码切线
+
+    // 顶点绑定描述：绑定 0 为逐顶点数据，绑定 1 为逐实例的 MeshInstance
+    static std::array<VkVertexInputBindingDescription, 2> getBindingDescriptions();
+
+    // 顶点属性描述，位置 0~3 与 Vertex 含义相同，位置 5/6 为反量化参数，位置 7~10 为实例的世界矩阵
+    static std::array<VkVertexInputAttributeDescription, 10> getAttributeDescriptions();
+
+    // 量化一个顶点，invExtent 为包围盒尺寸的倒数（尺寸为 0 的轴取 0）
+    static PackedVertex pack(const Vertex& vertex, const glm::vec3& boundsMin, const glm::vec3& invExtent);
+
+    // 单位向量的八面体编码，零向量编码为 (0, 0)
+    static void encodeOctahedral(const glm::vec3& v, int16_t encoded[2]);
 };
 
 struct Texture {
-    VkImage image;                 // Vulkan图像对象
-    VkDeviceMemory imageMemory;    // 图像内存
-    VkImageView imageView;         // 图像视图
-    VkSampler sampler;             // 纹理采样器
+    TextureHandle resource;        // 共享的图像、视图和采样器，解码失败时为空
     std::string type;              // 纹理类型
     std::string path;              // 纹理路径
 };
 
+// 单个网格在顶点/索引缓冲区中的范围
+struct MeshRange {
+    uint32_t firstIndex;     // 首个索引
+    uint32_t indexCount;     // 索引数量
+    int32_t vertexOffset;    // 顶点偏移
+    uint32_t vertexCount;    // 顶点数量
+    uint32_t materialIndex;  // 材质索引
+    VkIndexType indexType;   // 索引类型
+    glm::vec3 boundsMin;     // 模型空间包围盒最小点
+    glm::vec3 boundsMax;     // 模型空间包围盒最大点
+    uint32_t lodCount;       // LOD 层数，至少为 1
+    MeshLod lods[MAX_MESH_LODS];  // 各级 LOD 在索引缓冲区中的范围，第 0 级与 firstIndex/indexCount 相同
+    uint32_t firstInstance;  // 在实例缓冲区中的首个实例
+    uint32_t instanceCount;  // 实例数量，即引用该网格的节点数
+};
+
+// 共享几何缓冲区：整个场景的网格打包在一个顶点缓冲区和一个索引缓冲区中
+struct UnifiedGeometry {
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;    // 共享顶点缓冲区
+    MemoryAllocation vertexMemory;             // 顶点缓冲区内存
+    VkDeviceSize vertexCapacity = 0;           // 顶点缓冲区容量（字节）
+    uint32_t vertexCount = 0;                  // 已写入的顶点数量
+    VkBuffer indexBuffer = VK_NULL_HANDLE;     // 共享索引缓冲区
+    MemoryAllocation indexMemory;              // 索引缓冲区内存
+    VkDeviceSize indexCapacity = 0;            // 索引缓冲区容量（字节）
+    uint32_t indexCount = 0;                   // 已写入的索引数量
+    VkBuffer indirectBuffer = VK_NULL_HANDLE;  // 间接绘制命令缓冲区
+    MemoryAllocation indirectMemory;           // 间接绘制命令内存
+    uint32_t drawCount = 0;                    // 间接绘制命令数量
+};
+
+// 模型加载选项
+struct ModelLoadOptions {
+    bool unifiedGeometry = false;  // 将所有网格打包进共享顶点/索引缓冲区，使用间接绘制（同一个 ModelLoader 不应混用两种模式）
+    float maxAnisotropy = 16.0f;   // 纹理采样器的各向异性过滤上限，不大于 1 时关闭；设备未开启 samplerAnisotropy 时不生效
+    bool useModelCache = true;     // 优先读取 <模型路径>.kskcache 烘焙缓存，没有或已过期时导入后重新生成
+    bool compactVertices = false;  // 使用 PackedVertex 紧凑顶点格式，顶点数少于 65536 的网格同时使用 16 位索引（同一个 ModelLoader 不应混用两种格式）
+    bool optimizeMeshes = true;    // 导入后重排三角形（顶点缓存命中率）和顶点（读取局部性），并输出优化前后的 ACMR
+    bool optimizeOverdraw = false; // 顶点缓存优化后再按簇排序三角形以减少过度绘制
+    float overdrawThreshold = 1.05f;  // 簇排序允许 ACMR 变差的倍数上限
+    uint32_t lodLevels = 0;        // 每个网格额外生成的简化 LOD 层数（最多 MAX_MESH_LODS - 1），0 表示不生成
+    float lodReduction = 0.5f;     // 每级 LOD 的目标三角形数相对上一级的比例
+    float lodTargetError = 0.01f;  // 简化允许的最大误差，相对网格包围盒对角线长度
+    bool logLoadStats = false;     // 加载完成后以单行 JSON 输出分阶段统计
+    bool streamTextures = false;   // 纹理只上传低分辨率尾部层级，之后按渲染器上报的屏幕空间大小流式加载更精细的层级
+    uint32_t streamingTailSize = 128;  // 始终常驻的尾部层级的长边上限
+    VkDeviceSize textureBudget = 0;    // 流式纹理的显存预算（字节），0 表示使用 AsyncLoadContext 提供的预算
+};
+
+// 单个网格转换后的 CPU 端数据
+struct MeshData {
+    std::vector<Vertex> vertices;              // 顶点数据
+    std::vector<uint32_t> indices;             // 索引数据
+    std::vector<PackedVertex> packedVertices;  // 紧凑格式顶点，compactVertices 时代替 vertices
+    std::vector<uint16_t> shortIndices;        // 16 位索引，紧凑格式且顶点数少于 65536 时代替 indices
+    glm::vec3 boundsMin = glm::vec3(0.0f);     // 包围盒最小点
+    glm::vec3 boundsMax = glm::vec3(0.0f);     // 包围盒最大点
+    uint32_t materialIndex = 0;                // 材质索引
+    MeshOptimizationStats optimizationStats;   // 网格优化前后的 ACMR
+    uint32_t lodCount = 0;                     // LOD 层数
+    MeshLod lods[MAX_MESH_LODS];               // 各级 LOD 在 indices 中的范围，简化层级追加在原始索引之后
+    std::vector<uint32_t> instanceNodes;       // 引用该网格的场景节点，每个节点一个实例
+};
+
+// 发布给渲染器的绘制数据快照，只包含句柄，资源生命周期由 ModelLoader 管理
+struct ModelDrawData {
+    std::vector<VkBuffer> vertexBuffers;             // 逐网格顶点缓冲区
+    std::vector<VkBuffer> indexBuffers;              // 逐网格索引缓冲区
+    std::vector<MeshRange> meshRanges;               // 网格范围
+    VkBuffer unifiedVertexBuffer = VK_NULL_HANDLE;   // 共享顶点缓冲区
+    VkBuffer unifiedIndexBuffer = VK_NULL_HANDLE;    // 共享索引缓冲区
+    VkBuffer indirectBuffer = VK_NULL_HANDLE;        // 间接绘制命令缓冲区
+    uint32_t drawCount = 0;                          // 间接绘制命令数量
+    bool packedVertices = false;                     // 顶点是否为 PackedVertex 格式
+    VkBuffer instanceBuffer = VK_NULL_HANDLE;        // 逐实例的 MeshInstance，绑定到绑定 1
+    bool hasLods = false;                            // 是否有网格带简化 LOD
+    std::shared_ptr<const SceneData> scene;          // 节点层级、逐实例世界矩阵和逐网格包围盒，用于剔除
+    TextureStreamer* textureStreamer = nullptr;      // 流式纹理，没有流式加载的纹理时为空
+    std::vector<uint32_t> meshTextureOffsets;        // 网格 i 使用的流式纹理为 meshTextures[offsets[i], offsets[i + 1])
+    std::vector<uint32_t> meshTextures;              // 流式纹理序号
+};
+
+// 异步加载依赖的外部服务，通常由 RenderManager 提供
+struct AsyncLoadContext {
+    std::function<void(std::function<void()>)> enqueueTask;   // 投递任务到工作线程池，为空时在调用线程执行
+    std::function<void(std::function<void()>)> deferDestroy;  // 等 GPU 不再使用后再执行的销毁操作，为空时立即销毁
+    std::mutex* queueMutex = nullptr;                         // 与渲染线程共享的队列提交锁
+    uint32_t graphicsQueueFamily = VK_QUEUE_FAMILY_IGNORED;   // 图形队列族索引
+    UploadQueue transferQueue;                                // 独立传输队列，为空时在图形队列上上传
+    float maxSamplerAnisotropy = 0.0f;                        // 设备开启 samplerAnisotropy 时为其上限，0 表示不可用
+    VkDeviceSize textureMemoryBudget = 0;                     // 流式纹理的默认显存预算，0 表示不限制
+    std::shared_ptr<ResourceCache> resourceCache;             // 多个加载器共享的资源缓存，为空时只在本加载器内去重
+    GpuProfiler* profiler = nullptr;                          // 上传批次的 GPU 耗时计入该分析器，可为空
+};
+
 // 类声明
 class ModelLoader {
 public:
     // 构造函数，初始化 Vulkan 设备、物理设备、图形队列和命令池
-    ModelLoader(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool);
+    // allocator 为空时自行创建一个设备内存子分配器
+    ModelLoader(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool,
+        DeviceMemoryAllocator* allocator = nullptr);
 
     // 析构函数，确保释放所有 Vulkan 资源
     ~ModelLoader();
 
-    // 加载模型文件
-    bool loadModel(const std::string& filePath);
+    // 设置异步加载使用的线程池、延迟销毁和队列锁
+    void setAsyncContext(const AsyncLoadContext& context);
+
+    // 加载模型文件，阻塞直到完成。有线程池时网格转换和纹理解码仍并行执行，
+    // 因此不能在线程池的工作线程中调用
+    bool loadModel(const std::string& filePath, const ModelLoadOptions& options = ModelLoadOptions());
+
+    // 同上，并返回分阶段统计
+    bool loadModel(const std::string& filePath, const ModelLoadOptions& options, ModelLoadStats& stats);
+
+    // 异步加载模型文件：导入、网格转换、纹理解码和上传都作为任务在线程池上执行，
+    // 完成后才把新资源发布给渲染器
+    std::shared_future<bool> loadModelAsync(const std::string& filePath, const ModelLoadOptions& options = ModelLoadOptions());
+
+    // 同上，stats 不为空时在结果就绪前写入分阶段统计
+    std::shared_future<bool> loadModelAsync(const std::string& filePath, const ModelLoadOptions& options,
+        std::shared_ptr<ModelLoadStats> stats);
+
+    // 等待所有异步加载完成
+    void waitForAsyncLoads();
+
+    // 获取已发布的绘制数据快照，可在渲染线程中调用
+    std::shared_ptr<const ModelDrawData> getDrawData() const;
 
 private:
+    // Assimp 后处理标志，同时作为烘焙缓存键的一部分
+    static constexpr unsigned int IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace |
+        aiProcess_OptimizeMeshes | aiProcess_JoinIdenticalVertices;
+
+    // 解码后的 RGBA8 像素
+    struct DecodedImage;
+
+    // 一个正在解码的纹理，多个并发加载引用同一路径时共享同一条目
+    struct TextureDecodeEntry;
+
+    // 一次异步加载在各任务间共享的状态
+    struct AsyncLoadState;
+
     VkDevice device;  // Vulkan 设备
     VkPhysicalDevice physicalDevice;  // Vulkan 物理设备
     VkQueue graphicsQueue;  // Vulkan 图形队列
     VkCommandPool commandPool;  // Vulkan 命令池
+    DeviceMemoryAllocator* allocator;  // 设备内存子分配器
+    std::unique_ptr<DeviceMemoryAllocator> ownedAllocator;  // 未传入分配器时自行持有
+    std::unique_ptr<UploadBatcher> uploadBatcher;  // 上传批处理器，首次上传时创建
+    std::vector<std::pair<VkBuffer, MemoryAllocation>> retiredBuffers;  // 被替换的旧缓冲区，当前批次提交且新的绘制数据发布后才退役
+    bool gpuMipmaps = false;  // RGBA8 纹理支持线性过滤的 blit 时在 GPU 上生成 mip，否则在解码线程上生成
     std::unordered_map<std::string, Texture> loadedTextures;  // 已加载纹理的哈希映射
+    std::unordered_map<std::string, std::shared_ptr<TextureDecodeEntry>> decodingTextures;  // 已认领但尚未上传的纹理
+    std::unique_ptr<TextureStreamer> textureStreamer;  // 流式纹理，首次流式上传时创建
+    std::unordered_map<std::string, uint32_t> streamedTextures;  // 已加载的流式纹理路径到序号的映射
+    std::vector<uint32_t> meshTextureOffsets;  // 每个网格在 meshTextures 中的起始位置，与 meshRanges 一一对应
+    std::vector<uint32_t> meshTextures;  // 各网格材质引用的流式纹理序号
+    std::shared_ptr<ResourceCache> resourceCache;  // 按内容去重的纹理和网格缓存，可与其他加载器共享
+    std::vector<std::pair<uint64_t, TextureHandle>> pendingTextures;  // 本批次新建、提交后登记到缓存的纹理
+    std::unordered_map<uint64_t, MeshHandle> pendingMeshes;  // 本批次新建、提交后登记到缓存的网格
     std::vector<VkBuffer> vertexBuffers;  // 顶点缓冲区
-    std::vector<VkDeviceMemory> vertexBufferMemories;  // 顶点缓冲区内存
     std::vector<VkBuffer> indexBuffers;  // 索引缓冲区
-    std::vector<VkDeviceMemory> indexBufferMemories;  // 索引缓冲区内存
+    std::vector<MeshHandle> meshResources;  // 逐网格模式下持有顶点和索引缓冲区的句柄，与 vertexBuffers 一一对应
+    std::vector<MeshRange> meshRanges;  // 网格范围
+    SceneData sceneData;  // 全部已加载模型的场景数据，绘制项与 meshRanges 一一对应
+    UnifiedGeometry unifiedGeometry;  // 共享几何缓冲区
+    VkBuffer instanceBuffer = VK_NULL_HANDLE;  // 实例缓冲区，按实例序号排列的 MeshInstance
+    MemoryAllocation instanceMemory;  // 实例缓冲区内存
+    std::vector<unsigned char> pendingVertices;  // 待上传到共享缓冲区的顶点（按当前顶点格式排列的字节）
+    std::vector<uint32_t> pendingIndices;  // 待上传到共享缓冲区的索引
+    ModelLoadOptions loadOptions;  // 当前加载选项
     QMutex mutex;  // 线程安全的互斥锁
+    QMutex uploadMutex;  // 串行化 GPU 上传阶段
+    AsyncLoadContext asyncContext;  // 异步加载服务
+    std::shared_ptr<const ModelDrawData> drawData;  // 已发布的绘制数据
+    std::mutex asyncMutex;  // 保护 pendingAsyncLoads
+    std::condition_variable asyncCondition;  // 异步加载完成通知
+    int pendingAsyncLoads = 0;  // 未完成的异步加载数量
+
+    // 读取烘焙缓存，缓存不存在、已过期或损坏时返回 false
+    bool loadCookedModel(AsyncLoadState& state);
+
+    // 首次导入成功后写入烘焙缓存，失败只记录错误
+    void writeCookedModel(const AsyncLoadState& state);
+
+    static std::vector<MeshDataView> makeMeshViews(const std::vector<MeshData>& meshData);
+
+    // 加载选项对应的顶点格式大小
+    static uint32_t vertexStride(const ModelLoadOptions& options);
+
+    // 影响网格数据的后处理选项，作为烘焙缓存键的一部分
+    static uint32_t processFlags(const ModelLoadOptions& options);
+
+    // 后处理使用的浮点参数的哈希，作为烘焙缓存键的一部分
+    static uint64_t processParameters(const ModelLoadOptions& options);
+
+    // 导入场景文件
+    const aiScene* importScene(Assimp::Importer& importer, const std::string& filePath, uint64_t& bytesRead,
+        std::vector<std::string>& openedFiles);
+
+    // 在线程池上执行任务，没有线程池时直接执行
+    void runTask(std::function<void()> task);
 
-    // 递归处理节点
-    void processNode(aiNode* node, const aiScene* scene);
+    // 异步阶段一：导入场景，然后为每个网格投递转换任务
+    void runAsyncImport(std::shared_ptr<AsyncLoadState> state);
 
-    // 处理网格
-    void processMesh(aiMesh* mesh, const aiScene* scene);
+    // 一个上传前置任务完成，最后一个完成的任务投递上传阶段
+    void completeAsyncTask(const std::shared_ptr<AsyncLoadState>& state);
 
-    // 加载材质的纹理
-    void loadMaterialTextures(aiMaterial* material, const aiScene* scene);
+    // 异步阶段二：上传纹理和几何数据并发布
+    void runAsyncUpload(std::shared_ptr<AsyncLoadState> state);
 
-    // 加载单个纹理
-    void loadTexture(aiMaterial* material, aiTextureType type, const std::string& typeName);
+    // 汇总整个模型的网格优化效果，ACMR 按三角形数量加权
+    void reportOptimizationStats(const AsyncLoadState& state);
+
+    void finishAsyncLoad(const std::shared_ptr<AsyncLoadState>& state, bool result);
+
+    // 汇总一次加载的分阶段统计
+    static ModelLoadStats collectLoadStats(const AsyncLoadState& state, bool result);
+
+    // 上传阶段：创建纹理和缓冲区，全部完成后发布新的绘制数据
+    void uploadModel(AsyncLoadState& state);
+
+    // 调用方持有 uploadMutex
+    void ensureUploadBatcher();
+
+    // 创建流式纹理，预算和尾部大小取首次流式加载的选项。调用方持有 uploadMutex
+    void ensureTextureStreamer();
+
+    // 记录网格材质引用的流式纹理，每个上传的网格调用一次
+    void appendMeshTextures(uint32_t materialIndex, const std::vector<TextureReference>& textureRefs);
+
+    // 用当前资源生成新的快照并原子替换
+    void publishDrawData();
+
+    // 把本次加载的节点层级和网格追加到场景，计算各实例的世界矩阵、各网格全部实例的世界空间包围盒并重建包围体层次
+    void appendScene(const std::vector<SceneNodeData>& nodes, const std::vector<MeshDataView>& meshes, size_t firstRange);
+
+    // 销毁可能仍被在途帧引用的缓冲区
+    void retireBuffer(VkBuffer& buffer, MemoryAllocation& bufferMemory);
+
+    // 递归处理节点，按深度优先顺序记录节点层级和局部变换，并收集每个节点引用的网格。
+    // 被多个节点引用的网格只收集一次，每个引用作为它的一个实例
+    void processNode(aiNode* node, const aiScene* scene, int32_t parent, AsyncLoadState& state);
+
+    // 处理网格，只做 CPU 端转换，可在工作线程并行执行
+    void processMesh(aiMesh* mesh, MeshData& meshData, const ModelLoadOptions& options);
+
+    // 网格优化阶段：顶点缓存重排、可选的过度绘制排序，最后按首次使用顺序重排顶点
+    static void optimizeMesh(MeshData& meshData, const ModelLoadOptions& options);
+
+    // 用边折叠逐级简化原始网格，简化后的索引追加在原始索引之后，与原始网格共享顶点
+    static void generateLods(MeshData& meshData, const ModelLoadOptions& options);
+
+    // 转换为紧凑顶点格式，顶点数少于 65536 时同时改用 16 位索引
+    static void packMesh(MeshData& meshData);
+
+    // 上传单个网格
+    void uploadMesh(const MeshDataView& mesh);
+
+    // 按当前全部实例重建实例缓冲区，序号与各网格的 firstInstance 一致
+    void updateInstanceBuffer();
+
+    // 收集材质的纹理
+    void collectMaterialTextures(aiMaterial* material, uint32_t materialIndex, const std::shared_ptr<AsyncLoadState>& state,
+        std::vector<std::shared_ptr<TextureDecodeEntry>>& claimed);
+
+    // 收集单个类型的纹理并记录引用
+    void collectTexture(aiMaterial* material, uint32_t materialIndex, aiTextureType type, const std::string& typeName,
+        const std::shared_ptr<AsyncLoadState>& state, std::vector<std::shared_ptr<TextureDecodeEntry>>& claimed);
+
+    // 认领或等待一个纹理：已加载的跳过，其他加载正在解码的等待其完成，其余由本次加载认领并解码
+    void claimTexture(const TextureReference& reference,
+        const std::shared_ptr<AsyncLoadState>& state, std::vector<std::shared_ptr<TextureDecodeEntry>>& claimed);
+
+    // 解码纹理像素，可在工作线程并行执行
+    void decodeTexture(TextureDecodeEntry& entry);
+
+    // 标记解码完成并通知等待它的加载
+    void finishDecode(TextureDecodeEntry& entry);
+
+    // 加载失败时放弃本次认领的纹理：移出 decodingTextures 并结束解码，等待它们的其他加载不会挂起
+    void releaseClaimedTextures(AsyncLoadState& state);
+
+    // 映射纹理文件并预读，记录读取的字节数
+    static bool openTextureFile(TextureDecodeEntry& entry, MappedFile& file);
+
+    // 从内存中的图像文件（PNG、JPEG 等）解码 RGBA8 像素，失败时返回空，结果由 stbi_image_free 释放
+    static unsigned char* decodeImage(const unsigned char* data, size_t size, int& width, int& height);
+
+    // 把未压缩内嵌纹理的 aiTexel（BGRA8）转换为 RGBA8，数据不足时返回空，结果由 std::free 释放
+    static unsigned char* convertTexels(const unsigned char* texels, size_t size, uint32_t width, uint32_t height);
+
+    // 影响纹理资源的创建参数，作为共享缓存键的一部分：同一图像在不同的各向异性设置下使用不同的采样器
+    uint64_t samplerVariant(const ModelLoadOptions& options) const;
+
+    // 上传已解码的纹理，只在上传阶段串行执行，返回写入暂存区的字节数（已由其他加载上传或缓存命中时为 0）
+    VkDeviceSize uploadTexture(TextureDecodeEntry& entry);
+
+    // 作为流式纹理上传，只写入尾部层级，返回写入暂存区的字节数
+    VkDeviceSize uploadStreamedTexture(TextureDecodeEntry& entry);
+
+    // 重新读取并解码流式纹理的完整 mip 链，在流式纹理的后台任务中执行
+    bool decodeStreamedTexture(const std::string& path, DecodedTextureLevels& result);
+
+    static VkFormat imageFormat(const DecodedImage& image);
+
+    // 解码结果中已有的各 mip 层级，RGBA8 纹理没有 CPU 生成的 mip 链时只有第 0 级
+    static std::vector<ImageLevel> makeImageLevels(const DecodedImage& image);
+
+    // 查找并读取纹理的预压缩版本（KTX2/DDS），只接受设备支持的格式，没有时返回 false
+    bool loadCompressedTexture(const std::string& path, CompressedImage& image);
+
+    // 格式在最优平铺下是否支持采样和线性过滤
+    bool isSampledFormatSupported(VkFormat format);
 
     // 创建 Vulkan 纹理
-    Texture createVulkanTexture(const char* path);
+    CachedTexture createVulkanTexture(const DecodedImage& image);
+
+    // 用预压缩的块数据创建纹理，每个 mip 层级一次拷贝
+    CachedTexture createCompressedTexture(const CompressedImage& image);
+
+    // 将待上传的顶点/索引追加到共享缓冲区，并重建间接绘制命令
+    void flushUnifiedGeometry();
 
-    // 创建顶点缓冲区
-    void createVertexBuffer(const std::vector<Vertex>& vertices);
+    // 向共享缓冲区末尾追加数据，容量不足时按两倍扩容并在 GPU 上拷贝旧内容
+    void appendToUnifiedBuffer(VkBuffer& buffer, MemoryAllocation& bufferMemory, VkDeviceSize& capacity,
+        VkDeviceSize usedBytes, const void* data, VkDeviceSize size, VkBufferUsageFlags usage);
 
-    // 创建索引缓冲区
-    void createIndexBuffer(const std::vector<uint32_t>& indices);
+    // 创建设备本地缓冲区，数据经批处理器暂存上传（提交前不可用）
+    void createDeviceLocalBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage,
+        VkBuffer& buffer, MemoryAllocation& bufferMemory);
+
+    // 创建 Vulkan 缓冲区
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+        VkBuffer& buffer, MemoryAllocation& bufferMemory);
+
+    // 创建 Vulkan 图像对象
+    void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
+        VkMemoryPropertyFlags properties, VkImage& image, MemoryAllocation& imageMemory);
+
+    // 创建 Vulkan 图像视图
+    void createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask, uint32_t mipLevels, VkImageView& imageView);
+
+    // 创建 Vulkan 纹理采样器
+    void createSampler(uint32_t mipLevels, VkSampler& sampler);
 
     // 清理 Vulkan 资源
     void cleanup();
 
     // 错误记录函数
     void logError(const std::string& message);
+
+    // 信息记录函数
+    void logInfo(const std::string& message);
 };
 
 // 函数声明
-void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, MemoryAllocation& bufferMemory);
+void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, MemoryAllocation& imageMemory);
 void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
 void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
 VkImageView createImageView(VkImage image, VkFormat format);
@@ -0,0 +1,137 @@
+#ifndef PIPELINECACHE_H
+#define PIPELINECACHE_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// 持久化的管线缓存：启动时从磁盘读取，所有管线创建共用，退出时写回。
+// 文件内容就是 vkGetPipelineCacheData 的输出，读取时先按 VkPipelineCacheHeaderVersionOne 校验
+// 厂商 ID、设备 ID 和驱动的 pipelineCacheUUID，不匹配（换了显卡或驱动）时丢弃，从空缓存开始
+class PersistentPipelineCache {
+public:
+    PersistentPipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& path)
+        : device(device), path(path) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+        std::vector<char> data;
+        if (readFile(data) && isCompatible(data, properties)) {
+            warm = true;
+        }
+        else {
+            data.clear();
+        }
+
+        VkPipelineCacheCreateInfo cacheInfo = {};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize = data.size();
+        cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+        if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &cache) != VK_SUCCESS) {
+            // 驱动拒绝了校验通过的数据时退回空缓存
+            warm = false;
+            cacheInfo.initialDataSize = 0;
+            cacheInfo.pInitialData = nullptr;
+            if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &cache) != VK_SUCCESS) {
+                throw std::runtime_error("创建管线缓存失败！");
+            }
+        }
+    }
+
+    ~PersistentPipelineCache() {
+        vkDestroyPipelineCache(device, cache, nullptr);
+    }
+
+    PersistentPipelineCache(const PersistentPipelineCache&) = delete;
+    PersistentPipelineCache& operator=(const PersistentPipelineCache&) = delete;
+
+    VkPipelineCache get() const {
+        return cache;
+    }
+
+    // 是否从磁盘读取到了有效的缓存
+    bool isWarm() const {
+        return warm;
+    }
+
+    // 写回磁盘：先写临时文件再替换，进程中途退出不会留下不完整的缓存
+    bool save(std::string& error) const {
+        size_t size = 0;
+        if (vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS) {
+            error = "读取管线缓存数据失败";
+            return false;
+        }
+        std::vector<char> data(size);
+        if (size > 0 && vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS) {
+            error = "读取管线缓存数据失败";
+            return false;
+        }
+        data.resize(size);
+
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                error = "无法创建管线缓存文件";
+                return false;
+            }
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file) {
+                error = "写入管线缓存文件失败";
+                file.close();
+                std::filesystem::remove(tempPath);
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            std::filesystem::remove(tempPath, ec);
+            error = "替换管线缓存文件失败";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    VkDevice device;
+    std::string path;
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    bool warm = false;
+
+    bool readFile(std::vector<char>& data) const {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !data.empty();
+    }
+
+    // 校验缓存头：头部大小、版本，以及与当前设备一致的厂商 ID、设备 ID 和 UUID
+    static bool isCompatible(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties) {
+        // VkPipelineCacheHeaderVersionOne 的布局：uint32 headerSize, uint32 headerVersion, uint32 vendorID,
+        // uint32 deviceID, uint8 pipelineCacheUUID[VK_UUID_SIZE]
+        const size_t headerSize = 16 + VK_UUID_SIZE;
+        if (data.size() < headerSize) {
+            return false;
+        }
+        uint32_t fields[4];
+        memcpy(fields, data.data(), sizeof(fields));
+        return fields[0] >= headerSize && fields[0] <= data.size()
+            && fields[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+            && fields[2] == properties.vendorID
+            && fields[3] == properties.deviceID
+            && memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+};
+
+#endif // PIPELINECACHE_H
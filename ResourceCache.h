@@ -0,0 +1,301 @@
+#ifndef RESOURCECACHE_H
+#define RESOURCECACHE_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include "MemoryAllocator.h"
+
+// 64 位内容哈希，每次处理 8 字节，用于资源去重而不是安全校验
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0) {
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed ^ (static_cast<uint64_t>(size) * multiplier);
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, bytes, 8);
+        word *= multiplier;
+        word ^= word >> 32;
+        hash = (hash ^ word) * multiplier;
+        bytes += 8;
+        size -= 8;
+    }
+    if (size > 0) {
+        uint64_t word = 0;
+        memcpy(&word, bytes, size);
+        word *= multiplier;
+        word ^= word >> 32;
+        hash = (hash ^ word) * multiplier;
+    }
+    // splitmix64 的终结混合
+    hash ^= hash >> 30;
+    hash *= 0xBF58476D1CE4E5B9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+// 共享的纹理资源
+struct CachedTexture {
+    VkImage image = VK_NULL_HANDLE;           // Vulkan 图像对象
+    MemoryAllocation memory;                  // 图像内存（子分配）
+    VkImageView imageView = VK_NULL_HANDLE;   // 图像视图
+    VkSampler sampler = VK_NULL_HANDLE;       // 纹理采样器
+    uint32_t mipLevels = 1;                   // mip 层级数
+};
+
+// 共享的网格资源：逐网格模式下的顶点和索引缓冲区
+struct CachedMesh {
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    MemoryAllocation vertexMemory;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    MemoryAllocation indexMemory;
+};
+
+// 资源的引用计数句柄，最后一个引用释放时销毁 GPU 资源
+using TextureHandle = std::shared_ptr<const CachedTexture>;
+using MeshHandle = std::shared_ptr<const CachedMesh>;
+
+// 一类资源的查找统计
+struct ResourceCacheCounters {
+    uint64_t pathHits = 0;     // 按规范化路径命中，不需要读取文件
+    uint64_t contentHits = 0;  // 按内容哈希命中
+    uint64_t misses = 0;       // 未命中，需要创建新资源
+    uint32_t live = 0;         // 仍被引用的已登记资源数量
+};
+
+struct ResourceCacheStats {
+    ResourceCacheCounters textures;
+    ResourceCacheCounters meshes;
+};
+
+// 多个 ModelLoader 共享的 GPU 资源缓存，按内容哈希去重纹理和网格。
+// 纹理先按规范化路径、文件大小和修改时间预检查，命中时不需要读取文件；否则按文件内容哈希查找，
+// 不同相对路径或不同加载器引用的同一文件只解码和上传一次。
+// 缓存只持有弱引用，资源由加载器持有的句柄计数，最后一个使用它的加载器释放时销毁。
+// 新资源在上传完成后才登记（publish），避免其他加载器在数据可用前命中
+class ResourceCache {
+public:
+    using DeferDestroy = std::function<void(std::function<void()>)>;
+
+    // deferDestroy 不为空时，最后一个句柄释放后的销毁通过它延迟到在途帧执行完，否则立即销毁
+    ResourceCache(VkDevice device, DeviceMemoryAllocator* allocator, DeferDestroy deferDestroy = nullptr)
+        : device(device), allocator(allocator), deferDestroy(std::move(deferDestroy)) {
+    }
+
+    ResourceCache(const ResourceCache&) = delete;
+    ResourceCache& operator=(const ResourceCache&) = delete;
+
+    // 按路径预检查纹理，variant 区分同一内容的不同创建参数（如采样器设置）。未命中时不计入统计，
+    // 调用方应读取文件后再调用 findTextureByContent
+    TextureHandle findTextureByPath(const std::string& path, uint64_t variant) {
+        std::string canonical;
+        uint64_t size;
+        int64_t time;
+        if (!fileIdentity(path, canonical, size, time)) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = contentHashes.find(canonical);
+        if (it == contentHashes.end() || it->second.size != size || it->second.time != time) {
+            return nullptr;
+        }
+        TextureHandle texture = lockEntry(textures, textureKey(it->second.hash, variant));
+        if (texture) {
+            stats.textures.pathHits++;
+        }
+        return texture;
+    }
+
+    // 按文件内容查找纹理，并记录路径到内容哈希的映射供之后预检查。path 为空（内嵌纹理）时只按内容查找。
+    // 未命中时 key 为之后 publishTexture 使用的键
+    TextureHandle findTextureByContent(const std::string& path, const void* data, size_t size, uint64_t variant, uint64_t& key) {
+        uint64_t hash = hashBytes(data, size);
+        key = textureKey(hash, variant);
+
+        std::string canonical;
+        uint64_t fileSize;
+        int64_t time;
+        bool identified = !path.empty() && fileIdentity(path, canonical, fileSize, time);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (identified) {
+            contentHashes[canonical] = { fileSize, time, hash };
+        }
+        TextureHandle texture = lockEntry(textures, key);
+        if (texture) {
+            stats.textures.contentHits++;
+        }
+        else {
+            stats.textures.misses++;
+        }
+        return texture;
+    }
+
+    // 按顶点和索引数据的内容哈希查找网格（键由 meshKey 计算）
+    MeshHandle findMesh(uint64_t key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        MeshHandle mesh = lockEntry(meshes, key);
+        if (mesh) {
+            stats.meshes.contentHits++;
+        }
+        else {
+            stats.meshes.misses++;
+        }
+        return mesh;
+    }
+
+    // 调用方在自己尚未登记的资源中命中时计入统计
+    void countMeshHit() {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.meshes.contentHits++;
+    }
+
+    // 包装新创建的纹理，返回的句柄归调用方所有
+    TextureHandle wrapTexture(const CachedTexture& texture) {
+        VkDevice device = this->device;
+        DeviceMemoryAllocator* allocator = this->allocator;
+        DeferDestroy deferDestroy = this->deferDestroy;
+        return TextureHandle(new CachedTexture(texture), [device, allocator, deferDestroy](const CachedTexture* resource) {
+            CachedTexture released = *resource;
+            delete resource;
+            destroy(deferDestroy, [device, allocator, released]() mutable {
+                vkDestroySampler(device, released.sampler, nullptr);
+                vkDestroyImageView(device, released.imageView, nullptr);
+                allocator->destroyImage(released.image, released.memory);
+            });
+        });
+    }
+
+    MeshHandle wrapMesh(const CachedMesh& mesh) {
+        DeviceMemoryAllocator* allocator = this->allocator;
+        DeferDestroy deferDestroy = this->deferDestroy;
+        return MeshHandle(new CachedMesh(mesh), [allocator, deferDestroy](const CachedMesh* resource) {
+            CachedMesh released = *resource;
+            delete resource;
+            destroy(deferDestroy, [allocator, released]() mutable {
+                allocator->destroyBuffer(released.vertexBuffer, released.vertexMemory);
+                allocator->destroyBuffer(released.indexBuffer, released.indexMemory);
+            });
+        });
+    }
+
+    // 上传完成后登记资源，之后的查找才能命中。同一个键已有存活资源时保留原有的
+    void publishTexture(uint64_t key, const TextureHandle& texture) {
+        std::lock_guard<std::mutex> lock(mutex);
+        publish(textures, key, texture);
+    }
+
+    void publishMesh(uint64_t key, const MeshHandle& mesh) {
+        std::lock_guard<std::mutex> lock(mutex);
+        publish(meshes, key, mesh);
+    }
+
+    ResourceCacheStats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        ResourceCacheStats result = stats;
+        result.textures.live = countLive(textures);
+        result.meshes.live = countLive(meshes);
+        return result;
+    }
+
+    // 网格缓冲区内容的键，顶点步长和索引大小不同的相同字节不会相互命中
+    static uint64_t meshKey(const void* vertices, size_t vertexBytes, uint32_t vertexStride,
+        const void* indices, size_t indexBytes, uint32_t indexSize) {
+        uint64_t layout = (static_cast<uint64_t>(vertexStride) << 32) | indexSize;
+        return hashBytes(indices, indexBytes, hashBytes(vertices, vertexBytes, layout));
+    }
+
+private:
+    // 路径上次被哈希时的文件信息
+    struct ContentHash {
+        uint64_t size;
+        int64_t time;
+        uint64_t hash;
+    };
+
+    VkDevice device;
+    DeviceMemoryAllocator* allocator;
+    DeferDestroy deferDestroy;  // 见构造函数
+    mutable std::mutex mutex;  // 保护以下全部状态
+    std::unordered_map<std::string, ContentHash> contentHashes;  // 规范化路径到内容哈希
+    std::unordered_map<uint64_t, std::weak_ptr<const CachedTexture>> textures;
+    std::unordered_map<uint64_t, std::weak_ptr<const CachedMesh>> meshes;
+    ResourceCacheStats stats;
+
+    // 句柄可能在任意线程释放，渲染器仍可能在录制或执行引用该资源的帧
+    static void destroy(const DeferDestroy& deferDestroy, std::function<void()> destroyResource) {
+        if (deferDestroy) {
+            deferDestroy(std::move(destroyResource));
+        }
+        else {
+            destroyResource();
+        }
+    }
+
+    static uint64_t textureKey(uint64_t contentHash, uint64_t variant) {
+        return hashBytes(&variant, sizeof(variant), contentHash);
+    }
+
+    // 规范化路径（解析相对路径、"." 和 ".."、符号链接）以及文件大小和修改时间
+    static bool fileIdentity(const std::string& path, std::string& canonical, uint64_t& size, int64_t& time) {
+        std::error_code ec;
+        std::filesystem::path resolved = std::filesystem::weakly_canonical(std::filesystem::path(path), ec);
+        if (ec) {
+            return false;
+        }
+        size = std::filesystem::file_size(resolved, ec);
+        if (ec) {
+            return false;
+        }
+        auto writeTime = std::filesystem::last_write_time(resolved, ec);
+        if (ec) {
+            return false;
+        }
+        time = static_cast<int64_t>(writeTime.time_since_epoch().count());
+        canonical = resolved.generic_string();
+        return true;
+    }
+
+    // 取得存活的资源，已释放的条目顺便移除
+    template <typename T>
+    static std::shared_ptr<const T> lockEntry(std::unordered_map<uint64_t, std::weak_ptr<const T>>& entries, uint64_t key) {
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            return nullptr;
+        }
+        std::shared_ptr<const T> resource = it->second.lock();
+        if (!resource) {
+            entries.erase(it);
+        }
+        return resource;
+    }
+
+    template <typename T>
+    static void publish(std::unordered_map<uint64_t, std::weak_ptr<const T>>& entries, uint64_t key,
+        const std::shared_ptr<const T>& resource) {
+        std::weak_ptr<const T>& entry = entries[key];
+        if (entry.expired()) {
+            entry = resource;
+        }
+    }
+
+    template <typename T>
+    static uint32_t countLive(const std::unordered_map<uint64_t, std::weak_ptr<const T>>& entries) {
+        uint32_t live = 0;
+        for (const auto& entry : entries) {
+            live += entry.second.expired() ? 0 : 1;
+        }
+        return live;
+    }
+};
+
+#endif // RESOURCECACHE_H
@@ -0,0 +1,218 @@
+#ifndef SCENEGRAPH_H
+#define SCENEGRAPH_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// 扁平化的场景表示：节点层级、每个实例的世界矩阵和世界空间包围盒（SoA），以及用于视锥剔除的包围体层次
+
+// 变换后的轴对齐包围盒（Arvo 方法，按矩阵各列的正负分量累加）
+inline void transformBounds(const glm::mat4& matrix, const glm::vec3& localMin, const glm::vec3& localMax,
+    glm::vec3& worldMin, glm::vec3& worldMax) {
+    glm::vec3 translation(matrix[3]);
+    worldMin = translation;
+    worldMax = translation;
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            float a = matrix[column][row] * localMin[column];
+            float b = matrix[column][row] * localMax[column];
+            worldMin[row] += std::min(a, b);
+            worldMax[row] += std::max(a, b);
+        }
+    }
+}
+
+// 矩阵三个轴向的最大缩放，用于把模型空间误差换算到世界空间
+inline float maxScale(const glm::mat4& matrix) {
+    return std::sqrt(std::max({ glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])),
+        glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1])),
+        glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2])) }));
+}
+
+// 视锥体：从视图投影矩阵提取的六个平面，法线朝内（Vulkan 深度范围 [0, 1]）
+struct Frustum {
+    glm::vec4 planes[6];
+
+    // 包围盒与视锥的关系
+    enum class Result { Outside, Intersecting, Inside };
+
+    static Frustum fromMatrix(const glm::mat4& viewProjection) {
+        glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+        Frustum frustum;
+        frustum.planes[0] = row3 + row0;  // 左
+        frustum.planes[1] = row3 - row0;  // 右
+        frustum.planes[2] = row3 + row1;  // 下
+        frustum.planes[3] = row3 - row1;  // 上
+        frustum.planes[4] = row2;         // 近
+        frustum.planes[5] = row3 - row2;  // 远
+        for (glm::vec4& plane : frustum.planes) {
+            float length = glm::length(glm::vec3(plane));
+            if (length > 0.0f) {
+                plane /= length;
+            }
+        }
+        return frustum;
+    }
+
+    Result test(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+        Result result = Result::Inside;
+        for (const glm::vec4& plane : planes) {
+            // 沿法线方向最远和最近的顶点
+            glm::vec3 positive(plane.x >= 0.0f ? boundsMax.x : boundsMin.x,
+                plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+                plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+            glm::vec3 negative(plane.x >= 0.0f ? boundsMin.x : boundsMax.x,
+                plane.y >= 0.0f ? boundsMin.y : boundsMax.y,
+                plane.z >= 0.0f ? boundsMin.z : boundsMax.z);
+            if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) {
+                return Result::Outside;
+            }
+            if (glm::dot(glm::vec3(plane), negative) + plane.w < 0.0f) {
+                result = Result::Intersecting;
+            }
+        }
+        return result;
+    }
+};
+
+// 包围体层次：按质心沿最长轴中位数二分，节点按深度优先排列，左子节点紧随父节点。
+// 每个节点覆盖 items 中一段连续区间，整个节点在视锥内时无需继续测试即可输出整段
+class BoundingVolumeHierarchy {
+public:
+    static constexpr uint32_t MAX_LEAF_SIZE = 4;
+
+    struct Node {
+        glm::vec3 boundsMin;
+        uint32_t first;  // 在 items 中的起始位置
+        glm::vec3 boundsMax;
+        uint32_t count;  // 子树中的实例数量
+        uint32_t right;  // 右子节点序号，叶节点为 0
+    };
+
+    // 用每个实例的世界空间包围盒构建
+    void build(const std::vector<glm::vec3>& boundsMin, const std::vector<glm::vec3>& boundsMax) {
+        nodes.clear();
+        items.resize(boundsMin.size());
+        for (size_t i = 0; i < items.size(); i++) {
+            items[i] = static_cast<uint32_t>(i);
+        }
+        if (items.empty()) {
+            return;
+        }
+        nodes.reserve(items.size());
+        buildNode(boundsMin, boundsMax, 0, static_cast<uint32_t>(items.size()));
+    }
+
+    // 视锥剔除，对每个可见的实例调用 visit(序号)
+    template <typename Visitor>
+    void cull(const Frustum& frustum, const std::vector<glm::vec3>& boundsMin, const std::vector<glm::vec3>& boundsMax,
+        Visitor&& visit) const {
+        if (nodes.empty()) {
+            return;
+        }
+        uint32_t stack[64];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const Node& node = nodes[stack[--stackSize]];
+            Frustum::Result result = frustum.test(node.boundsMin, node.boundsMax);
+            if (result == Frustum::Result::Outside) {
+                continue;
+            }
+            if (result == Frustum::Result::Inside) {
+                for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                    visit(items[i]);
+                }
+                continue;
+            }
+            if (node.right == 0) {
+                for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                    uint32_t item = items[i];
+                    if (frustum.test(boundsMin[item], boundsMax[item]) != Frustum::Result::Outside) {
+                        visit(item);
+                    }
+                }
+                continue;
+            }
+            uint32_t index = static_cast<uint32_t>(&node - nodes.data());
+            stack[stackSize++] = node.right;
+            stack[stackSize++] = index + 1;
+        }
+    }
+
+    const std::vector<Node>& getNodes() const {
+        return nodes;
+    }
+
+private:
+    std::vector<Node> nodes;
+    std::vector<uint32_t> items;  // 按叶节点顺序排列的实例序号
+
+    uint32_t buildNode(const std::vector<glm::vec3>& boundsMin, const std::vector<glm::vec3>& boundsMax,
+        uint32_t first, uint32_t count) {
+        uint32_t index = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node());
+
+        glm::vec3 nodeMin = boundsMin[items[first]];
+        glm::vec3 nodeMax = boundsMax[items[first]];
+        glm::vec3 centroidMin = (nodeMin + nodeMax) * 0.5f;
+        glm::vec3 centroidMax = centroidMin;
+        for (uint32_t i = first; i < first + count; i++) {
+            uint32_t item = items[i];
+            nodeMin = glm::min(nodeMin, boundsMin[item]);
+            nodeMax = glm::max(nodeMax, boundsMax[item]);
+            glm::vec3 centroid = (boundsMin[item] + boundsMax[item]) * 0.5f;
+            centroidMin = glm::min(centroidMin, centroid);
+            centroidMax = glm::max(centroidMax, centroid);
+        }
+
+        uint32_t right = 0;
+        glm::vec3 extent = centroidMax - centroidMin;
+        // 树深度约为 log2(count / MAX_LEAF_SIZE)，中位数划分保证遍历栈不会溢出
+        if (count > MAX_LEAF_SIZE) {
+            int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+            uint32_t half = count / 2;
+            std::nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+                [&](uint32_t a, uint32_t b) {
+                    return boundsMin[a][axis] + boundsMax[a][axis] < boundsMin[b][axis] + boundsMax[b][axis];
+                });
+            buildNode(boundsMin, boundsMax, first, half);
+            right = buildNode(boundsMin, boundsMax, first + half, count - half);
+        }
+
+        Node& node = nodes[index];
+        node.boundsMin = nodeMin;
+        node.boundsMax = nodeMax;
+        node.first = first;
+        node.count = count;
+        node.right = right;
+        return index;
+    }
+};
+
+// 扁平化的场景数据。节点按深度优先顺序排列，父节点总在子节点之前；
+// 绘制项与 ModelDrawData::meshRanges 一一对应，每个绘制项以实例化绘制引用它的全部节点，
+// 其实例在实例序号中连续排列。视锥剔除以实例为单位；LOD 选择以绘制项为单位，使用全部实例包围盒的并集
+struct SceneData {
+    std::vector<int32_t> nodeParents;             // 父节点序号，根节点为 -1
+    std::vector<glm::mat4> nodeLocalMatrices;     // 相对父节点的变换
+    std::vector<glm::mat4> nodeWorldMatrices;     // 世界变换
+    std::vector<uint32_t> instanceNodes;          // 每个实例所属的节点，按实例序号排列
+    std::vector<uint32_t> instanceMeshes;         // 每个实例所属的绘制项
+    std::vector<glm::mat4> instanceMatrices;      // 每个实例的世界矩阵
+    std::vector<glm::vec3> instanceBoundsMin;     // 每个实例的世界空间包围盒最小点
+    std::vector<glm::vec3> instanceBoundsMax;     // 每个实例的世界空间包围盒最大点
+    std::vector<float> worldScales;               // 每个绘制项各实例世界矩阵的最大缩放
+    std::vector<glm::vec3> worldBoundsMin;        // 每个绘制项全部实例包围盒并集的最小点
+    std::vector<glm::vec3> worldBoundsMax;        // 每个绘制项全部实例包围盒并集的最大点
+    BoundingVolumeHierarchy bvh;                  // 实例包围盒的层次结构
+};
+
+#endif // SCENEGRAPH_H
@@ -0,0 +1,284 @@
+#ifndef TEXTURECONTAINER_H
+#define TEXTURECONTAINER_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "MipmapGenerator.h"
+
+// 预压缩纹理容器（KTX2 / DDS）的解析。只接受 2D、单层、无超压缩的 BC1/BC3/BC5/BC7/ETC2 数据，
+// 各 mip 层级的块数据原样保留，直接拷贝到 GPU
+
+// 压缩图像中的一个 mip 层级
+struct CompressedLevel {
+    uint32_t width;     // 层级宽度（像素）
+    uint32_t height;    // 层级高度（像素）
+    size_t offset;      // 在 data 中的偏移
+    size_t size;        // 块数据大小（字节）
+};
+
+// 解析后的压缩图像
+struct CompressedImage {
+    VkFormat format = VK_FORMAT_UNDEFINED;  // Vulkan 压缩格式
+    uint32_t width = 0;                     // 第 0 级宽度
+    uint32_t height = 0;                    // 第 0 级高度
+    std::vector<CompressedLevel> levels;    // 从第 0 级开始的各级
+    MappedFile data;                        // 映射的文件内容，levels 指向其中的块数据，上传时直接从映射内存拷贝
+};
+
+// 压缩格式的块大小（字节，每块 4x4 像素），不支持的格式返回 0
+inline uint32_t compressedBlockSize(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+        return 8;
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC5_SNORM_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+// 一个 mip 层级的块数据大小
+inline size_t compressedLevelSize(VkFormat format, uint32_t width, uint32_t height) {
+    size_t blocksX = (std::max(1u, width) + 3) / 4;
+    size_t blocksY = (std::max(1u, height) + 3) / 4;
+    return blocksX * blocksY * compressedBlockSize(format);
+}
+
+namespace texture_container_detail {
+
+inline uint32_t readU32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t readU64(const unsigned char* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline bool hasExtension(const std::string& path, const char* extension) {
+    size_t length = strlen(extension);
+    if (path.size() < length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        char c = path[path.size() - length + i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != extension[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 解析 KTX2：头部 80 字节 + 层级索引，层级索引从第 0 级（最大）开始排列
+inline bool parseKtx2(CompressedImage& image, std::string& error) {
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const MappedFile& data = image.data;
+    if (data.size() < 80 || memcmp(data.data(), identifier, sizeof(identifier)) != 0) {
+        error = "不是有效的 KTX2 文件";
+        return false;
+    }
+
+    const unsigned char* header = data.data() + 12;
+    VkFormat format = static_cast<VkFormat>(readU32(header + 0));
+    uint32_t width = readU32(header + 8);
+    uint32_t height = readU32(header + 12);
+    uint32_t depth = readU32(header + 16);
+    uint32_t layerCount = readU32(header + 20);
+    uint32_t faceCount = readU32(header + 24);
+    uint32_t levelCount = std::max(1u, readU32(header + 28));
+    uint32_t supercompression = readU32(header + 32);
+
+    if (compressedBlockSize(format) == 0) {
+        error = "不支持的 KTX2 格式: " + std::to_string(static_cast<uint32_t>(format));
+        return false;
+    }
+    if (depth > 1 || layerCount > 1 || faceCount != 1 || width == 0 || height == 0) {
+        error = "只支持 2D 单层 KTX2 纹理";
+        return false;
+    }
+    if (levelCount > mipLevelCount(width, height)) {
+        error = "KTX2 层级数超过完整 mip 链";
+        return false;
+    }
+    if (supercompression != 0) {
+        error = "不支持超压缩的 KTX2 纹理";
+        return false;
+    }
+
+    size_t levelIndexOffset = 80;
+    if (data.size() < levelIndexOffset + static_cast<size_t>(levelCount) * 24) {
+        error = "KTX2 层级索引不完整";
+        return false;
+    }
+
+    image.format = format;
+    image.width = width;
+    image.height = height;
+    image.levels.clear();
+    for (uint32_t level = 0; level < levelCount; level++) {
+        const unsigned char* entry = data.data() + levelIndexOffset + level * 24;
+        uint64_t offset = readU64(entry);
+        uint64_t length = readU64(entry + 8);
+        uint32_t levelWidth = std::max(1u, width >> level);
+        uint32_t levelHeight = std::max(1u, height >> level);
+        if (length < compressedLevelSize(format, levelWidth, levelHeight) || offset > data.size() || length > data.size() - offset) {
+            error = "KTX2 层级数据越界";
+            return false;
+        }
+        image.levels.push_back({ levelWidth, levelHeight, static_cast<size_t>(offset),
+            compressedLevelSize(format, levelWidth, levelHeight) });
+    }
+    return true;
+}
+
+// DXGI_FORMAT 到 Vulkan 格式
+inline VkFormat dxgiToVkFormat(uint32_t dxgiFormat) {
+    switch (dxgiFormat) {
+    case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;   // DXGI_FORMAT_BC1_UNORM
+    case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;    // DXGI_FORMAT_BC1_UNORM_SRGB
+    case 77: return VK_FORMAT_BC3_UNORM_BLOCK;        // DXGI_FORMAT_BC3_UNORM
+    case 78: return VK_FORMAT_BC3_SRGB_BLOCK;         // DXGI_FORMAT_BC3_UNORM_SRGB
+    case 83: return VK_FORMAT_BC5_UNORM_BLOCK;        // DXGI_FORMAT_BC5_UNORM
+    case 84: return VK_FORMAT_BC5_SNORM_BLOCK;        // DXGI_FORMAT_BC5_SNORM
+    case 98: return VK_FORMAT_BC7_UNORM_BLOCK;        // DXGI_FORMAT_BC7_UNORM
+    case 99: return VK_FORMAT_BC7_SRGB_BLOCK;         // DXGI_FORMAT_BC7_UNORM_SRGB
+    default: return VK_FORMAT_UNDEFINED;
+    }
+}
+
+inline uint32_t fourCC(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+// 解析 DDS：魔数 + 124 字节头部，FourCC 为 DX10 时再跟 20 字节扩展头，之后各级块数据依次排列
+inline bool parseDds(CompressedImage& image, std::string& error) {
+    const MappedFile& data = image.data;
+    if (data.size() < 128 || readU32(data.data()) != fourCC('D', 'D', 'S', ' ')) {
+        error = "不是有效的 DDS 文件";
+        return false;
+    }
+
+    const unsigned char* header = data.data() + 4;
+    uint32_t height = readU32(header + 8);
+    uint32_t width = readU32(header + 12);
+    uint32_t depth = readU32(header + 20);
+    uint32_t flags = readU32(header + 4);
+    // 没有 DDSD_MIPMAPCOUNT 时 dwMipMapCount 无意义，只有第 0 级
+    const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    uint32_t levelCount = (flags & DDSD_MIPMAPCOUNT) ? std::max(1u, readU32(header + 24)) : 1;
+    const unsigned char* pixelFormat = header + 72;
+    uint32_t pixelFormatFlags = readU32(pixelFormat + 4);
+    uint32_t formatCode = readU32(pixelFormat + 8);
+    uint32_t caps2 = readU32(header + 108);
+
+    const uint32_t DDPF_FOURCC = 0x4;
+    const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+    const uint32_t DDSCAPS2_VOLUME = 0x200000;
+    if (!(pixelFormatFlags & DDPF_FOURCC)) {
+        error = "只支持块压缩的 DDS 纹理";
+        return false;
+    }
+    if ((caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) || depth > 1 || width == 0 || height == 0) {
+        error = "只支持 2D 单层 DDS 纹理";
+        return false;
+    }
+    if (levelCount > mipLevelCount(width, height)) {
+        error = "DDS 层级数超过完整 mip 链";
+        return false;
+    }
+
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    size_t dataOffset = 128;
+    if (formatCode == fourCC('D', 'X', '1', '0')) {
+        if (data.size() < 148) {
+            error = "DDS 扩展头不完整";
+            return false;
+        }
+        const unsigned char* header10 = data.data() + 128;
+        const uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+        if (readU32(header10 + 4) != DDS_DIMENSION_TEXTURE2D || readU32(header10 + 12) > 1) {
+            error = "只支持 2D 单层 DDS 纹理";
+            return false;
+        }
+        format = dxgiToVkFormat(readU32(header10));
+        dataOffset = 148;
+    }
+    else if (formatCode == fourCC('D', 'X', 'T', '1')) {
+        format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    }
+    else if (formatCode == fourCC('D', 'X', 'T', '5')) {
+        format = VK_FORMAT_BC3_UNORM_BLOCK;
+    }
+    else if (formatCode == fourCC('A', 'T', 'I', '2') || formatCode == fourCC('B', 'C', '5', 'U')) {
+        format = VK_FORMAT_BC5_UNORM_BLOCK;
+    }
+    if (format == VK_FORMAT_UNDEFINED) {
+        error = "不支持的 DDS 格式";
+        return false;
+    }
+
+    image.format = format;
+    image.width = width;
+    image.height = height;
+    image.levels.clear();
+    size_t offset = dataOffset;
+    for (uint32_t level = 0; level < levelCount; level++) {
+        uint32_t levelWidth = std::max(1u, width >> level);
+        uint32_t levelHeight = std::max(1u, height >> level);
+        size_t size = compressedLevelSize(format, levelWidth, levelHeight);
+        if (offset > data.size() || size > data.size() - offset) {
+            error = "DDS 层级数据越界";
+            return false;
+        }
+        image.levels.push_back({ levelWidth, levelHeight, offset, size });
+        offset += size;
+    }
+    return true;
+}
+
+} // namespace texture_container_detail
+
+// 是否为可直接上传的压缩纹理容器（按扩展名判断）
+inline bool isCompressedTextureFile(const std::string& path) {
+    return texture_container_detail::hasExtension(path, ".ktx2") || texture_container_detail::hasExtension(path, ".dds");
+}
+
+// 读取并解析 KTX2 / DDS 文件，失败时返回 false 并给出原因
+inline bool loadCompressedTexture(const std::string& path, CompressedImage& image, std::string& error) {
+    using namespace texture_container_detail;
+    if (!image.data.open(path)) {
+        error = "无法读取文件";
+        return false;
+    }
+    if (hasExtension(path, ".ktx2")) {
+        return parseKtx2(image, error);
+    }
+    return parseDds(image, error);
+}
+
+#endif // TEXTURECONTAINER_H
@@ -0,0 +1,466 @@
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "MemoryAllocator.h"
+#include "UploadBatcher.h"
+
+// 解码得到的完整 mip 链，levels 指向 owner 持有的内存
+struct DecodedTextureLevels {
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    std::vector<ImageLevel> levels;
+    std::shared_ptr<void> owner;
+};
+
+// 一帧中一个纹理的屏幕空间使用情况
+struct TextureUsage {
+    uint32_t texture;      // addTexture 返回的纹理序号
+    uint32_t desiredSize;  // 期望的纹理分辨率（长边像素数），通常取使用它的网格在屏幕上的投影大小
+};
+
+// 纹理当前的常驻版本，baseLevel 是常驻图像第 0 级对应的源 mip 层级
+struct StreamedTextureView {
+    VkImageView imageView = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+    uint32_t baseLevel = 0;
+    VkDeviceSize residentBytes = 0;  // 常驻层级的大小
+};
+
+// 流式纹理统计，字节数按各层级数据大小估算
+struct TextureStreamingStats {
+    uint32_t textureCount = 0;       // 纹理数量
+    VkDeviceSize residentBytes = 0;  // 常驻层级的总大小
+    VkDeviceSize budgetBytes = 0;    // 预算
+    uint32_t pendingSwaps = 0;       // 正在进行的切换
+    uint64_t promotions = 0;         // 完成的提升（加载更精细的层级）次数
+    uint64_t evictions = 0;          // 完成的淘汰（退回更粗的层级）次数
+    uint64_t budgetLimited = 0;      // 因预算不足而降低或放弃的提升请求次数
+};
+
+// 流式纹理依赖的外部服务，由 ModelLoader 提供
+struct TextureStreamerContext {
+    std::function<void(std::function<void()>)> enqueueTask;   // 投递后台任务，为空时在调用线程执行
+    std::function<void(std::function<void()>)> deferDestroy;  // 等 GPU 不再使用后再执行的销毁操作，为空时立即销毁
+    std::function<bool(const std::string&, DecodedTextureLevels&)> decode;  // 重新读取并解码纹理的完整 mip 链
+    std::function<void(const std::function<void(UploadBatcher&)>&)> upload;  // 在上传锁内录制拷贝，返回前提交并等待完成
+};
+
+// 流式纹理：加载时只上传长边不超过 tailSize 的低分辨率尾部层级，之后按渲染器上报的屏幕空间使用情况
+// 提升到更精细的层级。常驻层级总大小超过预算时，按最近使用时间淘汰不再使用的纹理，退回尾部层级。
+// 提升和淘汰都重建一张只包含目标层级及以下的图像：在后台任务中解码（尾部层级在内存中保留一份，
+// 淘汰不需要解码）并上传，完成后替换常驻版本，旧图像延迟到在途帧结束后销毁，渲染线程从不等待
+class TextureStreamer {
+public:
+    static constexpr uint32_t MAX_PENDING_SWAPS = 2;      // 同时进行的切换数量上限，限制解码和上传占用的带宽
+    static constexpr uint64_t EVICTION_GRACE_FRAMES = 2;  // 最近这么多帧内使用过的纹理不作为 LRU 淘汰对象
+
+    // budget 为 0 时不限制
+    TextureStreamer(VkDevice device, DeviceMemoryAllocator* allocator, const TextureStreamerContext& context,
+        VkDeviceSize budget, uint32_t tailSize)
+        : device(device), allocator(allocator), context(context), budget(budget), tailSize(std::max(tailSize, 1u)) {
+    }
+
+    ~TextureStreamer() {
+        std::unique_lock<std::mutex> lock(mutex);
+        swapCondition.wait(lock, [this]() { return pendingSwaps == 0; });
+        for (auto& entry : entries) {
+            vkDestroyImageView(device, entry->view, nullptr);
+            allocator->destroyImage(entry->image, entry->memory);
+            vkDestroySampler(device, entry->sampler, nullptr);
+        }
+    }
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // 添加纹理，levels 为完整 mip 链。只创建尾部层级的图像并录制进调用方的上传批次（提交前不可用），
+    // 尾部数据复制一份保留。sampler 归流式纹理所有。返回纹理序号
+    uint32_t addTexture(const std::string& path, VkFormat format, const std::vector<ImageLevel>& levels, VkSampler sampler,
+        UploadBatcher& uploader) {
+        auto entry = std::make_unique<Entry>();
+        entry->path = path;
+        entry->format = format;
+        entry->sampler = sampler;
+        entry->levelCount = static_cast<uint32_t>(levels.size());
+        entry->longSide = std::max(levels[0].width, levels[0].height);
+        for (const auto& level : levels) {
+            entry->levelSizes.push_back(level.size);
+        }
+        while (entry->tailLevel + 1 < entry->levelCount
+            && std::max(levels[entry->tailLevel].width, levels[entry->tailLevel].height) > tailSize) {
+            entry->tailLevel++;
+        }
+
+        VkDeviceSize tailBytes = residentSize(*entry, entry->tailLevel);
+        entry->tailData.resize(static_cast<size_t>(tailBytes));
+        unsigned char* tailPixels = entry->tailData.data();
+        for (uint32_t level = entry->tailLevel; level < entry->levelCount; level++) {
+            memcpy(tailPixels, levels[level].pixels, static_cast<size_t>(levels[level].size));
+            entry->tailLevels.push_back({ levels[level].width, levels[level].height, tailPixels, levels[level].size });
+            tailPixels += levels[level].size;
+        }
+
+        createResidentImage(entry->format, entry->tailLevels, uploader, entry->image, entry->memory, entry->view);
+        entry->residentLevel = entry->tailLevel;
+        entry->requestedLevel = entry->tailLevel;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        residentBytes += tailBytes;
+        entries.push_back(std::move(entry));
+        return static_cast<uint32_t>(entries.size() - 1);
+    }
+
+    // 上报一帧的使用情况，同一帧内多次上报同一纹理时取最精细的需求
+    void reportUsage(const std::vector<TextureUsage>& usage, uint64_t frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const TextureUsage& use : usage) {
+            if (use.texture >= entries.size()) {
+                continue;
+            }
+            Entry& entry = *entries[use.texture];
+            uint32_t level = levelForSize(entry, use.desiredSize);
+            if (!entry.used || entry.lastUsedFrame != frame) {
+                entry.requestedLevel = level;
+            }
+            else {
+                entry.requestedLevel = std::min(entry.requestedLevel, level);
+            }
+            entry.used = true;
+            entry.lastUsedFrame = frame;
+        }
+    }
+
+    // 每帧调用一次：超出预算时安排淘汰，按本帧的需求安排提升。切换在后台任务中执行，这里只做记账
+    void update(uint64_t frame) {
+        std::vector<Swap> swaps;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uint32_t slots = pendingSwaps < MAX_PENDING_SWAPS ? MAX_PENDING_SWAPS - pendingSwaps : 0;
+            // 按已安排的切换完成后的大小判断预算
+            int64_t projected = static_cast<int64_t>(residentBytes) + pendingDelta;
+            int64_t limit = budget > 0 ? static_cast<int64_t>(budget) : INT64_MAX;
+
+            // 淘汰候选：宽限期内没有使用过的纹理按最近使用时间从旧到新，退回尾部层级；
+            // 仍在使用但常驻层级比需求更精细的纹理排在最后，退回到需求层级
+            std::vector<uint32_t> evictable;
+            for (uint32_t i = 0; i < entries.size(); i++) {
+                const Entry& entry = *entries[i];
+                if (!entry.pending && entry.residentLevel < entry.tailLevel
+                    && (isStale(entry, frame) || entry.requestedLevel > entry.residentLevel)) {
+                    evictable.push_back(i);
+                }
+            }
+            std::sort(evictable.begin(), evictable.end(), [this, frame](uint32_t a, uint32_t b) {
+                bool staleA = isStale(*entries[a], frame);
+                bool staleB = isStale(*entries[b], frame);
+                if (staleA != staleB) {
+                    return staleA;
+                }
+                return entries[a]->lastUsedFrame < entries[b]->lastUsedFrame;
+            });
+            size_t nextEviction = 0;
+            auto evictOne = [&]() {
+                uint32_t index = evictable[nextEviction++];
+                Entry& entry = *entries[index];
+                uint32_t target = isStale(entry, frame) ? entry.tailLevel : entry.requestedLevel;
+                int64_t delta = static_cast<int64_t>(residentSize(entry, target)) - static_cast<int64_t>(residentSize(entry, entry.residentLevel));
+                schedule(swaps, index, target, delta);
+                projected += delta;
+                slots--;
+            };
+
+            while (projected > limit && slots > 0 && nextEviction < evictable.size()) {
+                evictOne();
+            }
+
+            // 提升候选：本帧使用、需求比常驻层级更精细的纹理，层级差距大的优先
+            std::vector<uint32_t> promotable;
+            for (uint32_t i = 0; i < entries.size(); i++) {
+                const Entry& entry = *entries[i];
+                if (!entry.pending && !entry.decodeFailed && entry.used && entry.lastUsedFrame == frame
+                    && entry.requestedLevel < entry.residentLevel) {
+                    promotable.push_back(i);
+                }
+            }
+            std::sort(promotable.begin(), promotable.end(), [this](uint32_t a, uint32_t b) {
+                return entries[a]->residentLevel - entries[a]->requestedLevel > entries[b]->residentLevel - entries[b]->requestedLevel;
+            });
+
+            for (uint32_t index : promotable) {
+                if (slots == 0) {
+                    break;
+                }
+                Entry& entry = *entries[index];
+                if (entry.pending) {
+                    continue;  // 刚被安排淘汰
+                }
+                int64_t current = static_cast<int64_t>(residentSize(entry, entry.residentLevel));
+                uint32_t target = entry.requestedLevel;
+                // 预算不足时先淘汰不再使用的纹理（至少留一个名额给提升），仍放不下则选择能放下的最精细层级
+                while (projected + static_cast<int64_t>(residentSize(entry, target)) - current > limit
+                    && slots > 1 && nextEviction < evictable.size() && isStale(*entries[evictable[nextEviction]], frame)) {
+                    evictOne();
+                }
+                while (target < entry.residentLevel && projected + static_cast<int64_t>(residentSize(entry, target)) - current > limit) {
+                    target++;
+                }
+                if (target != entry.requestedLevel) {
+                    budgetLimited++;
+                }
+                if (target == entry.residentLevel) {
+                    continue;
+                }
+                int64_t delta = static_cast<int64_t>(residentSize(entry, target)) - current;
+                schedule(swaps, index, target, delta);
+                projected += delta;
+                slots--;
+            }
+        }
+
+        for (const Swap& swap : swaps) {
+            if (context.enqueueTask) {
+                context.enqueueTask([this, swap]() { performSwap(swap); });
+            }
+            else {
+                performSwap(swap);
+            }
+        }
+    }
+
+    // 纹理当前的常驻版本。替换后旧视图延迟销毁，已录制的帧仍可使用
+    StreamedTextureView getTexture(uint32_t texture) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        StreamedTextureView view;
+        if (texture < entries.size()) {
+            const Entry& entry = *entries[texture];
+            view.imageView = entry.view;
+            view.sampler = entry.sampler;
+            view.baseLevel = entry.residentLevel;
+            view.residentBytes = residentSize(entry, entry.residentLevel);
+        }
+        return view;
+    }
+
+    // 调整预算，超出部分在之后的 update 中淘汰
+    void setBudget(VkDeviceSize bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budget = bytes;
+    }
+
+    TextureStreamingStats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        TextureStreamingStats stats;
+        stats.textureCount = static_cast<uint32_t>(entries.size());
+        stats.residentBytes = residentBytes;
+        stats.budgetBytes = budget;
+        stats.pendingSwaps = pendingSwaps;
+        stats.promotions = promotions;
+        stats.evictions = evictions;
+        stats.budgetLimited = budgetLimited;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        std::string path;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkSampler sampler = VK_NULL_HANDLE;
+        uint32_t levelCount = 0;                 // 源 mip 层级数
+        uint32_t longSide = 0;                   // 源第 0 级的长边
+        std::vector<VkDeviceSize> levelSizes;    // 各源层级的数据大小
+        uint32_t tailLevel = 0;                  // 始终常驻的最精细层级
+        std::vector<unsigned char> tailData;     // 尾部层级数据
+        std::vector<ImageLevel> tailLevels;      // 指向 tailData
+        VkImage image = VK_NULL_HANDLE;          // 常驻图像，包含 residentLevel 及以下各级
+        MemoryAllocation memory;
+        VkImageView view = VK_NULL_HANDLE;
+        uint32_t residentLevel = 0;
+        uint32_t requestedLevel = 0;             // 最近一帧的需求
+        uint64_t lastUsedFrame = 0;
+        bool used = false;                       // 是否上报过使用
+        bool pending = false;                    // 是否有进行中的切换
+        bool decodeFailed = false;               // 重新解码失败后不再提升
+    };
+
+    struct Swap {
+        uint32_t texture;
+        uint32_t targetLevel;
+        int64_t delta;  // 切换完成后常驻大小的变化
+    };
+
+    VkDevice device;
+    DeviceMemoryAllocator* allocator;
+    TextureStreamerContext context;
+    VkDeviceSize budget;
+    uint32_t tailSize;
+    mutable std::mutex mutex;  // 保护以下全部状态
+    std::condition_variable swapCondition;
+    std::vector<std::unique_ptr<Entry>> entries;  // 条目地址不变，切换任务持有指针
+    VkDeviceSize residentBytes = 0;
+    int64_t pendingDelta = 0;  // 已安排但未完成的切换带来的大小变化
+    uint32_t pendingSwaps = 0;
+    uint64_t promotions = 0;
+    uint64_t evictions = 0;
+    uint64_t budgetLimited = 0;
+
+    static bool isStale(const Entry& entry, uint64_t frame) {
+        return !entry.used || entry.lastUsedFrame + EVICTION_GRACE_FRAMES < frame;
+    }
+
+    // 常驻 level 及以下各级的总大小
+    static VkDeviceSize residentSize(const Entry& entry, uint32_t level) {
+        VkDeviceSize size = 0;
+        for (uint32_t i = level; i < entry.levelCount; i++) {
+            size += entry.levelSizes[i];
+        }
+        return size;
+    }
+
+    // 长边不小于 desiredSize 的最粗层级，不会比尾部层级更粗
+    static uint32_t levelForSize(const Entry& entry, uint32_t desiredSize) {
+        uint32_t level = 0;
+        while (level < entry.tailLevel && (entry.longSide >> (level + 1)) >= desiredSize) {
+            level++;
+        }
+        return level;
+    }
+
+    // 调用方持有 mutex
+    void schedule(std::vector<Swap>& swaps, uint32_t texture, uint32_t targetLevel, int64_t delta) {
+        entries[texture]->pending = true;
+        pendingSwaps++;
+        pendingDelta += delta;
+        swaps.push_back({ texture, targetLevel, delta });
+    }
+
+    // 在后台任务中重建常驻图像并替换
+    void performSwap(const Swap& swap) {
+        Entry* entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entry = entries[swap.texture].get();
+        }
+        // 以下字段在 addTexture 之后不再修改，不需要加锁读取
+        const std::string& path = entry->path;
+        bool promotion = swap.delta > 0;
+
+        VkImage image = VK_NULL_HANDLE;
+        MemoryAllocation memory;
+        VkImageView view = VK_NULL_HANDLE;
+        bool succeeded = false;
+        try {
+            DecodedTextureLevels decoded;
+            std::vector<ImageLevel> levels;
+            if (swap.targetLevel >= entry->tailLevel) {
+                levels.assign(entry->tailLevels.begin() + (swap.targetLevel - entry->tailLevel), entry->tailLevels.end());
+            }
+            else {
+                if (!context.decode || !context.decode(path, decoded) || decoded.format != entry->format
+                    || decoded.levels.size() != entry->levelCount) {
+                    throw std::runtime_error("重新解码的纹理与首次加载时不一致");
+                }
+                levels.assign(decoded.levels.begin() + swap.targetLevel, decoded.levels.end());
+            }
+            context.upload([&](UploadBatcher& uploader) {
+                createResidentImage(entry->format, levels, uploader, image, memory, view);
+            });
+            succeeded = true;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "错误: 纹理流式切换失败: " << path << " (" << e.what() << ")" << std::endl;
+            if (view != VK_NULL_HANDLE) {
+                vkDestroyImageView(device, view, nullptr);
+            }
+            allocator->destroyImage(image, memory);
+        }
+
+        VkImage oldImage = VK_NULL_HANDLE;
+        MemoryAllocation oldMemory;
+        VkImageView oldView = VK_NULL_HANDLE;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (succeeded) {
+                oldImage = entry->image;
+                oldMemory = entry->memory;
+                oldView = entry->view;
+                entry->image = image;
+                entry->memory = memory;
+                entry->view = view;
+                residentBytes = static_cast<VkDeviceSize>(static_cast<int64_t>(residentBytes) + swap.delta);
+                entry->residentLevel = swap.targetLevel;
+                (promotion ? promotions : evictions)++;
+            }
+            else if (promotion) {
+                entry->decodeFailed = true;
+            }
+            entry->pending = false;
+            pendingDelta -= swap.delta;
+            pendingSwaps--;
+        }
+        swapCondition.notify_all();
+
+        if (oldImage != VK_NULL_HANDLE) {
+            VkDevice device = this->device;
+            DeviceMemoryAllocator* allocator = this->allocator;
+            auto destroy = [device, allocator, oldImage, oldMemory, oldView]() mutable {
+                vkDestroyImageView(device, oldView, nullptr);
+                allocator->destroyImage(oldImage, oldMemory);
+            };
+            if (context.deferDestroy) {
+                context.deferDestroy(destroy);
+            }
+            else {
+                destroy();
+            }
+        }
+    }
+
+    // 创建只包含给定层级的图像并录制上传，所有层级都由 levels 提供，不在 GPU 上生成
+    void createResidentImage(VkFormat format, const std::vector<ImageLevel>& levels, UploadBatcher& uploader,
+        VkImage& image, MemoryAllocation& memory, VkImageView& view) {
+        uint32_t levelCount = static_cast<uint32_t>(levels.size());
+
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = format;
+        imageInfo.extent = { levels[0].width, levels[0].height, 1 };
+        imageInfo.mipLevels = levelCount;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        allocator->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+
+        uploader.uploadImage(image, levels, levelCount);
+
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = levelCount;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS) {
+            throw std::runtime_error("创建流式纹理图像视图失败！");
+        }
+    }
+};
+
+#endif // TEXTURESTREAMER_H
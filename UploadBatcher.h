@@ -0,0 +1,623 @@
+#ifndef UPLOADBATCHER_H
+#define UPLOADBATCHER_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "GpuProfiler.h"
+#include "MemoryAllocator.h"
+
+// 上传使用的队列及其命令池。命令池必须属于 familyIndex 对应的队列族
+struct UploadQueue {
+    VkQueue queue = VK_NULL_HANDLE;                   // 提交队列，为空表示不可用
+    VkCommandPool commandPool = VK_NULL_HANDLE;       // 该队列族的命令池
+    uint32_t familyIndex = VK_QUEUE_FAMILY_IGNORED;   // 队列族索引
+    std::mutex* mutex = nullptr;                      // 队列提交锁，可为空
+};
+
+// 一个 mip 层级的像素数据
+struct ImageLevel {
+    uint32_t width;       // 层级宽度
+    uint32_t height;      // 层级高度
+    const void* pixels;   // 紧密排列的像素数据
+    VkDeviceSize size;    // 数据大小（字节）
+};
+
+// 上传批处理器：所有暂存数据写入一块持久映射的环形缓冲区，
+// 拷贝和布局转换录制进同一个命令缓冲区，flush 时一次提交、一个栅栏等待。
+// 提供了独立的传输队列时，暂存拷贝在传输队列上执行，资源通过队列族所有权转移
+// 释放给图形队列；图形队列上的获取屏障等待传输提交发出的信号量。
+// 设置了分析器时，每次提交的命令缓冲区首尾写入时间戳，等待栅栏后把 GPU 耗时计入分析器
+class UploadBatcher {
+public:
+    static constexpr VkDeviceSize DEFAULT_RING_SIZE = 32ull * 1024 * 1024;
+
+    UploadBatcher(VkDevice device, VkPhysicalDevice physicalDevice, DeviceMemoryAllocator* allocator,
+        const UploadQueue& graphics, const UploadQueue& transfer = UploadQueue(), VkDeviceSize ringSize = DEFAULT_RING_SIZE)
+        : device(device), allocator(allocator), graphics(graphics), transfer(transfer), ringSize(ringSize) {
+        dedicatedTransfer = transfer.queue != VK_NULL_HANDLE && transfer.familyIndex != graphics.familyIndex;
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        // 缓冲区到图像的拷贝偏移至少按 4 字节和纹素大小对齐，这里统一取 16
+        copyAlignment = std::max<VkDeviceSize>(16, properties.limits.optimalBufferCopyOffsetAlignment);
+
+        timestampPeriod = properties.limits.timestampPeriod;
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+        graphicsTimestampMask = timestampMask(queueFamilies, graphics.familyIndex);
+        transferTimestampMask = dedicatedTransfer ? timestampMask(queueFamilies, transfer.familyIndex) : 0;
+
+        allocator->createBuffer(ringSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            ringBuffer, ringMemory);
+        ringData = static_cast<char*>(ringMemory.mappedData);
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+            throw std::runtime_error("创建上传栅栏失败！");
+        }
+
+        if (dedicatedTransfer) {
+            VkSemaphoreCreateInfo semaphoreInfo = {};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &transferSemaphore) != VK_SUCCESS) {
+                throw std::runtime_error("创建上传信号量失败！");
+            }
+        }
+    }
+
+    ~UploadBatcher() {
+        flush();
+        if (transferSemaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, transferSemaphore, nullptr);
+        }
+        vkDestroyFence(device, fence, nullptr);
+        if (queryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device, queryPool, nullptr);
+        }
+        allocator->destroyBuffer(ringBuffer, ringMemory);
+    }
+
+    UploadBatcher(const UploadBatcher&) = delete;
+    UploadBatcher& operator=(const UploadBatcher&) = delete;
+
+    // 是否在独立的传输队列上执行暂存拷贝
+    bool usesDedicatedTransfer() const {
+        return dedicatedTransfer;
+    }
+
+    // 设置接收上传 GPU 耗时的分析器，可为空。图形命令缓冲区计为"上传"，独立传输队列上的拷贝计为"上传（传输队列）"。
+    // 图形队列不支持时间戳时不计时。不能在批次录制中途调用
+    void setProfiler(GpuProfiler* gpuProfiler) {
+        profiler = gpuProfiler;
+        if (!profiler || queryPool != VK_NULL_HANDLE || graphicsTimestampMask == 0 || timestampPeriod <= 0.0f) {
+            return;
+        }
+        VkQueryPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = TIMING_QUERY_COUNT;
+        if (vkCreateQueryPool(device, &poolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+            throw std::runtime_error("创建上传时间戳查询池失败！");
+        }
+    }
+
+    // 上传数据到缓冲区的指定偏移。目标区间必须是新写入的，旧内容不会被保留给传输队列
+    void uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+        VkBuffer srcBuffer;
+        VkDeviceSize srcOffset = stage(data, size, srcBuffer);
+
+        VkBufferCopy copyRegion = {};
+        copyRegion.srcOffset = srcOffset;
+        copyRegion.dstOffset = dstOffset;
+        copyRegion.size = size;
+        vkCmdCopyBuffer(transferCommandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+
+        if (dedicatedTransfer) {
+            // 只转移本次写入的区间，缓冲区其他区间仍归图形队列所有
+            VkBufferMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = transfer.familyIndex;
+            barrier.dstQueueFamilyIndex = graphics.familyIndex;
+            barrier.buffer = dstBuffer;
+            barrier.offset = dstOffset;
+            barrier.size = size;
+            bufferTransfers.push_back(barrier);
+        }
+        else {
+            graphicsBufferWrites = true;
+        }
+    }
+
+    // 在 GPU 上拷贝缓冲区内容（例如扩容时搬移旧数据）。
+    // 源缓冲区归图形队列所有，因此拷贝总是录制在图形队列的命令缓冲区中
+    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0) {
+        ensureGraphicsRecording();
+
+        // 源缓冲区可能在本批次中刚被写入，先让之前的传输写入对拷贝读取可见
+        if (graphicsBufferWrites) {
+            VkMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(graphicsCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        VkBufferCopy copyRegion = {};
+        copyRegion.srcOffset = srcOffset;
+        copyRegion.dstOffset = dstOffset;
+        copyRegion.size = size;
+        vkCmdCopyBuffer(graphicsCommandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+        graphicsBufferWrites = true;
+    }
+
+    // 上传 2D 图像的前 levels.size() 级，其余层级（直到 mipLevels）在图形队列上用线性过滤的 blit 逐级生成。
+    // 调用方需保证图像格式支持 BLIT_SRC/BLIT_DST 和线性过滤。完成后所有层级处于着色器只读布局
+    void uploadImage(VkImage image, const std::vector<ImageLevel>& levels, uint32_t mipLevels) {
+        uint32_t providedLevels = static_cast<uint32_t>(levels.size());
+        bool generateMips = providedLevels < mipLevels;
+
+        // 所有层级一次写入暂存区，保证同一图像的拷贝不会被中途提交拆开
+        std::vector<VkDeviceSize> levelOffsets;
+        VkDeviceSize totalSize = 0;
+        for (const auto& level : levels) {
+            totalSize = alignUp(totalSize);
+            levelOffsets.push_back(totalSize);
+            totalSize += level.size;
+        }
+        VkBuffer srcBuffer;
+        VkDeviceSize srcOffset;
+        char* stagingData = reserve(totalSize, srcBuffer, srcOffset);
+        for (uint32_t i = 0; i < providedLevels; i++) {
+            memcpy(stagingData + levelOffsets[i], levels[i].pixels, static_cast<size_t>(levels[i].size));
+        }
+
+        VkImageMemoryBarrier barrier = imageBarrier(image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, providedLevels);
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(transferCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        std::vector<VkBufferImageCopy> regions(providedLevels);
+        for (uint32_t i = 0; i < providedLevels; i++) {
+            VkBufferImageCopy& region = regions[i];
+            region = {};
+            region.bufferOffset = srcOffset + levelOffsets[i];
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = i;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = { 0, 0, 0 };
+            region.imageExtent = { levels[i].width, levels[i].height, 1 };
+        }
+        vkCmdCopyBufferToImage(transferCommandBuffer, srcBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            providedLevels, regions.data());
+
+        // 不再写入的层级转换到着色器只读；需要生成 mip 时最后一个上传层级保持 TRANSFER_DST 作为 blit 源。
+        // 独立传输队列时这些转换同时是所有权释放，获取在 flush 时录制
+        uint32_t readyLevels = generateMips ? providedLevels - 1 : providedLevels;
+        if (readyLevels > 0) {
+            barrier = imageBarrier(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, readyLevels);
+            if (dedicatedTransfer) {
+                barrier.srcQueueFamilyIndex = transfer.familyIndex;
+                barrier.dstQueueFamilyIndex = graphics.familyIndex;
+                imageTransfers.push_back(barrier);
+            }
+            else {
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                vkCmdPipelineBarrier(transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                    0, 0, nullptr, 0, nullptr, 1, &barrier);
+            }
+        }
+        if (generateMips) {
+            if (dedicatedTransfer) {
+                barrier = imageBarrier(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, providedLevels - 1, 1);
+                barrier.srcQueueFamilyIndex = transfer.familyIndex;
+                barrier.dstQueueFamilyIndex = graphics.familyIndex;
+                imageTransfers.push_back(barrier);
+            }
+            MipChain chain;
+            chain.image = image;
+            chain.width = levels.back().width;
+            chain.height = levels.back().height;
+            chain.firstLevel = providedLevels;
+            chain.levelCount = mipLevels;
+            mipChains.push_back(chain);
+        }
+    }
+
+    // 提交当前批次并等待完成，之后环形缓冲区从头复用
+    void flush() {
+        if (transferCommandBuffer == VK_NULL_HANDLE && graphicsCommandBuffer == VK_NULL_HANDLE) {
+            return;
+        }
+
+        bool transferSubmitted = false;
+        if (dedicatedTransfer && transferCommandBuffer != VK_NULL_HANDLE) {
+            // 释放屏障：传输写入完成后把所有权交给图形队列族
+            for (auto& barrier : bufferTransfers) {
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = 0;
+            }
+            for (auto& barrier : imageTransfers) {
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = 0;
+            }
+            vkCmdPipelineBarrier(transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                0, nullptr, static_cast<uint32_t>(bufferTransfers.size()), bufferTransfers.data(),
+                static_cast<uint32_t>(imageTransfers.size()), imageTransfers.data());
+            if (timingTransfer) {
+                vkCmdWriteTimestamp(transferCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool,
+                    transferQuery(transferQuerySlot) + 1);
+            }
+            vkEndCommandBuffer(transferCommandBuffer);
+
+            VkSubmitInfo submitInfo = {};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &transferCommandBuffer;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &transferSemaphore;
+            transferSubmitTime = std::chrono::steady_clock::now();
+            submit(transfer, submitInfo, VK_NULL_HANDLE);
+            transferSubmitted = true;
+
+            // 获取屏障：与释放屏障的布局和队列族一致，由图形队列等待信号量后执行。
+            // 缓冲区除顶点输入和间接绘制外还被计算剔除以存储缓冲区读取
+            ensureGraphicsRecording();
+            for (auto& barrier : bufferTransfers) {
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+                    | VK_ACCESS_SHADER_READ_BIT;
+            }
+            for (auto& barrier : imageTransfers) {
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = barrier.newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                    ? VK_ACCESS_SHADER_READ_BIT : VK_ACCESS_TRANSFER_READ_BIT;
+            }
+            vkCmdPipelineBarrier(graphicsCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                0, nullptr, static_cast<uint32_t>(bufferTransfers.size()), bufferTransfers.data(),
+                static_cast<uint32_t>(imageTransfers.size()), imageTransfers.data());
+        }
+
+        // mip 生成需要图形队列，放在所有权获取之后
+        if (!mipChains.empty()) {
+            ensureGraphicsRecording();
+            for (const auto& chain : mipChains) {
+                recordMipChain(chain);
+            }
+        }
+
+        // 图形队列上的缓冲区写入对顶点输入、索引读取、间接命令读取和计算剔除的存储缓冲区读取可见
+        if (graphicsBufferWrites) {
+            VkMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+                | VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(graphicsCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        if (timingGraphics) {
+            vkCmdWriteTimestamp(graphicsCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+        }
+        vkEndCommandBuffer(graphicsCommandBuffer);
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &graphicsCommandBuffer;
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        if (transferSubmitted) {
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = &transferSemaphore;
+            submitInfo.pWaitDstStageMask = &waitStage;
+        }
+        std::chrono::steady_clock::time_point graphicsSubmitTime = std::chrono::steady_clock::now();
+        submit(graphics, submitInfo, fence);
+
+        // 图形提交等待了传输信号量，它完成即表示整个批次完成
+        vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(device, 1, &fence);
+        collectTimings(graphicsSubmitTime);
+
+        if (dedicatedTransfer && transferCommandBuffer != VK_NULL_HANDLE) {
+            vkFreeCommandBuffers(device, transfer.commandPool, 1, &transferCommandBuffer);
+        }
+        vkFreeCommandBuffers(device, graphics.commandPool, 1, &graphicsCommandBuffer);
+        transferCommandBuffer = VK_NULL_HANDLE;
+        graphicsCommandBuffer = VK_NULL_HANDLE;
+        graphicsBufferWrites = false;
+        bufferTransfers.clear();
+        imageTransfers.clear();
+        mipChains.clear();
+        ringHead = 0;
+        for (auto& staging : oversizedStaging) {
+            allocator->destroyBuffer(staging.first, staging.second);
+        }
+        oversizedStaging.clear();
+        submitCount++;
+    }
+
+    // 累计提交次数
+    uint64_t getSubmitCount() const {
+        return submitCount;
+    }
+
+private:
+    // 一张图像待生成的 mip 层级：从 firstLevel - 1 级开始逐级 blit
+    struct MipChain {
+        VkImage image;
+        uint32_t width;       // 第 firstLevel - 1 级的宽度
+        uint32_t height;      // 第 firstLevel - 1 级的高度
+        uint32_t firstLevel;  // 第一个需要生成的层级
+        uint32_t levelCount;  // 图像总层级数
+    };
+
+    VkDevice device;
+    DeviceMemoryAllocator* allocator;
+    UploadQueue graphics;
+    UploadQueue transfer;
+    bool dedicatedTransfer = false;
+    VkDeviceSize ringSize;
+    VkDeviceSize copyAlignment = 16;
+    VkBuffer ringBuffer = VK_NULL_HANDLE;
+    MemoryAllocation ringMemory;
+    char* ringData = nullptr;
+    VkDeviceSize ringHead = 0;
+    VkFence fence = VK_NULL_HANDLE;
+    VkSemaphore transferSemaphore = VK_NULL_HANDLE;  // 传输提交完成后通知图形提交
+    VkCommandBuffer transferCommandBuffer = VK_NULL_HANDLE;  // 暂存拷贝，未使用独立传输队列时与图形命令缓冲区相同
+    VkCommandBuffer graphicsCommandBuffer = VK_NULL_HANDLE;  // 所有权获取和 GPU 间拷贝
+    bool graphicsBufferWrites = false;
+    std::vector<VkBufferMemoryBarrier> bufferTransfers;  // 待转移所有权的缓冲区区间
+    std::vector<VkImageMemoryBarrier> imageTransfers;    // 待转移所有权的图像
+    uint64_t submitCount = 0;
+    GpuProfiler* profiler = nullptr;          // 接收上传耗时，可为空
+    VkQueryPool queryPool = VK_NULL_HANDLE;   // 见 TIMING_QUERY_COUNT，设置分析器后创建
+    float timestampPeriod = 0.0f;             // 每个时间戳计数的纳秒数
+    uint64_t graphicsTimestampMask = 0;       // 时间戳有效位，0 表示该队列族不支持时间戳
+    uint64_t transferTimestampMask = 0;
+    bool timingGraphics = false;              // 当前批次的命令缓冲区是否写入了起始时间戳
+    bool timingTransfer = false;
+    bool transferQueriesReset[2] = {};        // 两组传输查询是否已重置、可以写入
+    uint32_t transferQuerySlot = 0;           // 当前批次使用的传输查询组
+    bool resetNextTransferQueries = false;    // 当前图形命令缓冲区重置了下一组传输查询
+    std::chrono::steady_clock::time_point transferSubmitTime;
+    std::vector<MipChain> mipChains;                     // 待在图形队列上生成的 mip 链
+    std::vector<std::pair<VkBuffer, MemoryAllocation>> oversizedStaging;  // 超过环形缓冲区容量的临时暂存
+
+    // 查询 0/1 为图形命令缓冲区的首尾；2..5 为两组交替使用的传输命令缓冲区首尾。
+    // 传输队列不能录制查询重置，由前一批次的图形命令缓冲区重置下一批次要用的那组
+    static constexpr uint32_t TIMING_QUERY_COUNT = 6;
+
+    static uint32_t transferQuery(uint32_t slot) {
+        return 2 + slot * 2;
+    }
+
+    static uint64_t timestampMask(const std::vector<VkQueueFamilyProperties>& queueFamilies, uint32_t familyIndex) {
+        uint32_t validBits = familyIndex < queueFamilies.size() ? queueFamilies[familyIndex].timestampValidBits : 0;
+        return validBits == 0 ? 0 : validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    }
+
+    // 批次完成后读取时间戳，计入分析器。栅栏已等待，结果可以直接读取
+    void collectTimings(std::chrono::steady_clock::time_point graphicsSubmitTime) {
+        if (timingGraphics) {
+            reportTiming("上传", 0, graphicsTimestampMask, graphicsSubmitTime);
+        }
+        if (timingTransfer) {
+            reportTiming("上传（传输队列）", transferQuery(transferQuerySlot), transferTimestampMask, transferSubmitTime);
+            transferQueriesReset[transferQuerySlot] = false;
+        }
+        if (resetNextTransferQueries) {
+            transferQuerySlot = 1 - transferQuerySlot;
+            transferQueriesReset[transferQuerySlot] = true;
+        }
+        timingGraphics = false;
+        timingTransfer = false;
+        resetNextTransferQueries = false;
+    }
+
+    void reportTiming(const char* name, uint32_t firstQuery, uint64_t mask, std::chrono::steady_clock::time_point submitTime) {
+        uint64_t timestamps[2];
+        if (vkGetQueryPoolResults(device, queryPool, firstQuery, 2, sizeof(timestamps), timestamps, sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+            return;
+        }
+        uint64_t ticks = ((timestamps[1] & mask) - (timestamps[0] & mask)) & mask;
+        profiler->addGpuScope(name, submitTime, ticks * timestampPeriod / 1000000.0);
+    }
+
+    VkCommandBuffer beginCommandBuffer(VkCommandPool pool) {
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = pool;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("分配上传命令缓冲区失败！");
+        }
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        return commandBuffer;
+    }
+
+    void ensureGraphicsRecording() {
+        if (graphicsCommandBuffer == VK_NULL_HANDLE) {
+            graphicsCommandBuffer = beginCommandBuffer(graphics.commandPool);
+            if (queryPool != VK_NULL_HANDLE) {
+                vkCmdResetQueryPool(graphicsCommandBuffer, queryPool, 0, 2);
+                if (transferTimestampMask != 0) {
+                    vkCmdResetQueryPool(graphicsCommandBuffer, queryPool, transferQuery(1 - transferQuerySlot), 2);
+                    resetNextTransferQueries = true;
+                }
+                vkCmdWriteTimestamp(graphicsCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+                timingGraphics = true;
+            }
+            if (!dedicatedTransfer) {
+                transferCommandBuffer = graphicsCommandBuffer;
+            }
+        }
+    }
+
+    void ensureTransferRecording() {
+        if (!dedicatedTransfer) {
+            ensureGraphicsRecording();
+        }
+        else if (transferCommandBuffer == VK_NULL_HANDLE) {
+            transferCommandBuffer = beginCommandBuffer(transfer.commandPool);
+            if (queryPool != VK_NULL_HANDLE && transferQueriesReset[transferQuerySlot]) {
+                vkCmdWriteTimestamp(transferCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, transferQuery(transferQuerySlot));
+                timingTransfer = true;
+            }
+        }
+    }
+
+    void submit(const UploadQueue& target, const VkSubmitInfo& submitInfo, VkFence submitFence) {
+        // 只在提交时持有队列锁，等待栅栏时不阻塞渲染线程
+        std::unique_lock<std::mutex> queueLock;
+        if (target.mutex) {
+            queueLock = std::unique_lock<std::mutex>(*target.mutex);
+        }
+        if (vkQueueSubmit(target.queue, 1, &submitInfo, submitFence) != VK_SUCCESS) {
+            throw std::runtime_error("提交上传命令失败！");
+        }
+    }
+
+    VkDeviceSize alignUp(VkDeviceSize offset) const {
+        return (offset + copyAlignment - 1) / copyAlignment * copyAlignment;
+    }
+
+    // 在暂存区中预留一段空间，返回可写入的主机指针及对应的暂存缓冲区和偏移。
+    // 环形缓冲区写满时先提交已有批次
+    char* reserve(VkDeviceSize size, VkBuffer& srcBuffer, VkDeviceSize& srcOffset) {
+        if (size > ringSize) {
+            VkBuffer stagingBuffer;
+            MemoryAllocation stagingMemory;
+            allocator->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                stagingBuffer, stagingMemory);
+            oversizedStaging.emplace_back(stagingBuffer, stagingMemory);
+            ensureTransferRecording();
+            srcBuffer = stagingBuffer;
+            srcOffset = 0;
+            return static_cast<char*>(stagingMemory.mappedData);
+        }
+
+        VkDeviceSize offset = alignUp(ringHead);
+        if (offset + size > ringSize) {
+            flush();
+            offset = 0;
+        }
+        ensureTransferRecording();
+
+        ringHead = offset + size;
+        srcBuffer = ringBuffer;
+        srcOffset = offset;
+        return ringData + offset;
+    }
+
+    // 把数据写入暂存区，返回暂存缓冲区及偏移
+    VkDeviceSize stage(const void* data, VkDeviceSize size, VkBuffer& srcBuffer) {
+        VkDeviceSize srcOffset;
+        memcpy(reserve(size, srcBuffer, srcOffset), data, static_cast<size_t>(size));
+        return srcOffset;
+    }
+
+    // 逐级 blit 生成 mip：每级先由 TRANSFER_DST 转为 TRANSFER_SRC 作为下一级的源，用完后转为着色器只读
+    void recordMipChain(const MipChain& chain) {
+        VkCommandBuffer commandBuffer = graphicsCommandBuffer;
+
+        VkImageMemoryBarrier barrier = imageBarrier(chain.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            chain.firstLevel, chain.levelCount - chain.firstLevel);
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        int32_t mipWidth = static_cast<int32_t>(chain.width);
+        int32_t mipHeight = static_cast<int32_t>(chain.height);
+        for (uint32_t level = chain.firstLevel; level < chain.levelCount; level++) {
+            barrier = imageBarrier(chain.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, level - 1, 1);
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+            int32_t nextWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+            int32_t nextHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+
+            VkImageBlit blit = {};
+            blit.srcOffsets[0] = { 0, 0, 0 };
+            blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+            blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit.srcSubresource.mipLevel = level - 1;
+            blit.srcSubresource.baseArrayLayer = 0;
+            blit.srcSubresource.layerCount = 1;
+            blit.dstOffsets[0] = { 0, 0, 0 };
+            blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+            blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit.dstSubresource.mipLevel = level;
+            blit.dstSubresource.baseArrayLayer = 0;
+            blit.dstSubresource.layerCount = 1;
+            vkCmdBlitImage(commandBuffer, chain.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                chain.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+            barrier = imageBarrier(chain.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, level - 1, 1);
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+            mipWidth = nextWidth;
+            mipHeight = nextHeight;
+        }
+
+        barrier = imageBarrier(chain.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            chain.levelCount - 1, 1);
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    VkImageMemoryBarrier imageBarrier(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+        uint32_t baseMipLevel, uint32_t levelCount) {
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = baseMipLevel;
+        barrier.subresourceRange.levelCount = levelCount;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        return barrier;
+    }
+};
+
+#endif // UPLOADBATCHER_H
@@ -0,0 +1,107 @@
+// JobSystem 扩展性基准：工作线程数从 1 增加到硬件线程数，测量三种负载的耗时、吞吐和并行效率。
+//   g++ -O2 -std=c++17 -pthread -I.. JobSystemBench.cpp -o JobSystemBench
+//   ./JobSystemBench [任务数量] [每个任务的迭代次数]
+//   flat   渲染线程一次提交全部任务后等待，主要经过注入队列
+//   nested 少量父任务在工作线程上派生子任务，主要经过本地队列和窃取
+//   chain  每批任务依赖上一批（submitAfter），测量依赖释放的开销
+// 输出为 CSV，方便记录和比较
+
+#include "../JobSystem.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+// 固定计算量的工作负载，结果写入 sink 防止被优化掉
+std::atomic<uint64_t> sink{ 0 };
+
+void spin(uint32_t iterations) {
+    uint64_t value = iterations;
+    for (uint32_t i = 0; i < iterations; i++) {
+        value = value * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    sink.fetch_add(value, std::memory_order_relaxed);
+}
+
+double runFlat(JobSystem& jobs, uint32_t jobCount, uint32_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    JobCounter counter;
+    for (uint32_t i = 0; i < jobCount; i++) {
+        jobs.submit([iterations]() { spin(iterations); }, JobPriority::Frame, &counter);
+    }
+    jobs.wait(counter);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double runNested(JobSystem& jobs, uint32_t jobCount, uint32_t iterations) {
+    const uint32_t childrenPerParent = 64;
+    uint32_t parentCount = std::max(jobCount / childrenPerParent, 1u);
+    auto start = std::chrono::steady_clock::now();
+    JobCounter counter;
+    for (uint32_t i = 0; i < parentCount; i++) {
+        jobs.submit([&jobs, &counter, iterations]() {
+            for (uint32_t j = 0; j < childrenPerParent; j++) {
+                jobs.submit([iterations]() { spin(iterations); }, JobPriority::Frame, &counter);
+            }
+        }, JobPriority::Frame, &counter);
+    }
+    jobs.wait(counter);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double runChain(JobSystem& jobs, uint32_t jobCount, uint32_t iterations) {
+    const uint32_t batchSize = 256;
+    uint32_t batchCount = std::max(jobCount / batchSize, 1u);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<JobCounter>> batches;
+    batches.push_back(std::make_unique<JobCounter>());
+    for (uint32_t j = 0; j < batchSize; j++) {
+        jobs.submit([iterations]() { spin(iterations); }, JobPriority::Frame, batches.back().get());
+    }
+    for (uint32_t i = 1; i < batchCount; i++) {
+        JobCounter& dependency = *batches.back();
+        batches.push_back(std::make_unique<JobCounter>());
+        for (uint32_t j = 0; j < batchSize; j++) {
+            jobs.submitAfter(dependency, [iterations]() { spin(iterations); }, JobPriority::Frame, batches.back().get());
+        }
+    }
+    jobs.wait(*batches.back());
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t jobCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 65536;
+    uint32_t iterations = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 2000;
+    uint32_t maxWorkers = std::max(std::thread::hardware_concurrency(), 1u);
+
+    struct Workload {
+        const char* name;
+        double (*run)(JobSystem&, uint32_t, uint32_t);
+        double singleThreadMs;
+    };
+    Workload workloads[] = { { "flat", runFlat, 0.0 }, { "nested", runNested, 0.0 }, { "chain", runChain, 0.0 } };
+
+    std::printf("workload,workers,jobs,iterations,ms,jobs_per_sec,speedup,efficiency\n");
+    for (uint32_t workers = 1; workers <= maxWorkers; workers = workers < maxWorkers ? std::min(workers * 2, maxWorkers) : workers + 1) {
+        JobSystem jobs(workers);
+        for (Workload& workload : workloads) {
+            workload.run(jobs, jobCount / 8, iterations);  // 预热
+            double best = 0.0;
+            for (int repeat = 0; repeat < 3; repeat++) {
+                double ms = workload.run(jobs, jobCount, iterations);
+                best = repeat == 0 ? ms : std::min(best, ms);
+            }
+            if (workers == 1) {
+                workload.singleThreadMs = best;
+            }
+            double speedup = workload.singleThreadMs / best;
+            std::printf("%s,%u,%u,%u,%.3f,%.0f,%.2f,%.2f\n", workload.name, workers, jobCount, iterations, best,
+                jobCount / (best / 1000.0), speedup, speedup / workers);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,535 @@
+// ModelLoader 基准：在无窗口的 Vulkan 设备（如 lavapipe）上反复加载模型，输出分阶段耗时和吞吐。
+//   cmake -S .. -B build && cmake --build build --target ModelLoaderBench
+//   （根目录的 CMakeLists.txt 在找到 Vulkan、assimp、Qt Core、glm 和 stb 时才生成这个目标；
+//    手动编译时链接 ../ModelLoader.cpp，它同时提供 stb_image 的实现：
+//    g++ -O2 -std=c++17 -pthread -I.. ModelLoaderBench.cpp ../ModelLoader.cpp -o ModelLoaderBench -lvulkan -lassimp -lQt5Core）
+//   ./ModelLoaderBench synthetic [--meshes 16] [--vertices 65536] [--textures 4] [--texture-size 1024] [--no-normals] [--no-uvs]
+//   ./ModelLoaderBench corpus <文件或目录>...
+// 通用选项：
+//   --iterations N   计时的加载次数（默认 5），取总耗时的中位数那一次作为结果，另有 1 次不计时的预热
+//   --format F       json（默认）或 csv
+//   --output PATH    结果写入文件；ModelLoader 的日志也输出到 stdout，需要解析结果时应指定
+//   --device NAME    选择名称包含 NAME 的物理设备，例如 llvmpipe 选择 lavapipe
+//   --cache          使用烘焙缓存（默认关闭，每次都经过 Assimp 导入和网格转换）
+//   --unified --compact --no-optimize --lods N   对应 ModelLoadOptions 的同名选项
+// 合成模式在临时目录生成 OBJ/MTL 网格和 TGA 纹理：每个网格是一块起伏的网格面，顶点数向上取整到平方数，
+// 网格按序轮流使用各纹理的材质。每次加载使用新的 ModelLoader（和它自己的设备内存分配器），纹理不跨次复用
+
+#include "../ModelLoader.h"
+#include "../JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct BenchOptions {
+    std::string mode;
+    std::vector<std::string> inputs;  // 语料模式的文件或目录
+    uint32_t meshCount = 16;
+    uint32_t verticesPerMesh = 65536;
+    uint32_t textureCount = 4;
+    uint32_t textureSize = 1024;
+    bool normals = true;
+    bool texCoords = true;
+    uint32_t iterations = 5;
+    bool csv = false;
+    std::string outputPath;
+    std::string deviceName;
+    ModelLoadOptions loadOptions;
+};
+
+// 一个基准用例的结果：中位数那次加载的统计，以及所有计时加载的最短/最长总耗时
+struct BenchResult {
+    std::string name;
+    uint32_t iterations = 0;
+    double minTotalMs = 0.0;
+    double maxTotalMs = 0.0;
+    ModelLoadStats stats;
+};
+
+// 加载所需的最小 Vulkan 环境：不启用任何实例或设备扩展，只创建一个图形队列
+class HeadlessDevice {
+public:
+    explicit HeadlessDevice(const std::string& preferredName) {
+        VkApplicationInfo appInfo = {};
+        appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        appInfo.pApplicationName = "ModelLoaderBench";
+        appInfo.apiVersion = VK_API_VERSION_1_0;
+
+        VkInstanceCreateInfo instanceInfo = {};
+        instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instanceInfo.pApplicationInfo = &appInfo;
+        if (vkCreateInstance(&instanceInfo, nullptr, &instance) != VK_SUCCESS) {
+            throw std::runtime_error("创建 Vulkan 实例失败！");
+        }
+
+        uint32_t deviceCount = 0;
+        vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+        std::vector<VkPhysicalDevice> devices(deviceCount);
+        vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+        for (VkPhysicalDevice candidate : devices) {
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(candidate, &properties);
+            int family = findGraphicsQueueFamily(candidate);
+            if (family < 0 || (!preferredName.empty() && std::strstr(properties.deviceName, preferredName.c_str()) == nullptr)) {
+                continue;
+            }
+            physicalDevice = candidate;
+            queueFamily = static_cast<uint32_t>(family);
+            name = properties.deviceName;
+            break;
+        }
+        if (physicalDevice == VK_NULL_HANDLE) {
+            vkDestroyInstance(instance, nullptr);
+            throw std::runtime_error("没有找到合适的物理设备！");
+        }
+
+        float queuePriority = 1.0f;
+        VkDeviceQueueCreateInfo queueInfo = {};
+        queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueInfo.queueFamilyIndex = queueFamily;
+        queueInfo.queueCount = 1;
+        queueInfo.pQueuePriorities = &queuePriority;
+
+        // 与 RenderManager 一致，支持时开启各向异性过滤，纹理采样器按设备上限创建
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+        VkPhysicalDeviceFeatures features = {};
+        features.samplerAnisotropy = supportedFeatures.samplerAnisotropy;
+        if (supportedFeatures.samplerAnisotropy) {
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+            maxSamplerAnisotropy = properties.limits.maxSamplerAnisotropy;
+        }
+
+        VkDeviceCreateInfo deviceInfo = {};
+        deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        deviceInfo.queueCreateInfoCount = 1;
+        deviceInfo.pQueueCreateInfos = &queueInfo;
+        deviceInfo.pEnabledFeatures = &features;
+        if (vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device) != VK_SUCCESS) {
+            vkDestroyInstance(instance, nullptr);
+            throw std::runtime_error("创建逻辑设备失败！");
+        }
+        vkGetDeviceQueue(device, queueFamily, 0, &queue);
+
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = queueFamily;
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+            vkDestroyDevice(device, nullptr);
+            vkDestroyInstance(instance, nullptr);
+            throw std::runtime_error("创建命令池失败！");
+        }
+    }
+
+    ~HeadlessDevice() {
+        vkDeviceWaitIdle(device);
+        vkDestroyCommandPool(device, commandPool, nullptr);
+        vkDestroyDevice(device, nullptr);
+        vkDestroyInstance(instance, nullptr);
+    }
+
+    HeadlessDevice(const HeadlessDevice&) = delete;
+    HeadlessDevice& operator=(const HeadlessDevice&) = delete;
+
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    uint32_t queueFamily = 0;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    float maxSamplerAnisotropy = 0.0f;
+    std::string name;
+
+private:
+    static int findGraphicsQueueFamily(VkPhysicalDevice physicalDevice) {
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+        for (uint32_t i = 0; i < familyCount; i++) {
+            if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+};
+
+// 写入未压缩的 32 位 TGA，内容为带噪声的棋盘格
+void writeTexture(const std::filesystem::path& path, uint32_t size, uint32_t seed) {
+    FILE* file = std::fopen(path.string().c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("无法创建纹理文件: " + path.string());
+    }
+    unsigned char header[18] = {};
+    header[2] = 2;  // 未压缩真彩色
+    header[12] = static_cast<unsigned char>(size & 0xFF);
+    header[13] = static_cast<unsigned char>(size >> 8);
+    header[14] = static_cast<unsigned char>(size & 0xFF);
+    header[15] = static_cast<unsigned char>(size >> 8);
+    header[16] = 32;
+    header[17] = 8;  // 8 位 alpha
+    std::fwrite(header, 1, sizeof(header), file);
+
+    std::vector<unsigned char> row(static_cast<size_t>(size) * 4);
+    uint32_t state = seed * 747796405u + 2891336453u;
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            state = state * 1664525u + 1013904223u;
+            unsigned char base = ((x / 32 + y / 32) & 1) ? 200 : 55;
+            unsigned char noise = static_cast<unsigned char>(state >> 27);
+            row[x * 4 + 0] = static_cast<unsigned char>(base + noise);
+            row[x * 4 + 1] = static_cast<unsigned char>(base ^ (seed * 37));
+            row[x * 4 + 2] = static_cast<unsigned char>(base - noise);
+            row[x * 4 + 3] = 255;
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+    std::fclose(file);
+}
+
+// 生成合成模型，返回 OBJ 路径。文件名包含全部参数，同一参数的多次计时共用一份文件
+std::filesystem::path generateSyntheticModel(const BenchOptions& options, const std::filesystem::path& directory, std::string& caseName) {
+    uint32_t side = std::max(2u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(options.verticesPerMesh)))));
+    char name[128];
+    std::snprintf(name, sizeof(name), "synthetic_m%u_v%u_t%u_s%u%s%s", options.meshCount, side * side, options.textureCount,
+        options.textureSize, options.normals ? "_n" : "", options.texCoords ? "_uv" : "");
+    caseName = name;
+
+    std::filesystem::create_directories(directory);
+    std::filesystem::path objPath = directory / (caseName + ".obj");
+    std::filesystem::path mtlPath = directory / (caseName + ".mtl");
+
+    FILE* mtl = std::fopen(mtlPath.string().c_str(), "w");
+    if (!mtl) {
+        throw std::runtime_error("无法创建材质文件: " + mtlPath.string());
+    }
+    for (uint32_t t = 0; t < options.textureCount; t++) {
+        std::filesystem::path texturePath = directory / (caseName + "_" + std::to_string(t) + ".tga");
+        writeTexture(texturePath, options.textureSize, t + 1);
+        // ModelLoader 按材质中的原样路径读取纹理，这里写入绝对路径
+        std::fprintf(mtl, "newmtl material_%u\nKd 1 1 1\nmap_Kd %s\n\n", t, std::filesystem::absolute(texturePath).string().c_str());
+    }
+    std::fclose(mtl);
+
+    FILE* obj = std::fopen(objPath.string().c_str(), "w");
+    if (!obj) {
+        throw std::runtime_error("无法创建模型文件: " + objPath.string());
+    }
+    std::fprintf(obj, "mtllib %s\n", mtlPath.filename().string().c_str());
+    uint64_t baseVertex = 1;  // OBJ 索引从 1 开始，且在所有对象间全局编号
+    for (uint32_t m = 0; m < options.meshCount; m++) {
+        std::fprintf(obj, "o mesh_%u\n", m);
+        if (options.textureCount > 0) {
+            std::fprintf(obj, "usemtl material_%u\n", m % options.textureCount);
+        }
+        // 起伏的网格面 y = a * sin(x) * cos(z)，网格之间沿 x 方向错开
+        const float amplitude = 0.25f;
+        const float scale = 8.0f / static_cast<float>(side - 1);
+        for (uint32_t z = 0; z < side; z++) {
+            for (uint32_t x = 0; x < side; x++) {
+                float px = x * scale;
+                float pz = z * scale;
+                std::fprintf(obj, "v %.5f %.5f %.5f\n", px + m * 9.0f, amplitude * std::sin(px) * std::cos(pz), pz);
+            }
+        }
+        if (options.texCoords) {
+            for (uint32_t z = 0; z < side; z++) {
+                for (uint32_t x = 0; x < side; x++) {
+                    std::fprintf(obj, "vt %.5f %.5f\n", x / static_cast<float>(side - 1), z / static_cast<float>(side - 1));
+                }
+            }
+        }
+        if (options.normals) {
+            for (uint32_t z = 0; z < side; z++) {
+                for (uint32_t x = 0; x < side; x++) {
+                    float px = x * scale;
+                    float pz = z * scale;
+                    float dx = amplitude * std::cos(px) * std::cos(pz);
+                    float dz = -amplitude * std::sin(px) * std::sin(pz);
+                    float length = std::sqrt(dx * dx + 1.0f + dz * dz);
+                    std::fprintf(obj, "vn %.5f %.5f %.5f\n", -dx / length, 1.0f / length, -dz / length);
+                }
+            }
+        }
+        for (uint32_t z = 0; z + 1 < side; z++) {
+            for (uint32_t x = 0; x + 1 < side; x++) {
+                uint64_t i0 = baseVertex + z * side + x;
+                uint64_t i1 = i0 + 1;
+                uint64_t i2 = i0 + side;
+                uint64_t i3 = i2 + 1;
+                const uint64_t quad[2][3] = { { i0, i2, i1 }, { i1, i2, i3 } };
+                for (const auto& triangle : quad) {
+                    std::fputc('f', obj);
+                    for (uint64_t i : triangle) {
+                        unsigned long long index = static_cast<unsigned long long>(i);
+                        if (options.texCoords && options.normals) {
+                            std::fprintf(obj, " %llu/%llu/%llu", index, index, index);
+                        } else if (options.texCoords) {
+                            std::fprintf(obj, " %llu/%llu", index, index);
+                        } else if (options.normals) {
+                            std::fprintf(obj, " %llu//%llu", index, index);
+                        } else {
+                            std::fprintf(obj, " %llu", index);
+                        }
+                    }
+                    std::fputc('\n', obj);
+                }
+            }
+        }
+        baseVertex += static_cast<uint64_t>(side) * side;
+    }
+    std::fclose(obj);
+    return objPath;
+}
+
+// 收集语料：文件直接使用，目录递归查找 Assimp 支持的格式（跳过烘焙缓存）
+std::vector<std::string> collectCorpus(const std::vector<std::string>& inputs) {
+    Assimp::Importer importer;
+    std::vector<std::string> files;
+    auto consider = [&](const std::filesystem::path& path) {
+        std::string extension = path.extension().string();
+        if (extension != ".kskcache" && importer.IsExtensionSupported(extension)) {
+            files.push_back(path.string());
+        }
+    };
+    for (const std::string& input : inputs) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(input, ec)) {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(input, ec)) {
+                if (entry.is_regular_file()) {
+                    consider(entry.path());
+                }
+            }
+        } else {
+            files.push_back(input);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// 用新的 ModelLoader 加载一次，返回分阶段统计
+ModelLoadStats loadOnce(HeadlessDevice& device, JobSystem& jobs, std::mutex& queueMutex, const std::string& path,
+    const ModelLoadOptions& loadOptions) {
+    ModelLoader loader(device.device, device.physicalDevice, device.queue, device.commandPool);
+    AsyncLoadContext context;
+    context.enqueueTask = [&jobs](std::function<void()> task) { jobs.submit(std::move(task), JobPriority::Background); };
+    context.queueMutex = &queueMutex;
+    context.graphicsQueueFamily = device.queueFamily;
+    context.maxSamplerAnisotropy = device.maxSamplerAnisotropy;
+    loader.setAsyncContext(context);
+
+    ModelLoadStats stats;
+    loader.loadModel(path, loadOptions, stats);
+    return stats;
+}
+
+BenchResult runCase(HeadlessDevice& device, JobSystem& jobs, std::mutex& queueMutex, const std::string& name,
+    const std::string& path, const BenchOptions& options) {
+    loadOnce(device, jobs, queueMutex, path, options.loadOptions);  // 预热：文件系统缓存、驱动初始化，开启缓存时生成烘焙缓存
+
+    std::vector<ModelLoadStats> runs;
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        runs.push_back(loadOnce(device, jobs, queueMutex, path, options.loadOptions));
+    }
+    std::sort(runs.begin(), runs.end(), [](const ModelLoadStats& a, const ModelLoadStats& b) { return a.totalMs < b.totalMs; });
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = options.iterations;
+    result.minTotalMs = runs.front().totalMs;
+    result.maxTotalMs = runs.back().totalMs;
+    result.stats = runs[runs.size() / 2];
+    return result;
+}
+
+double perSecond(double amount, double milliseconds) {
+    return milliseconds > 0.0 ? amount / (milliseconds / 1000.0) : 0.0;
+}
+
+// 吞吐：顶点/秒按总耗时计，转换吞吐按网格转换阶段（各任务耗时之和，即单核吞吐）计，
+// 读取 MB/s 按总耗时计，上传 MB/s 按纹理上传、网格上传和提交三个阶段之和计
+struct Throughput {
+    double verticesPerSec;
+    double convertVerticesPerSec;
+    double readMBps;
+    double uploadMBps;
+};
+
+Throughput computeThroughput(const ModelLoadStats& stats) {
+    double uploadMs = stats.textureUploadMs + stats.meshUploadMs + stats.submitMs;
+    return {
+        perSecond(static_cast<double>(stats.vertexCount), stats.totalMs),
+        perSecond(static_cast<double>(stats.vertexCount), stats.meshConvertMs),
+        perSecond(stats.bytesRead / 1e6, stats.totalMs),
+        perSecond(stats.bytesUploaded / 1e6, uploadMs),
+    };
+}
+
+// CSV 字段中的双引号写成两个
+std::string escapeCsv(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"') {
+            escaped += '"';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeJson(FILE* out, const std::string& deviceName, const std::vector<BenchResult>& results) {
+    std::fprintf(out, "{\"device\":\"%s\",\"results\":[", escapeJson(deviceName).c_str());
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        Throughput throughput = computeThroughput(result.stats);
+        std::fprintf(out, "%s\n{\"case\":\"%s\",\"iterations\":%u,\"minTotalMs\":%.3f,\"maxTotalMs\":%.3f,"
+            "\"verticesPerSec\":%.0f,\"convertVerticesPerSec\":%.0f,\"readMBps\":%.2f,\"uploadMBps\":%.2f,\"stats\":%s}",
+            i == 0 ? "" : ",", escapeJson(result.name).c_str(), result.iterations, result.minTotalMs, result.maxTotalMs,
+            throughput.verticesPerSec, throughput.convertVerticesPerSec, throughput.readMBps, throughput.uploadMBps,
+            result.stats.toJson().c_str());
+    }
+    std::fprintf(out, "\n]}\n");
+}
+
+void writeCsv(FILE* out, const std::string& deviceName, const std::vector<BenchResult>& results) {
+    std::fprintf(out, "case,device,iterations,success,from_cache,total_ms,min_total_ms,max_total_ms,import_ms,process_nodes_ms,"
+        "mesh_convert_ms,texture_decode_ms,texture_upload_ms,mesh_upload_ms,submit_ms,bytes_read,bytes_uploaded,meshes,"
+        "vertices,indices,textures,sub_allocations,device_allocations,peak_host_bytes,vertices_per_sec,"
+        "convert_vertices_per_sec,read_mbps,upload_mbps\n");
+    for (const BenchResult& result : results) {
+        const ModelLoadStats& stats = result.stats;
+        Throughput throughput = computeThroughput(stats);
+        std::fprintf(out, "\"%s\",\"%s\",%u,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%llu,%llu,%llu,%llu,"
+            "%llu,%llu,%llu,%.0f,%.0f,%.2f,%.2f\n",
+            escapeCsv(result.name).c_str(), escapeCsv(deviceName).c_str(), result.iterations, stats.success ? 1 : 0, stats.fromCache ? 1 : 0,
+            stats.totalMs, result.minTotalMs, result.maxTotalMs, stats.importMs, stats.processNodesMs, stats.meshConvertMs,
+            stats.textureDecodeMs, stats.textureUploadMs, stats.meshUploadMs, stats.submitMs,
+            static_cast<unsigned long long>(stats.bytesRead), static_cast<unsigned long long>(stats.bytesUploaded),
+            static_cast<unsigned long long>(stats.meshCount), static_cast<unsigned long long>(stats.vertexCount),
+            static_cast<unsigned long long>(stats.indexCount), static_cast<unsigned long long>(stats.textureCount),
+            static_cast<unsigned long long>(stats.subAllocations), static_cast<unsigned long long>(stats.deviceAllocations),
+            static_cast<unsigned long long>(stats.peakHostBytes),
+            throughput.verticesPerSec, throughput.convertVerticesPerSec, throughput.readMBps, throughput.uploadMBps);
+    }
+}
+
+bool parseArguments(int argc, char** argv, BenchOptions& options) {
+    if (argc < 2) {
+        return false;
+    }
+    options.mode = argv[1];
+    if (options.mode != "synthetic" && options.mode != "corpus") {
+        return false;
+    }
+    options.loadOptions.useModelCache = false;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("选项缺少参数: " + arg);
+            }
+            return argv[++i];
+        };
+        auto nextUint = [&]() { return static_cast<uint32_t>(std::strtoul(next(), nullptr, 10)); };
+
+        if (arg == "--meshes") options.meshCount = std::max(nextUint(), 1u);
+        else if (arg == "--vertices") options.verticesPerMesh = nextUint();
+        else if (arg == "--textures") options.textureCount = nextUint();
+        else if (arg == "--texture-size") options.textureSize = std::min(std::max(nextUint(), 1u), 65535u);
+        else if (arg == "--no-normals") options.normals = false;
+        else if (arg == "--no-uvs") options.texCoords = false;
+        else if (arg == "--iterations") options.iterations = std::max(nextUint(), 1u);
+        else if (arg == "--format") options.csv = std::strcmp(next(), "csv") == 0;
+        else if (arg == "--output") options.outputPath = next();
+        else if (arg == "--device") options.deviceName = next();
+        else if (arg == "--cache") options.loadOptions.useModelCache = true;
+        else if (arg == "--unified") options.loadOptions.unifiedGeometry = true;
+        else if (arg == "--compact") options.loadOptions.compactVertices = true;
+        else if (arg == "--no-optimize") options.loadOptions.optimizeMeshes = false;
+        else if (arg == "--lods") options.loadOptions.lodLevels = nextUint();
+        else if (arg.rfind("--", 0) == 0) throw std::runtime_error("未知选项: " + arg);
+        else options.inputs.push_back(arg);
+    }
+    return options.mode == "synthetic" || !options.inputs.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    try {
+        if (!parseArguments(argc, argv, options)) {
+            std::fprintf(stderr, "用法: %s synthetic [选项] | corpus <文件或目录>... [选项]\n", argv[0]);
+            return 2;
+        }
+
+        HeadlessDevice device(options.deviceName);
+        JobSystem jobs(std::thread::hardware_concurrency());
+        std::mutex queueMutex;
+        std::vector<BenchResult> results;
+
+        if (options.mode == "synthetic") {
+            std::filesystem::path directory = std::filesystem::temp_directory_path() / "ModelLoaderBench";
+            std::string caseName;
+            std::filesystem::path path = generateSyntheticModel(options, directory, caseName);
+            results.push_back(runCase(device, jobs, queueMutex, caseName, path.string(), options));
+            std::error_code ec;
+            std::filesystem::remove_all(directory, ec);
+        } else {
+            for (const std::string& path : collectCorpus(options.inputs)) {
+                results.push_back(runCase(device, jobs, queueMutex, path, path, options));
+            }
+        }
+
+        FILE* out = stdout;
+        if (!options.outputPath.empty()) {
+            out = std::fopen(options.outputPath.c_str(), "w");
+            if (!out) {
+                throw std::runtime_error("无法创建结果文件: " + options.outputPath);
+            }
+        }
+        if (options.csv) {
+            writeCsv(out, device.name, results);
+        } else {
+            writeJson(out, device.name, results);
+        }
+        if (out != stdout) {
+            std::fclose(out);
+        }
+
+        for (const BenchResult& result : results) {
+            if (!result.stats.success) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "错误: %s\n", e.what());
+        return 1;
+    }
+}
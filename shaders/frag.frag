@@ -0,0 +1,13 @@
+#version 450
+
+// 两种顶点格式共用的片元着色器，编译为 shaders/frag.spv。按法线方向着色，没有法线的网格为灰色
+
+layout(location = 0) in vec3 fragNormal;
+layout(location = 1) in vec2 fragTexCoords;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec3 normal = dot(fragNormal, fragNormal) > 0.0 ? normalize(fragNormal) : vec3(0.0);
+    outColor = vec4(normal * 0.5 + 0.5, 1.0);
+}
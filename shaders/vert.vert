@@ -0,0 +1,27 @@
+#version 450
+
+// 标准顶点格式（Vertex）的顶点着色器，编译为 shaders/vert.spv。
+// 管线没有描述符和推送常量，实例的世界矩阵直接把顶点变换到裁剪空间
+// （与 RenderManager::setCullingViewProjection 传入单位矩阵时的剔除视锥一致）
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoords;
+layout(location = 3) in vec3 inTangent;
+layout(location = 4) in vec3 inBitangent;
+
+// 绑定 1 上逐实例读取的世界矩阵四列
+layout(location = 7) in vec4 world0;
+layout(location = 8) in vec4 world1;
+layout(location = 9) in vec4 world2;
+layout(location = 10) in vec4 world3;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec2 fragTexCoords;
+
+void main() {
+    mat4 world = mat4(world0, world1, world2, world3);
+    gl_Position = world * vec4(inPosition, 1.0);
+    fragNormal = mat3(world) * inNormal;
+    fragTexCoords = inTexCoords;
+}
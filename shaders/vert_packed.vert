@@ -0,0 +1,36 @@
+#version 450
+
+// 紧凑顶点格式（PackedVertex）的顶点着色器，编译为 shaders/vert_packed.spv。
+// 解码方式见 ModelLoader.h 中 PackedVertex 的说明，输出与 vert.vert 相同
+
+layout(location = 0) in vec4 inPosition;   // UNORM16，w 为副切线符号
+layout(location = 1) in vec2 inNormal;     // 八面体编码，SNORM16
+layout(location = 2) in vec2 inTexCoords;  // 半精度浮点
+layout(location = 3) in vec2 inTangent;    // 八面体编码，SNORM16
+
+// 绑定 1 上逐实例读取的所属网格反量化参数和世界矩阵四列
+layout(location = 5) in vec4 meshScale;
+layout(location = 6) in vec4 meshOffset;
+layout(location = 7) in vec4 world0;
+layout(location = 8) in vec4 world1;
+layout(location = 9) in vec4 world2;
+layout(location = 10) in vec4 world3;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec2 fragTexCoords;
+
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+void main() {
+    mat4 world = mat4(world0, world1, world2, world3);
+    vec3 position = inPosition.xyz * meshScale.xyz + meshOffset.xyz;
+    gl_Position = world * vec4(position, 1.0);
+    fragNormal = mat3(world) * octDecode(inNormal);
+    fragTexCoords = inTexCoords;
+}
@@ -0,0 +1,160 @@
+// 计算剔除测试：在无窗口模式下（CI 上为 lavapipe）绘制实例化的场景，比较 GPU 剔除、CPU 剔除和不剔除三种情况。
+// 顶点着色器直接以世界坐标作为裁剪坐标，剔除视锥取单位矩阵时视锥外的实例本来就不可见，
+// 因此三种情况读回的帧应逐字节相同，GPU 和 CPU 剔除的可见实例数都应等于按场景布局算出的数量。
+// 需要在构建目录中运行（读取 shaders/*.spv）
+
+#include "../vulkanrendener.cpp"
+#include "TestCommon.h"
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 每行 COLUMNS 个实例，偶数列引用网格 0、奇数列引用网格 1；只有中间四列、前三行在裁剪空间内
+constexpr int COLUMNS = 8;
+constexpr int ROWS = 4;
+constexpr uint32_t EXPECTED_VISIBLE = 4 * 3;
+constexpr uint32_t INSTANCE_COUNT = COLUMNS * ROWS;
+
+std::string base64(const std::vector<unsigned char>& bytes) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string result;
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        uint32_t value = static_cast<uint32_t>(bytes[i]) << 16;
+        if (i + 1 < bytes.size()) {
+            value |= static_cast<uint32_t>(bytes[i + 1]) << 8;
+        }
+        if (i + 2 < bytes.size()) {
+            value |= bytes[i + 2];
+        }
+        result += table[(value >> 18) & 63];
+        result += table[(value >> 12) & 63];
+        result += i + 1 < bytes.size() ? table[(value >> 6) & 63] : '=';
+        result += i + 2 < bytes.size() ? table[value & 63] : '=';
+    }
+    return result;
+}
+
+template <typename T>
+void append(std::vector<unsigned char>& bytes, const T& value) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(&value);
+    bytes.insert(bytes.end(), data, data + sizeof(T));
+}
+
+// 两个三角形网格，各被 16 个节点引用。每个网格包含正反两种绕序的同一个三角形，背面剔除后总有一个可见
+void writeScene(const std::string& path) {
+    const float triangles[2][3][3] = {
+        { { -0.08f, -0.08f, 0.5f }, { 0.08f, -0.08f, 0.5f }, { 0.0f, 0.08f, 0.5f } },
+        { { -0.08f, 0.08f, 0.5f }, { 0.08f, 0.08f, 0.5f }, { 0.0f, -0.08f, 0.5f } },
+    };
+    std::vector<unsigned char> buffer;
+    for (const auto& triangle : triangles) {
+        for (const auto& vertex : triangle) {
+            for (float value : vertex) {
+                append(buffer, value);
+            }
+        }
+    }
+    for (uint16_t index : { 0, 1, 2, 0, 2, 1 }) {
+        append(buffer, index);
+    }
+
+    std::string nodes;
+    std::string children;
+    for (int row = 0; row < ROWS; row++) {
+        for (int column = 0; column < COLUMNS; column++) {
+            float x = -1.75f + 0.5f * column;
+            float y = row < 3 ? -0.5f + 0.5f * row : 1.5f;
+            int node = row * COLUMNS + column;
+            nodes += (node ? "," : "") + std::string("{\"mesh\":") + std::to_string(column % 2)
+                + ",\"translation\":[" + std::to_string(x) + "," + std::to_string(y) + ",0]}";
+            children += (node ? "," : "") + std::to_string(node);
+        }
+    }
+
+    std::ofstream(path) << "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,"
+        "\"scenes\":[{\"nodes\":[" << INSTANCE_COUNT << "]}],"
+        "\"nodes\":[" << nodes << ",{\"children\":[" << children << "]}],"
+        "\"meshes\":["
+        "{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":2}]},"
+        "{\"primitives\":[{\"attributes\":{\"POSITION\":1},\"indices\":2}]}],"
+        "\"accessors\":["
+        "{\"bufferView\":0,\"byteOffset\":0,\"componentType\":5126,\"count\":3,\"type\":\"VEC3\","
+        "\"min\":[-0.08,-0.08,0.5],\"max\":[0.08,0.08,0.5]},"
+        "{\"bufferView\":0,\"byteOffset\":36,\"componentType\":5126,\"count\":3,\"type\":\"VEC3\","
+        "\"min\":[-0.08,-0.08,0.5],\"max\":[0.08,0.08,0.5]},"
+        "{\"bufferView\":1,\"componentType\":5123,\"count\":6,\"type\":\"SCALAR\"}],"
+        "\"bufferViews\":["
+        "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":72},"
+        "{\"buffer\":0,\"byteOffset\":72,\"byteLength\":12}],"
+        "\"buffers\":[{\"byteLength\":" << buffer.size() << ",\"uri\":\"data:application/octet-stream;base64,"
+        << base64(buffer) << "\"}]}";
+}
+
+// 绘制 frames 帧并读回最后一帧
+bool drawAndRead(RenderManager& renderer, int frames, std::vector<uint8_t>& pixels) {
+    for (int i = 0; i < frames; i++) {
+        renderer.drawFrame();
+    }
+    uint32_t width = 0;
+    uint32_t height = 0;
+    return renderer.readbackFrame(pixels, width, height);
+}
+
+void testGpuCullingMatchesCpu() {
+    TempDirectory directory("GpuCullingTest");
+    std::string scenePath = directory.file("instances.gltf");
+    writeScene(scenePath);
+
+    RenderManager renderer;
+    renderer.setPipelineCachePath(directory.file("pipeline_cache.bin"));
+    renderer.initHeadless(128, 128);
+    {
+        std::unique_ptr<ModelLoader> loader = renderer.createModelLoader();
+        ModelLoadOptions options;
+        options.unifiedGeometry = true;
+        options.useModelCache = false;
+        CHECK(loader->loadModel(scenePath, options));
+        std::shared_ptr<const ModelDrawData> drawData = loader->getDrawData();
+        CHECK(drawData && drawData->drawCount == 2 && drawData->scene
+            && drawData->scene->instanceMeshes.size() == INSTANCE_COUNT);
+        renderer.setModel(loader.get());
+        renderer.setFrameReadback(true);
+
+        std::vector<uint8_t> unculled;
+        renderer.disableCulling();
+        CHECK(drawAndRead(renderer, 1, unculled));
+        CHECK(renderer.getCullingStats().visible == INSTANCE_COUNT);
+        CHECK(std::any_of(unculled.begin(), unculled.end(), [](uint8_t value) { return value != 0 && value != 255; }));
+
+        std::vector<uint8_t> cpuCulled;
+        renderer.setCullingViewProjection(glm::mat4(1.0f));
+        renderer.setGpuCullingEnabled(false);
+        CHECK(drawAndRead(renderer, 1, cpuCulled));
+        RenderManager::CullingStats cpuStats = renderer.getCullingStats();
+        std::printf("  CPU 剔除: 可见 %u，剔除 %u\n", cpuStats.visible, cpuStats.culled);
+        CHECK(cpuStats.visible == EXPECTED_VISIBLE && cpuStats.culled == INSTANCE_COUNT - EXPECTED_VISIBLE);
+
+        // GPU 剔除的统计取同一帧槽位上一次执行的结果，多绘制几帧使每个槽位都执行过
+        std::vector<uint8_t> gpuCulled;
+        renderer.setGpuCullingEnabled(true);
+        CHECK(drawAndRead(renderer, 4, gpuCulled));
+        RenderManager::CullingStats gpuStats = renderer.getCullingStats();
+        std::printf("  GPU 剔除: 可见 %u，剔除 %u\n", gpuStats.visible, gpuStats.culled);
+        CHECK(renderer.getGpuTimingStats("计算剔除").samples > 0);
+        CHECK(gpuStats.visible == cpuStats.visible && gpuStats.culled == cpuStats.culled);
+
+        CHECK(cpuCulled == unculled);
+        CHECK(gpuCulled == unculled);
+    }
+    renderer.cleanup();
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(testGpuCullingMatchesCpu);
+    return testFailures();
+}
@@ -0,0 +1,57 @@
+// MappedFile 测试：映射内容与文件一致，空文件是有效的零长度映射，不存在的文件打开失败
+
+#include "../MappedFile.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace {
+
+void testMapsContent() {
+    TempDirectory directory("MappedFileTest_content");
+    std::string path = directory.file("data.bin");
+    std::ofstream(path, std::ios::binary) << "mapped";
+
+    MappedFile file;
+    CHECK(file.open(path));
+    CHECK(file.isOpen());
+    CHECK(file.size() == 6 && memcmp(file.data(), "mapped", 6) == 0);
+
+    MappedFile moved(std::move(file));
+    CHECK(!file.isOpen() && file.size() == 0);
+    CHECK(moved.isOpen() && moved.size() == 6);
+    moved.close();
+    CHECK(!moved.isOpen());
+}
+
+void testEmptyFile() {
+    TempDirectory directory("MappedFileTest_empty");
+    std::string path = directory.file("empty.mtl");
+    std::ofstream(path, std::ios::binary);
+
+    MappedFile file;
+    CHECK(file.open(path));
+    CHECK(file.isOpen());
+    CHECK(file.size() == 0);
+    file.prefetch();
+
+    MappedFile moved(std::move(file));
+    CHECK(moved.isOpen() && !file.isOpen());
+}
+
+void testMissingFile() {
+    TempDirectory directory("MappedFileTest_missing");
+    MappedFile file;
+    CHECK(!file.open(directory.file("missing.bin")));
+    CHECK(!file.isOpen());
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(testMapsContent);
+    RUN_TEST(testEmptyFile);
+    RUN_TEST(testMissingFile);
+    return testFailures();
+}
@@ -0,0 +1,134 @@
+// MeshOptimizer 测试：重排只改变三角形顺序（三角形多重集合和绕序不变），并且确实降低 ACMR
+
+#include "../MeshOptimizer.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+struct TestVertex {
+    float position[3];
+};
+
+// (size + 1)^2 个顶点的起伏网格面，三角形顺序随机打乱，模拟导入器输出的无序索引
+void makeShuffledGrid(uint32_t size, uint64_t seed, std::vector<TestVertex>& vertices, std::vector<uint32_t>& indices) {
+    vertices.clear();
+    indices.clear();
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            float height = 0.25f * std::sin(x * 0.7f) * std::cos(y * 0.4f);
+            vertices.push_back({ { static_cast<float>(x), height, static_cast<float>(y) } });
+        }
+    }
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t v0 = y * (size + 1) + x;
+            uint32_t v1 = v0 + 1;
+            uint32_t v2 = v0 + size + 1;
+            uint32_t v3 = v2 + 1;
+            triangles.push_back({ v0, v2, v1 });
+            triangles.push_back({ v1, v2, v3 });
+        }
+    }
+    TestRandom random(seed);
+    for (size_t i = triangles.size(); i > 1; i--) {
+        std::swap(triangles[i - 1], triangles[random.below(static_cast<uint32_t>(i))]);
+    }
+    for (const auto& triangle : triangles) {
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+}
+
+// 把每个三角形旋转到最小索引在前（保持绕序）后排序，用于比较三角形多重集合
+std::vector<std::array<uint32_t, 3>> canonicalTriangles(const uint32_t* indices, size_t indexCount) {
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        std::array<uint32_t, 3> t = { indices[i], indices[i + 1], indices[i + 2] };
+        while (t[0] > t[1] || t[0] > t[2]) {
+            t = { t[1], t[2], t[0] };
+        }
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+void testVertexCachePreservesTriangles() {
+    std::vector<TestVertex> vertices;
+    std::vector<uint32_t> indices;
+    makeShuffledGrid(40, 1, vertices, indices);
+    auto before = canonicalTriangles(indices.data(), indices.size());
+    optimizeVertexCache(indices.data(), indices.size(), vertices.size());
+    CHECK(canonicalTriangles(indices.data(), indices.size()) == before);
+}
+
+void testVertexCacheReducesAcmr() {
+    std::vector<TestVertex> vertices;
+    std::vector<uint32_t> indices;
+    makeShuffledGrid(64, 2, vertices, indices);
+    float acmrBefore = computeACMR(indices.data(), indices.size(), vertices.size());
+    optimizeVertexCache(indices.data(), indices.size(), vertices.size());
+    float acmrAfter = computeACMR(indices.data(), indices.size(), vertices.size());
+    std::printf("  ACMR %.3f -> %.3f\n", acmrBefore, acmrAfter);
+    // 随机顺序的网格面接近每个三角形 3 次未命中，规则网格的理想值约为 0.5
+    CHECK(acmrBefore > 2.5f);
+    CHECK(acmrAfter < 0.8f);
+}
+
+void testOverdrawPreservesTrianglesWithinThreshold() {
+    std::vector<TestVertex> vertices;
+    std::vector<uint32_t> indices;
+    makeShuffledGrid(48, 3, vertices, indices);
+    optimizeVertexCache(indices.data(), indices.size(), vertices.size());
+    auto before = canonicalTriangles(indices.data(), indices.size());
+    float acmrBefore = computeACMR(indices.data(), indices.size(), vertices.size());
+    const float threshold = 1.05f;
+    optimizeOverdraw(indices.data(), indices.size(), vertices[0].position, vertices.size(), sizeof(TestVertex), threshold);
+    CHECK(canonicalTriangles(indices.data(), indices.size()) == before);
+    // 簇边界只放在 ACMR 不超过阈值的位置，簇内顺序不变，整体只因簇边界处缓存被打断而略有变化
+    CHECK(computeACMR(indices.data(), indices.size(), vertices.size()) <= acmrBefore * threshold + 0.05f);
+}
+
+void testVertexFetchRemapsConsistently() {
+    std::vector<TestVertex> vertices;
+    std::vector<uint32_t> indices;
+    makeShuffledGrid(16, 4, vertices, indices);
+    vertices.push_back({ { -1.0f, -1.0f, -1.0f } });  // 未被引用的顶点应被丢弃
+
+    std::vector<std::array<float, 9>> trianglesBefore;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        std::array<float, 9> t;
+        for (int k = 0; k < 3; k++) {
+            std::copy(vertices[indices[i + k]].position, vertices[indices[i + k]].position + 3, t.begin() + 3 * k);
+        }
+        trianglesBefore.push_back(t);
+    }
+    size_t referenced = vertices.size() - 1;
+    optimizeVertexFetch(indices.data(), indices.size(), vertices);
+    CHECK(vertices.size() == referenced);
+
+    // 三角形顺序不变，每个角引用的顶点数据不变，顶点按首次使用顺序排列
+    uint32_t nextNew = 0;
+    for (size_t i = 0; i < indices.size(); i++) {
+        CHECK(indices[i] < vertices.size());
+        CHECK(std::equal(vertices[indices[i]].position, vertices[indices[i]].position + 3, trianglesBefore[i / 3].begin() + 3 * (i % 3)));
+        CHECK(indices[i] <= nextNew);
+        if (indices[i] == nextNew) {
+            nextNew++;
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(testVertexCachePreservesTriangles);
+    RUN_TEST(testVertexCacheReducesAcmr);
+    RUN_TEST(testOverdrawPreservesTrianglesWithinThreshold);
+    RUN_TEST(testVertexFetchRemapsConsistently);
+    return testFailures();
+}
@@ -0,0 +1,94 @@
+// MeshSimplifier 测试：简化结果不含退化三角形、只引用原有顶点，并遵守目标数量和误差上限
+
+#include "../MeshSimplifier.h"
+#include "TestCommon.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// (size + 1)^2 个顶点的网格面，amplitude 为 0 时是平面
+void makeGrid(uint32_t size, float amplitude, std::vector<float>& positions, std::vector<uint32_t>& indices) {
+    positions.clear();
+    indices.clear();
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            positions.push_back(static_cast<float>(x));
+            positions.push_back(amplitude * std::sin(x * 0.5f) * std::sin(y * 0.3f));
+            positions.push_back(static_cast<float>(y));
+        }
+    }
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t v0 = y * (size + 1) + x;
+            uint32_t v1 = v0 + 1;
+            uint32_t v2 = v0 + size + 1;
+            uint32_t v3 = v2 + 1;
+            indices.insert(indices.end(), { v0, v2, v1, v1, v2, v3 });
+        }
+    }
+}
+
+// 检查简化结果的结构：完整三角形、索引在范围内、没有重复角
+void checkTriangles(const std::vector<uint32_t>& result, size_t vertexCount) {
+    CHECK(result.size() % 3 == 0);
+    size_t degenerate = 0;
+    for (size_t i = 0; i + 2 < result.size(); i += 3) {
+        CHECK(result[i] < vertexCount && result[i + 1] < vertexCount && result[i + 2] < vertexCount);
+        if (result[i] == result[i + 1] || result[i + 1] == result[i + 2] || result[i] == result[i + 2]) {
+            degenerate++;
+        }
+    }
+    CHECK(degenerate == 0);
+}
+
+void testFlatGridReachesTarget() {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    makeGrid(32, 0.0f, positions, indices);
+    size_t vertexCount = positions.size() / 3;
+    size_t target = indices.size() / 4 / 3 * 3;
+    std::vector<uint32_t> result;
+    float error = simplifyMesh(indices.data(), indices.size(), positions.data(), vertexCount, sizeof(float) * 3,
+        target, 0.01f, result);
+    checkTriangles(result, vertexCount);
+    // 平面上的折叠没有误差，应能达到目标数量
+    CHECK(result.size() <= target);
+    CHECK(!result.empty());
+    CHECK(error <= 1e-4f);
+}
+
+void testErrorLimitStopsSimplification() {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    makeGrid(32, 2.0f, positions, indices);
+    size_t vertexCount = positions.size() / 3;
+    const float targetError = 0.05f;
+    std::vector<uint32_t> result;
+    float error = simplifyMesh(indices.data(), indices.size(), positions.data(), vertexCount, sizeof(float) * 3,
+        3, targetError, result);
+    checkTriangles(result, vertexCount);
+    CHECK(result.size() < indices.size());
+    CHECK(result.size() > 3);
+    CHECK(error <= targetError);
+}
+
+void testTargetAboveInputKeepsMesh() {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    makeGrid(4, 1.0f, positions, indices);
+    std::vector<uint32_t> result;
+    float error = simplifyMesh(indices.data(), indices.size(), positions.data(), positions.size() / 3, sizeof(float) * 3,
+        indices.size(), 1.0f, result);
+    CHECK(result == indices);
+    CHECK(error == 0.0f);
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(testFlatGridReachesTarget);
+    RUN_TEST(testErrorLimitStopsSimplification);
+    RUN_TEST(testTargetAboveInputKeepsMesh);
+    return testFailures();
+}
@@ -0,0 +1,97 @@
+// MipmapGenerator 测试：与逐像素的 2x2 盒式滤波参考实现逐字节比较。
+// 同一源文件另以 MIPMAP_NO_SIMD 编译为标量版本，两者都与参考一致即说明 SSE2 与标量路径结果相同
+
+#include "../MipmapGenerator.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// 参考实现：奇数边长时最后一行/列与自身平均，四舍五入
+std::vector<unsigned char> referenceDownsample(const std::vector<unsigned char>& src, uint32_t width, uint32_t height) {
+    uint32_t dstWidth = std::max(1u, width / 2);
+    uint32_t dstHeight = std::max(1u, height / 2);
+    std::vector<unsigned char> dst(static_cast<size_t>(dstWidth) * dstHeight * 4);
+    auto texel = [&](uint32_t x, uint32_t y, uint32_t c) -> uint32_t {
+        x = std::min(x, width - 1);
+        y = std::min(y, height - 1);
+        return src[(static_cast<size_t>(y) * width + x) * 4 + c];
+    };
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            for (uint32_t c = 0; c < 4; c++) {
+                uint32_t sum = texel(2 * x, 2 * y, c) + texel(2 * x + 1, 2 * y, c) + texel(2 * x, 2 * y + 1, c) + texel(2 * x + 1, 2 * y + 1, c);
+                dst[(static_cast<size_t>(y) * dstWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) >> 2);
+            }
+        }
+    }
+    return dst;
+}
+
+std::vector<unsigned char> randomImage(uint32_t width, uint32_t height, uint64_t seed) {
+    TestRandom random(seed);
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+    for (auto& value : pixels) {
+        value = static_cast<unsigned char>(random.next());
+    }
+    return pixels;
+}
+
+void testMipLevelCount() {
+    CHECK(mipLevelCount(1, 1) == 1);
+    CHECK(mipLevelCount(2, 1) == 2);
+    CHECK(mipLevelCount(256, 256) == 9);
+    CHECK(mipLevelCount(1024, 3) == 11);
+    CHECK(mipLevelCount(5, 7) == 3);
+}
+
+void testDownsampleMatchesReference() {
+    // 覆盖 SIMD 主循环、奇数边长和只剩标量尾部的情况
+    const uint32_t sizes[][2] = { { 1, 1 }, { 2, 2 }, { 3, 5 }, { 7, 1 }, { 1, 9 }, { 8, 8 }, { 9, 4 }, { 16, 16 },
+        { 33, 17 }, { 64, 3 }, { 255, 2 }, { 130, 66 } };
+    uint64_t seed = 1;
+    for (const auto& size : sizes) {
+        std::vector<unsigned char> src = randomImage(size[0], size[1], seed++);
+        std::vector<unsigned char> expected = referenceDownsample(src, size[0], size[1]);
+        std::vector<unsigned char> actual(expected.size() + 16, 0xCD);  // 末尾多出的字节检查越界写入
+        downsampleRGBA8(src.data(), size[0], size[1], actual.data());
+        CHECK(std::equal(expected.begin(), expected.end(), actual.begin()));
+        CHECK(std::all_of(actual.begin() + expected.size(), actual.end(), [](unsigned char v) { return v == 0xCD; }));
+    }
+}
+
+void testMipChainMatchesReference() {
+    const uint32_t width = 37;
+    const uint32_t height = 20;
+    std::vector<unsigned char> level = randomImage(width, height, 99);
+    std::vector<unsigned char> chain;
+    generateMipChainRGBA8(level.data(), width, height, chain);
+
+    size_t offset = 0;
+    for (uint32_t i = 1, w = width, h = height; i < mipLevelCount(width, height); i++) {
+        level = referenceDownsample(level, w, h);
+        w = std::max(1u, w / 2);
+        h = std::max(1u, h / 2);
+        CHECK(offset + level.size() <= chain.size());
+        if (offset + level.size() <= chain.size()) {
+            CHECK(std::equal(level.begin(), level.end(), chain.begin() + offset));
+        }
+        offset += level.size();
+    }
+    CHECK(offset == chain.size());
+}
+
+}  // namespace
+
+int main() {
+#ifdef MIPMAP_USE_SSE2
+    std::printf("使用 SSE2 路径\n");
+#else
+    std::printf("使用标量路径\n");
+#endif
+    RUN_TEST(testMipLevelCount);
+    RUN_TEST(testDownsampleMatchesReference);
+    RUN_TEST(testMipChainMatchesReference);
+    return testFailures();
+}
@@ -0,0 +1,259 @@
+// ModelCache 测试：写入后读回的数据与原始数据一致，键不匹配或文件损坏时拒绝读取
+
+#include "../ModelCache.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+// 与 Vertex 大小无关，缓存只按 vertexStride 搬运字节
+constexpr uint32_t STRIDE = 12;
+
+struct CacheFixture {
+    TempDirectory directory{ "ModelCacheTest" };
+    std::string sourcePath = directory.file("model.obj");
+    std::vector<float> vertices0;
+    std::vector<uint32_t> indices0;
+    std::vector<float> vertices1;
+    std::vector<uint16_t> indices1;
+    std::vector<uint32_t> instances0 = { 1 };
+    std::vector<uint32_t> instances1 = { 1, 2 };
+    std::vector<MeshDataView> meshes;
+    std::vector<TextureReference> textures;
+    std::vector<SceneNodeData> nodes;
+    std::vector<unsigned char> embedded = { 0x89, 'P', 'N', 'G', 1, 2, 3 };
+
+    CacheFixture() {
+        std::ofstream(sourcePath) << "o model\n";
+        for (int i = 0; i < 4 * 3; i++) {
+            vertices0.push_back(static_cast<float>(i));
+        }
+        indices0 = { 0, 1, 2, 2, 1, 3, 0, 2, 3 };
+        for (int i = 0; i < 3 * 3; i++) {
+            vertices1.push_back(static_cast<float>(100 + i));
+        }
+        indices1 = { 0, 1, 2 };  // 奇数个 16 位索引，检查按 4 字节补齐
+
+        MeshDataView mesh;
+        mesh.vertices = vertices0.data();
+        mesh.vertexCount = 4;
+        mesh.indices = indices0.data();
+        mesh.indexCount = 9;
+        mesh.indexSize = 4;
+        mesh.materialIndex = 0;
+        mesh.boundsMax[0] = 11.0f;
+        mesh.lodCount = 2;
+        mesh.lods[0] = { 0, 6, 0.0f };
+        mesh.lods[1] = { 6, 3, 0.5f };
+        mesh.instanceNodes = instances0.data();
+        mesh.instanceCount = 1;
+        meshes.push_back(mesh);
+
+        mesh = MeshDataView();
+        mesh.vertices = vertices1.data();
+        mesh.vertexCount = 3;
+        mesh.indices = indices1.data();
+        mesh.indexCount = 3;
+        mesh.indexSize = 2;
+        mesh.materialIndex = 1;
+        mesh.instanceNodes = instances1.data();
+        mesh.instanceCount = 2;
+        meshes.push_back(mesh);
+
+        TextureReference texture;
+        texture.typeName = "texture_diffuse";
+        texture.path = "diffuse.png";
+        texture.materialIndex = 1;
+        textures.push_back(texture);
+        texture.typeName = "texture_normal";
+        texture.path = "*0";
+        texture.embeddedData = embedded.data();
+        texture.embeddedSize = embedded.size();
+        textures.push_back(texture);
+
+        nodes.resize(3);
+        nodes[1].parent = 0;
+        nodes[2].parent = 0;
+        nodes[2].localTransform[12] = 5.0f;
+    }
+
+    ModelCacheKey key(uint32_t processFlags = 3, uint64_t processParameters = 0) const {
+        ModelCacheKey result;
+        ModelCache::makeKey(sourcePath, 0x1234, STRIDE, processFlags, processParameters, result);
+        return result;
+    }
+
+    bool write(const ModelCacheKey& cacheKey) const {
+        std::string error;
+        return ModelCache::write(ModelCache::cachePath(sourcePath), cacheKey, meshes, textures, nodes, error);
+    }
+};
+
+bool readCache(const std::string& path, const ModelCacheKey& key, MappedFile& file, std::vector<MeshDataView>& meshes,
+    std::vector<TextureReference>& textures, std::vector<SceneNodeData>& nodes, std::vector<uint32_t>& instanceNodes) {
+    std::string error;
+    return file.open(path) && ModelCache::read(file, key, meshes, textures, nodes, instanceNodes, error);
+}
+
+void testRoundTrip() {
+    CacheFixture fixture;
+    ModelCacheKey key = fixture.key();
+    CHECK(fixture.write(key));
+
+    MappedFile file;
+    std::vector<MeshDataView> meshes;
+    std::vector<TextureReference> textures;
+    std::vector<SceneNodeData> nodes;
+    std::vector<uint32_t> instanceNodes;
+    CHECK(readCache(ModelCache::cachePath(fixture.sourcePath), key, file, meshes, textures, nodes, instanceNodes));
+    CHECK(meshes.size() == 2);
+    if (meshes.size() != 2) {
+        return;
+    }
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const MeshDataView& expected = fixture.meshes[i];
+        const MeshDataView& actual = meshes[i];
+        CHECK(actual.vertexCount == expected.vertexCount);
+        CHECK(actual.indexCount == expected.indexCount);
+        CHECK(actual.indexSize == expected.indexSize);
+        CHECK(actual.materialIndex == expected.materialIndex);
+        CHECK(memcmp(actual.vertices, expected.vertices, expected.vertexCount * STRIDE) == 0);
+        CHECK(memcmp(actual.indices, expected.indices, expected.indexCount * expected.indexSize) == 0);
+        CHECK(memcmp(actual.boundsMin, expected.boundsMin, sizeof(actual.boundsMin)) == 0);
+        CHECK(memcmp(actual.boundsMax, expected.boundsMax, sizeof(actual.boundsMax)) == 0);
+        CHECK(actual.lodCount == expected.lodCount);
+        CHECK(memcmp(actual.lods, expected.lods, sizeof(actual.lods)) == 0);
+        CHECK(actual.instanceCount == expected.instanceCount);
+        CHECK(std::equal(actual.instanceNodes, actual.instanceNodes + actual.instanceCount, expected.instanceNodes));
+        // 顶点和索引数据直接指向映射内存，按 4 字节对齐
+        CHECK(reinterpret_cast<uintptr_t>(actual.indices) % 4 == 0);
+    }
+
+    CHECK(textures.size() == 2);
+    if (textures.size() == 2) {
+        CHECK(textures[0].typeName == "texture_diffuse" && textures[0].path == "diffuse.png" && textures[0].materialIndex == 1);
+        CHECK(textures[0].embeddedData == nullptr);
+        CHECK(textures[1].path == "*0" && textures[1].embeddedSize == fixture.embedded.size());
+        CHECK(textures[1].embeddedData && memcmp(textures[1].embeddedData, fixture.embedded.data(), fixture.embedded.size()) == 0);
+    }
+
+    CHECK(nodes.size() == 3);
+    if (nodes.size() == 3) {
+        CHECK(nodes[0].parent == -1 && nodes[1].parent == 0 && nodes[2].parent == 0);
+        CHECK(nodes[2].localTransform[12] == 5.0f);
+    }
+}
+
+void testKeyMismatchRejected() {
+    CacheFixture fixture;
+    CHECK(fixture.write(fixture.key(3)));
+
+    MappedFile file;
+    std::vector<MeshDataView> meshes;
+    std::vector<TextureReference> textures;
+    std::vector<SceneNodeData> nodes;
+    std::vector<uint32_t> instanceNodes;
+    CHECK(!readCache(ModelCache::cachePath(fixture.sourcePath), fixture.key(1), file, meshes, textures, nodes, instanceNodes));
+    // 处理标志相同但浮点参数（如过度绘制阈值）不同
+    MappedFile file1;
+    CHECK(!readCache(ModelCache::cachePath(fixture.sourcePath), fixture.key(3, 0x5151), file1, meshes, textures, nodes, instanceNodes));
+
+    // 源文件内容变化（大小不同）后键随之变化
+    std::ofstream(fixture.sourcePath, std::ios::app) << "v 0 0 0\n";
+    MappedFile file2;
+    CHECK(!readCache(ModelCache::cachePath(fixture.sourcePath), fixture.key(3), file2, meshes, textures, nodes, instanceNodes));
+}
+
+void testDependencyChangeRejected() {
+    CacheFixture fixture;
+    std::string materialPath = fixture.directory.file("model.mtl");
+    std::ofstream(materialPath) << "newmtl a\n";
+    ModelCacheKey key = fixture.key();
+    CHECK(ModelCache::addDependency(materialPath, key));
+    CHECK(ModelCache::addDependency(materialPath, key));
+    CHECK(key.dependencies.size() == 1);
+    CHECK(!ModelCache::addDependency(fixture.directory.file("missing.bin"), key));
+    CHECK(fixture.write(key));
+
+    std::vector<MeshDataView> meshes;
+    std::vector<TextureReference> textures;
+    std::vector<SceneNodeData> nodes;
+    std::vector<uint32_t> instanceNodes;
+    // 读取时只用源文件生成的键，依赖从缓存文件中取出校验
+    MappedFile file;
+    CHECK(readCache(ModelCache::cachePath(fixture.sourcePath), fixture.key(), file, meshes, textures, nodes, instanceNodes));
+
+    std::ofstream(materialPath, std::ios::app) << "Kd 1 0 0\n";
+    MappedFile file2;
+    CHECK(!readCache(ModelCache::cachePath(fixture.sourcePath), fixture.key(), file2, meshes, textures, nodes, instanceNodes));
+}
+
+void testIndexOutOfRangeRejected() {
+    for (uint32_t mesh = 0; mesh < 2; mesh++) {
+        CacheFixture fixture;
+        // 索引超出网格自己的顶点数量，即使仍在整个顶点数据范围内也应拒绝
+        if (mesh == 0) {
+            fixture.indices0[7] = 4;
+        }
+        else {
+            fixture.indices1[2] = 3;
+        }
+        ModelCacheKey key = fixture.key();
+        CHECK(fixture.write(key));
+
+        MappedFile file;
+        std::vector<MeshDataView> meshes;
+        std::vector<TextureReference> textures;
+        std::vector<SceneNodeData> nodes;
+        std::vector<uint32_t> instanceNodes;
+        CHECK(!readCache(ModelCache::cachePath(fixture.sourcePath), key, file, meshes, textures, nodes, instanceNodes));
+    }
+}
+
+void testCorruptFileRejected() {
+    CacheFixture fixture;
+    ModelCacheKey key = fixture.key();
+    CHECK(fixture.write(key));
+    std::string path = ModelCache::cachePath(fixture.sourcePath);
+    std::vector<char> bytes;
+    {
+        std::ifstream input(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+
+    // 截断
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 4));
+    }
+    MappedFile file;
+    std::vector<MeshDataView> meshes;
+    std::vector<TextureReference> textures;
+    std::vector<SceneNodeData> nodes;
+    std::vector<uint32_t> instanceNodes;
+    CHECK(!readCache(path, key, file, meshes, textures, nodes, instanceNodes));
+
+    // 魔数损坏
+    bytes[0] = 'X';
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    MappedFile file2;
+    CHECK(!readCache(path, key, file2, meshes, textures, nodes, instanceNodes));
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(testRoundTrip);
+    RUN_TEST(testKeyMismatchRejected);
+    RUN_TEST(testDependencyChangeRejected);
+    RUN_TEST(testIndexOutOfRangeRejected);
+    RUN_TEST(testCorruptFileRejected);
+    return testFailures();
+}
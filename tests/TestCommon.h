@@ -0,0 +1,73 @@
+#ifndef TESTCOMMON_H
+#define TESTCOMMON_H
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+// 测试共用的最小断言：失败时输出位置并计数，main 以失败数量作为退出码，由 CTest 判定结果
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #condition); \
+            testFailures()++; \
+        } \
+    } while (0)
+
+// 依次执行测试函数并输出名称，返回值用作进程退出码
+#define RUN_TEST(function) \
+    do { \
+        int failuresBefore = testFailures(); \
+        function(); \
+        std::printf("%s %s\n", testFailures() == failuresBefore ? "通过" : "失败", #function); \
+    } while (0)
+
+// 可复现的伪随机数（不依赖标准库分布的实现）
+struct TestRandom {
+    uint64_t state;
+
+    explicit TestRandom(uint64_t seed) : state(seed * 6364136223846793005ull + 1442695040888963407ull) {}
+
+    uint32_t next() {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<uint32_t>(state >> 33);
+    }
+
+    // [0, bound)
+    uint32_t below(uint32_t bound) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(next()) * bound) >> 31);
+    }
+};
+
+// 测试用的临时目录，析构时删除
+class TempDirectory {
+public:
+    explicit TempDirectory(const std::string& name) {
+        path = std::filesystem::temp_directory_path() / name;
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+        std::filesystem::create_directories(path);
+    }
+
+    ~TempDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    std::string file(const std::string& name) const {
+        return (path / name).string();
+    }
+
+private:
+    std::filesystem::path path;
+};
+
+#endif // TESTCOMMON_H
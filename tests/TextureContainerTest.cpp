@@ -0,0 +1,198 @@
+// TextureContainer 测试：构造最小的 KTX2 / DDS 文件，检查解析出的格式和各级范围，以及对不支持或损坏文件的拒绝
+
+#include "../TextureContainer.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+void put32(std::vector<unsigned char>& bytes, size_t offset, uint32_t value) {
+    if (bytes.size() < offset + 4) {
+        bytes.resize(offset + 4);
+    }
+    memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+void put64(std::vector<unsigned char>& bytes, size_t offset, uint64_t value) {
+    if (bytes.size() < offset + 8) {
+        bytes.resize(offset + 8);
+    }
+    memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+// KTX2 头部 + 层级索引，各级数据从小到大排在索引之后（与 KTX2 的存放顺序相同）
+std::vector<unsigned char> makeKtx2(VkFormat format, uint32_t width, uint32_t height, uint32_t levelCount) {
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    std::vector<unsigned char> bytes(80 + static_cast<size_t>(levelCount) * 24);
+    memcpy(bytes.data(), identifier, sizeof(identifier));
+    put32(bytes, 12, static_cast<uint32_t>(format));
+    put32(bytes, 16, 1);  // typeSize
+    put32(bytes, 20, width);
+    put32(bytes, 24, height);
+    put32(bytes, 28, 0);  // depth
+    put32(bytes, 32, 0);  // layerCount
+    put32(bytes, 36, 1);  // faceCount
+    put32(bytes, 40, levelCount);
+    put32(bytes, 44, 0);  // supercompression
+
+    size_t offset = bytes.size();
+    std::vector<size_t> offsets(levelCount);
+    for (uint32_t level = levelCount; level-- > 0;) {
+        size_t size = compressedLevelSize(format, std::max(1u, width >> level), std::max(1u, height >> level));
+        offsets[level] = offset;
+        offset += size;
+    }
+    bytes.resize(offset, 0x5A);
+    for (uint32_t level = 0; level < levelCount; level++) {
+        size_t size = compressedLevelSize(format, std::max(1u, width >> level), std::max(1u, height >> level));
+        put64(bytes, 80 + level * 24, offsets[level]);
+        put64(bytes, 80 + level * 24 + 8, size);
+        put64(bytes, 80 + level * 24 + 16, size);
+    }
+    return bytes;
+}
+
+// DDS 头部（FourCC 为 DXT1/DXT5 或 DX10 扩展头）+ 各级块数据
+std::vector<unsigned char> makeDds(uint32_t fourCC, uint32_t dxgiFormat, VkFormat format, uint32_t width, uint32_t height,
+    uint32_t levelCount) {
+    const uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000;
+    std::vector<unsigned char> bytes(128);
+    put32(bytes, 0, texture_container_detail::fourCC('D', 'D', 'S', ' '));
+    put32(bytes, 4, 124);
+    put32(bytes, 8, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | (levelCount > 1 ? DDSD_MIPMAPCOUNT : 0));
+    put32(bytes, 12, height);
+    put32(bytes, 16, width);
+    put32(bytes, 28, levelCount);
+    put32(bytes, 76, 32);   // 像素格式结构大小
+    put32(bytes, 80, 0x4);  // DDPF_FOURCC
+    put32(bytes, 84, fourCC);
+    if (fourCC == texture_container_detail::fourCC('D', 'X', '1', '0')) {
+        bytes.resize(148);
+        put32(bytes, 128, dxgiFormat);
+        put32(bytes, 132, 3);  // DDS_DIMENSION_TEXTURE2D
+        put32(bytes, 140, 1);  // arraySize
+    }
+    size_t size = bytes.size();
+    for (uint32_t level = 0; level < levelCount; level++) {
+        size += compressedLevelSize(format, std::max(1u, width >> level), std::max(1u, height >> level));
+    }
+    bytes.resize(size, 0xA5);
+    return bytes;
+}
+
+bool load(const TempDirectory& directory, const std::string& name, const std::vector<unsigned char>& bytes, CompressedImage& image) {
+    std::string path = directory.file(name);
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+    std::string error;
+    return loadCompressedTexture(path, image, error);
+}
+
+void testKtx2Levels() {
+    TempDirectory directory("TextureContainerTest_ktx2");
+    CompressedImage image;
+    CHECK(load(directory, "bc7.ktx2", makeKtx2(VK_FORMAT_BC7_SRGB_BLOCK, 64, 16, 7), image));
+    CHECK(image.format == VK_FORMAT_BC7_SRGB_BLOCK);
+    CHECK(image.width == 64 && image.height == 16);
+    CHECK(image.levels.size() == 7);
+    if (image.levels.size() == 7) {
+        CHECK(image.levels[0].width == 64 && image.levels[0].height == 16 && image.levels[0].size == 16 * 4 * 16);
+        CHECK(image.levels[6].width == 1 && image.levels[6].height == 1 && image.levels[6].size == 16);
+        // 第 0 级存放在最后
+        CHECK(image.levels[0].offset > image.levels[6].offset);
+        CHECK(image.levels[0].offset + image.levels[0].size == image.data.size());
+    }
+}
+
+void testKtx2Rejected() {
+    TempDirectory directory("TextureContainerTest_ktx2_bad");
+    CompressedImage image;
+    CHECK(!load(directory, "rgba.ktx2", makeKtx2(VK_FORMAT_R8G8B8A8_UNORM, 4, 4, 1), image));
+
+    std::vector<unsigned char> truncated = makeKtx2(VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 16, 16, 5);
+    truncated.resize(truncated.size() - 1);
+    CHECK(!load(directory, "truncated.ktx2", truncated, image));
+
+    std::vector<unsigned char> layered = makeKtx2(VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, 8, 1);
+    put32(layered, 32, 6);
+    CHECK(!load(directory, "layered.ktx2", layered, image));
+
+    std::vector<unsigned char> supercompressed = makeKtx2(VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, 8, 1);
+    put32(supercompressed, 44, 2);
+    CHECK(!load(directory, "zstd.ktx2", supercompressed, image));
+
+    std::vector<unsigned char> zeroWidth = makeKtx2(VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, 8, 1);
+    put32(zeroWidth, 20, 0);
+    CHECK(!load(directory, "zero.ktx2", zeroWidth, image));
+
+    // 8x8 最多 4 级
+    std::vector<unsigned char> tooManyLevels = makeKtx2(VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, 8, 4);
+    put32(tooManyLevels, 40, 5);
+    CHECK(!load(directory, "levels.ktx2", tooManyLevels, image));
+}
+
+void testDdsLevels() {
+    TempDirectory directory("TextureContainerTest_dds");
+    CompressedImage image;
+    CHECK(load(directory, "dxt5.DDS", makeDds(texture_container_detail::fourCC('D', 'X', 'T', '5'), 0, VK_FORMAT_BC3_UNORM_BLOCK, 32, 8, 6), image));
+    CHECK(image.format == VK_FORMAT_BC3_UNORM_BLOCK);
+    CHECK(image.levels.size() == 6);
+    if (image.levels.size() == 6) {
+        CHECK(image.levels[0].offset == 128 && image.levels[0].size == 8 * 2 * 16);
+        CHECK(image.levels[5].width == 1 && image.levels[5].height == 1);
+        CHECK(image.levels[5].offset + image.levels[5].size == image.data.size());
+    }
+
+    CHECK(load(directory, "bc7.dds", makeDds(texture_container_detail::fourCC('D', 'X', '1', '0'), 99, VK_FORMAT_BC7_SRGB_BLOCK, 16, 16, 1), image));
+    CHECK(image.format == VK_FORMAT_BC7_SRGB_BLOCK);
+    CHECK(image.levels.size() == 1 && image.levels[0].offset == 148);
+}
+
+void testDdsRejected() {
+    TempDirectory directory("TextureContainerTest_dds_bad");
+    CompressedImage image;
+    std::vector<unsigned char> truncated = makeDds(texture_container_detail::fourCC('D', 'X', 'T', '1'), 0, VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 16, 16, 5);
+    truncated.resize(truncated.size() - 8);
+    CHECK(!load(directory, "truncated.dds", truncated, image));
+
+    CHECK(!load(directory, "dxt3.dds", makeDds(texture_container_detail::fourCC('D', 'X', 'T', '3'), 0, VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, 8, 1), image));
+
+    std::vector<unsigned char> cube = makeDds(texture_container_detail::fourCC('D', 'X', 'T', '1'), 0, VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, 8, 1);
+    put32(cube, 112, 0x200);  // DDSCAPS2_CUBEMAP
+    CHECK(!load(directory, "cube.dds", cube, image));
+
+    for (size_t offset : { 12, 16 }) {
+        std::vector<unsigned char> zeroSize = makeDds(texture_container_detail::fourCC('D', 'X', 'T', '1'), 0, VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, 8, 1);
+        put32(zeroSize, offset, 0);
+        CHECK(!load(directory, "zero.dds", zeroSize, image));
+    }
+
+    std::vector<unsigned char> tooManyLevels = makeDds(texture_container_detail::fourCC('D', 'X', 'T', '1'), 0, VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, 8, 4);
+    put32(tooManyLevels, 28, 5);
+    CHECK(!load(directory, "levels.dds", tooManyLevels, image));
+}
+
+void testDdsMipCountRequiresFlag() {
+    TempDirectory directory("TextureContainerTest_dds_flags");
+    CompressedImage image;
+    // 没有 DDSD_MIPMAPCOUNT 时忽略 dwMipMapCount 中的垃圾值，只读第 0 级
+    std::vector<unsigned char> bytes = makeDds(texture_container_detail::fourCC('D', 'X', 'T', '1'), 0, VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 16, 16, 1);
+    put32(bytes, 28, 0xFFFF);
+    CHECK(load(directory, "noflag.dds", bytes, image));
+    CHECK(image.levels.size() == 1);
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(testKtx2Levels);
+    RUN_TEST(testKtx2Rejected);
+    RUN_TEST(testDdsLevels);
+    RUN_TEST(testDdsRejected);
+    RUN_TEST(testDdsMipCountRequiresFlag);
+    return testFailures();
+}
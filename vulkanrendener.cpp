@@ -5,45 +5,80 @@
 #include <fstream>
 #include <thread>
 #include <functional>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <exception>
 #include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
 #include <GLFW/glfw3.h>  // 使用 GLFW 来创建窗口和表面
+#include "MemoryAllocator.h"
+#include "ModelLoader.h"
+#include "GpuCulling.h"
+#include "PipelineCache.h"
+#include "JobSystem.h"
+#include "GpuProfiler.h"
+
+// 调试构建在安装了 Khronos 验证层时开启验证，发布构建不开启
+const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" };
+#ifdef NDEBUG
+const bool enableValidationLayers = false;
+#else
+const bool enableValidationLayers = true;
+#endif
 
 class RenderManager {
 public:
     void init(GLFWwindow* window) {
         this->window = window;
-        createInstance();
-        setupDebugMessenger();
-        createSurface();
-        createDevice();
-        createSwapChain();
-        createImageViews();
-        createRenderPass();
-        createGraphicsPipeline();
-        createCommandPool();
-        createCommandBuffers();
-        createSemaphores();
-        createFences();
-        setupThreadPool();
+        headless = false;
+        initVulkan();
+    }
+
+    // 无窗口模式：不创建表面和交换链，渲染到离屏颜色/深度图像，用于没有显示器的性能测试。
+    // 只依赖核心 Vulkan，可在 lavapipe 等软件实现上运行；开启 setFrameReadback 后可用 readbackFrame 读回帧
+    void initHeadless(uint32_t width, uint32_t height) {
+        window = nullptr;
+        headless = true;
+        swapChainExtent = { width, height };
+        initVulkan();
     }
 
     void drawFrame() {
-        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        {
+            CpuProfileScope scope(gpuProfiler.get(), "等待栅栏");
+            vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        }
+        runDeferredDestroys(false);
 
-        uint32_t imageIndex;
-        vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphore[currentFrame], VK_NULL_HANDLE, &imageIndex);
+        // 无窗口模式下每个飞行中的帧固定使用一张离屏图像，由该帧的栅栏保护
+        uint32_t imageIndex = static_cast<uint32_t>(currentFrame);
+        if (!headless) {
+            vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphore[currentFrame], VK_NULL_HANDLE, &imageIndex);
+        }
 
         vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
+        // 每帧重新录制命令缓冲区，使新加载的模型能被绘制。栅栏已等待，整池重置该帧的主/二级命令缓冲区
+        {
+            CpuProfileScope scope(gpuProfiler.get(), "录制命令");
+            resetFrameCommandPools(currentFrame);
+            recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+        }
+        CpuProfileScope submitScope(gpuProfiler.get(), "提交呈现");
+
         VkSubmitInfo submitInfo = {};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
+        // 离屏图像不需要等待获取，也没有呈现需要等待渲染完成
         VkSemaphore waitSemaphores[] = { imageAvailableSemaphore[currentFrame] };
         VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.waitSemaphoreCount = headless ? 0 : 1;
         submitInfo.pWaitSemaphores = waitSemaphores;
         submitInfo.pWaitDstStageMask = waitStages;
 
@@ -51,32 +86,51 @@ public:
         submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
 
         VkSemaphore signalSemaphores[] = { renderFinishedSemaphore[currentFrame] };
-        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.signalSemaphoreCount = headless ? 0 : 1;
         submitInfo.pSignalSemaphores = signalSemaphores;
 
+        // 队列与 ModelLoader 的上传共享，提交和呈现都需持锁
+        std::lock_guard<std::mutex> queueLock(queueMutex);
         if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
             throw std::runtime_error("提交命令缓冲区失败！");
         }
 
-        VkPresentInfoKHR presentInfo = {};
-        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-        presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = signalSemaphores;
+        if (!headless) {
+            VkPresentInfoKHR presentInfo = {};
+            presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+            presentInfo.waitSemaphoreCount = 1;
+            presentInfo.pWaitSemaphores = signalSemaphores;
 
-        VkSwapchainKHR swapChains[] = { swapChain };
-        presentInfo.swapchainCount = 1;
-        presentInfo.pSwapchains = swapChains;
-        presentInfo.pImageIndices = &imageIndex;
+            VkSwapchainKHR swapChains[] = { swapChain };
+            presentInfo.swapchainCount = 1;
+            presentInfo.pSwapchains = swapChains;
+            presentInfo.pImageIndices = &imageIndex;
 
-        if (vkQueuePresentKHR(presentQueue, &presentInfo) != VK_SUCCESS) {
-            throw std::runtime_error("交换链呈现失败！");
+            if (vkQueuePresentKHR(presentQueue, &presentInfo) != VK_SUCCESS) {
+                throw std::runtime_error("交换链呈现失败！");
+            }
+        }
+
+        // 首帧耗时从 init 开始计，包含全部管线创建，用于跟踪管线缓存命中与否对启动时间的影响
+        if (frameCounter == 0) {
+            firstFrameMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - initStartTime).count();
+            std::cout << "信息: 首帧耗时 " << firstFrameMilliseconds << " ms（管线缓存"
+                << (pipelineCache->isWarm() ? "命中" : "未命中") << "）" << std::endl;
         }
 
         currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        frameCounter++;
     }
 
     void cleanup() {
+        // 先执行完已提交的加载任务并停止工作线程，之后不会再有线程访问设备资源
+        jobSystem.reset();
         vkDeviceWaitIdle(device);
+        runDeferredDestroys(true);
+
+        for (auto pool : loaderCommandPools) {
+            vkDestroyCommandPool(device, pool, nullptr);
+        }
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             vkDestroySemaphore(device, renderFinishedSemaphore[i], nullptr);
@@ -89,47 +143,346 @@ public:
         }
 
         vkDestroyPipeline(device, graphicsPipeline, nullptr);
+        if (packedPipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, packedPipeline, nullptr);
+        }
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
         vkDestroyRenderPass(device, renderPass, nullptr);
 
         for (auto imageView : swapChainImageViews) {
             vkDestroyImageView(device, imageView, nullptr);
         }
+        vkDestroyImageView(device, depthImageView, nullptr);
+        allocator->destroyImage(depthImage, depthImageAllocation);
+
+        if (headless) {
+            for (size_t i = 0; i < swapChainImages.size(); i++) {
+                allocator->destroyImage(swapChainImages[i], offscreenImageAllocations[i]);
+            }
+            for (size_t i = 0; i < readbackBuffers.size(); i++) {
+                allocator->destroyBuffer(readbackBuffers[i], readbackAllocations[i]);
+            }
+        } else {
+            vkDestroySwapchainKHR(device, swapChain, nullptr);
+        }
+        for (auto& frame : frameCommandPools) {
+            vkDestroyCommandPool(device, frame.primaryPool, nullptr);
+            for (auto pool : frame.secondaryPools) {
+                vkDestroyCommandPool(device, pool, nullptr);
+            }
+        }
+
+        gpuCuller.reset();
+        gpuProfiler.reset();
+        resourceCache.reset();
+        allocator->logStats();
+        allocator.reset();
+
+        std::string cacheError;
+        if (!pipelineCache->save(cacheError)) {
+            std::cerr << "错误: 保存管线缓存失败: " << pipelineCachePath << " (" << cacheError << ")" << std::endl;
+        }
+        pipelineCache.reset();
 
-        vkDestroySwapchainKHR(device, swapChain, nullptr);
-        vkDestroyCommandPool(device, commandPool, nullptr);
         vkDestroyDevice(device, nullptr);
-        vkDestroySurfaceKHR(instance, surface, nullptr);
+        if (surface != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(instance, surface, nullptr);
+        }
+        if (debugMessenger != VK_NULL_HANDLE) {
+            auto destroyDebugMessenger = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
+                vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT"));
+            if (destroyDebugMessenger) {
+                destroyDebugMessenger(instance, debugMessenger, nullptr);
+            }
+        }
         vkDestroyInstance(instance, nullptr);
     }
 
+    // 设备内存子分配器，供 RenderManager 和 ModelLoader 共享
+    DeviceMemoryAllocator* getAllocator() {
+        return allocator.get();
+    }
+
+    // 设置管线缓存文件路径，需在 init 之前调用
+    void setPipelineCachePath(const std::string& path) {
+        pipelineCachePath = path;
+    }
+
+    // 从 init 开始到第一帧呈现的耗时（毫秒），尚未呈现时为 0
+    double getFirstFrameTime() const {
+        return firstFrameMilliseconds;
+    }
+
+    // 是否以无窗口模式初始化
+    bool isHeadless() const {
+        return headless;
+    }
+
+    // 无窗口模式下开启后，每帧在渲染通道结束后把颜色图像复制到该帧的主机可见缓冲区。
+    // 复制有额外开销，纯性能测试时保持关闭
+    void setFrameReadback(bool enabled) {
+        frameReadbackEnabled = enabled && headless;
+    }
+
+    // 读回最近提交的一帧，像素为 RGBA8、逐行紧密排列。会等待该帧在 GPU 上执行完毕；
+    // 不是无窗口模式、还没有提交过帧或该帧录制时未开启读回时返回 false
+    bool readbackFrame(std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height) {
+        if (!headless || frameCounter == 0) {
+            return false;
+        }
+        size_t lastFrame = (currentFrame + MAX_FRAMES_IN_FLIGHT - 1) % MAX_FRAMES_IN_FLIGHT;
+        if (!readbackRecorded[lastFrame]) {
+            return false;
+        }
+        vkWaitForFences(device, 1, &inFlightFences[lastFrame], VK_TRUE, UINT64_MAX);
+
+        width = swapChainExtent.width;
+        height = swapChainExtent.height;
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+        memcpy(pixels.data(), readbackAllocations[lastFrame].mappedData, pixels.size());
+        return true;
+    }
+
+    // 启动时是否读取到了与当前设备匹配的管线缓存
+    bool isPipelineCacheWarm() const {
+        return pipelineCache && pipelineCache->isWarm();
+    }
+
+    // 设置要绘制的模型，下一帧开始生效
+    void setModel(const ModelLoader* model) {
+        this->model = model;
+    }
+
+    // 设置 LOD 选择使用的相机：世界空间位置和垂直视场角（弧度）。未设置时总是绘制原始网格，
+    // 流式纹理总是请求最精细的层级
+    void setLodCamera(const glm::vec3& position, float verticalFov) {
+        lodCameraPosition = position;
+        lodVerticalFov = verticalFov;
+        lodCameraSet = true;
+    }
+
+    // 设置允许的屏幕空间简化误差（像素），越大越早切换到粗糙的 LOD
+    void setLodErrorThreshold(float pixels) {
+        lodErrorThreshold = pixels;
+    }
+
+    // 视锥剔除的统计，drawFrame 每帧更新
+    struct CullingStats {
+        uint32_t visible = 0;  // 提交绘制的实例数量
+        uint32_t culled = 0;   // 被剔除的实例数量
+    };
+
+    // 设置视锥剔除使用的视图投影矩阵（Vulkan 裁剪空间，深度 [0, 1]），之后每帧绘制前按场景包围体层次剔除实例
+    void setCullingViewProjection(const glm::mat4& viewProjection) {
+        cullingFrustum = Frustum::fromMatrix(viewProjection);
+        cullingEnabled = true;
+    }
+
+    // 关闭视锥剔除，绘制全部网格
+    void disableCulling() {
+        cullingEnabled = false;
+    }
+
+    // 是否在有剔除着色器时改用计算着色器剔除共享几何缓冲区中的网格，默认开启。
+    // 需要逐网格选择 LOD 时仍在 CPU 上剔除
+    void setGpuCullingEnabled(bool enabled) {
+        gpuCullingEnabled = enabled;
+    }
+
+    // 最近一帧的剔除统计
+    CullingStats getCullingStats() const {
+        return cullingStats;
+    }
+
+    // 当前模型的流式纹理统计，没有流式纹理时全部为 0
+    TextureStreamingStats getTextureStreamingStats() const {
+        std::shared_ptr<const ModelDrawData> drawData = model ? model->getDrawData() : nullptr;
+        if (!drawData || !drawData->textureStreamer) {
+            return TextureStreamingStats();
+        }
+        return drawData->textureStreamer->getStats();
+    }
+
+    // 各 ModelLoader 共享的资源缓存的命中统计
+    ResourceCacheStats getResourceCacheStats() const {
+        return resourceCache->getStats();
+    }
+
+    // 某个 GPU 区域（"GPU 帧"、"计算剔除"、"渲染通道"，以及模型加载的"上传"、"上传（传输队列）"）最近若干次的耗时统计
+    ProfileStats getGpuTimingStats(const std::string& name) const {
+        return gpuProfiler->getGpuStats(name);
+    }
+
+    // 某个 CPU 区域（"等待栅栏"、"录制命令"、"并行录制"、"提交呈现"）最近若干帧的耗时统计
+    ProfileStats getCpuTimingStats(const std::string& name) const {
+        return gpuProfiler->getCpuStats(name);
+    }
+
+    // 开始或停止捕获 CPU/GPU 时间线
+    void setTraceCapture(bool enabled) {
+        gpuProfiler->setCapture(enabled);
+    }
+
+    // 把捕获的时间线写为 Chrome trace / Perfetto 可读的 JSON
+    bool writeTrace(const std::string& path) {
+        std::string error;
+        if (!gpuProfiler->writeChromeTrace(path, error)) {
+            std::cerr << "警告: " << error << ": " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // 创建接入本渲染器的 ModelLoader：共享内存分配器、资源缓存、工作线程池和队列锁，
+    // 并使用独立的命令池，使异步上传不与帧录制冲突。有独立传输队列时暂存拷贝在其上执行。
+    // 必须在 cleanup 之前销毁
+    std::unique_ptr<ModelLoader> createModelLoader() {
+        uint32_t graphicsFamily = static_cast<uint32_t>(findGraphicsQueueFamily(physicalDevice));
+        VkCommandPool loaderCommandPool = createLoaderCommandPool(graphicsFamily);
+
+        auto loader = std::make_unique<ModelLoader>(device, physicalDevice, graphicsQueue, loaderCommandPool, allocator.get());
+
+        AsyncLoadContext context;
+        context.enqueueTask = [this](std::function<void()> task) { enqueueTask(std::move(task)); };
+        context.deferDestroy = [this](std::function<void()> destroy) { deferDestroy(std::move(destroy)); };
+        context.queueMutex = &queueMutex;
+        context.graphicsQueueFamily = graphicsFamily;
+        context.maxSamplerAnisotropy = maxSamplerAnisotropy;
+        context.textureMemoryBudget = queryTextureBudget();
+        context.resourceCache = resourceCache;
+        context.profiler = gpuProfiler.get();
+        if (transferQueue != VK_NULL_HANDLE) {
+            context.transferQueue.queue = transferQueue;
+            context.transferQueue.familyIndex = static_cast<uint32_t>(transferQueueFamily);
+            context.transferQueue.commandPool = createLoaderCommandPool(context.transferQueue.familyIndex);
+            context.transferQueue.mutex = &transferQueueMutex;
+        }
+        loader->setAsyncContext(context);
+        return loader;
+    }
+
+    // 流式纹理的默认显存预算：最大的设备本地堆剩余空间的一半。支持 VK_EXT_memory_budget 时按驱动给出的
+    // 预算减去当前用量计算（包含其他进程的占用），否则按堆大小
+    VkDeviceSize queryTextureBudget() {
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+        budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        bool hasBudget = false;
+        if (memoryBudgetSupported) {
+            auto getMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(
+                vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+            if (getMemoryProperties2) {
+                VkPhysicalDeviceMemoryProperties2KHR properties2 = {};
+                properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+                properties2.pNext = &budgetProperties;
+                getMemoryProperties2(physicalDevice, &properties2);
+                memoryProperties = properties2.memoryProperties;
+                hasBudget = true;
+            }
+        }
+        if (!hasBudget) {
+            vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+        }
+
+        VkDeviceSize available = 0;
+        for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+            if (!(memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) {
+                continue;
+            }
+            VkDeviceSize heapAvailable = memoryProperties.memoryHeaps[i].size;
+            if (hasBudget) {
+                heapAvailable = budgetProperties.heapBudget[i] > budgetProperties.heapUsage[i]
+                    ? budgetProperties.heapBudget[i] - budgetProperties.heapUsage[i] : 0;
+            }
+            available = std::max(available, heapAvailable);
+        }
+        return available / 2;
+    }
+
+    // 为 ModelLoader 创建短期命令缓冲区使用的命令池，在 cleanup 中统一销毁
+    VkCommandPool createLoaderCommandPool(uint32_t queueFamily) {
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = queueFamily;
+
+        VkCommandPool loaderCommandPool;
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &loaderCommandPool) != VK_SUCCESS) {
+            throw std::runtime_error("创建命令池失败！");
+        }
+        loaderCommandPools.push_back(loaderCommandPool);
+        return loaderCommandPool;
+    }
+
+    // 投递后台任务（模型加载、上传）到任务系统
+    void enqueueTask(std::function<void()> task) {
+        jobSystem->submit(std::move(task), JobPriority::Background);
+    }
+
+    // 延迟销毁：等当前已录制的帧全部执行完后再调用
+    void deferDestroy(std::function<void()> destroy) {
+        std::lock_guard<std::mutex> lock(destroyMutex);
+        pendingDestroys.emplace_back(frameCounter, std::move(destroy));
+    }
+
 private:
-    VkInstance instance;
-    VkDebugUtilsMessengerEXT debugMessenger;
-    VkDevice device;
-    VkQueue graphicsQueue;
-    VkQueue presentQueue;
-    VkSwapchainKHR swapChain;
-    VkFormat swapChainImageFormat;
-    VkExtent2D swapChainExtent;
-    std::vector<VkImageView> swapChainImageViews;
-    VkRenderPass renderPass;
-    VkPipeline graphicsPipeline;
-    VkPipelineLayout pipelineLayout;
-    VkCommandPool commandPool;
-    std::vector<VkCommandBuffer> commandBuffers;
-    std::vector<VkFramebuffer> swapChainFramebuffers;
-    std::vector<VkSemaphore> imageAvailableSemaphore;
-    std::vector<VkSemaphore> renderFinishedSemaphore;
-    std::vector<VkFence> inFlightFences;
-    size_t currentFrame = 0;
-    const size_t MAX_FRAMES_IN_FLIGHT = 2;
-    std::vector<std::thread> threadPool;
-    std::queue<std::function<void()>> resourceTasks;
-    std::mutex resourceMutex;
-    std::condition_variable resourceCondition;
-    GLFWwindow* window;
-    VkSurfaceKHR surface;
+    struct SwapChainSupportDetails {
+        VkSurfaceCapabilitiesKHR capabilities;
+        std::vector<VkSurfaceFormatKHR> formats;
+        std::vector<VkPresentModeKHR> presentModes;
+    };
+
+    // 一帧的绘制方式，由 planDraws 确定
+    enum class DrawMode {
+        None,       // 没有可绘制的内容
+        Indirect,   // 共享几何缓冲区，一次间接绘制
+        GpuCulled,  // 共享几何缓冲区，绘制计算剔除的输出
+        Direct,     // 共享几何缓冲区，逐个直接绘制 visibleDraws
+        PerMesh     // 逐网格缓冲区，逐个绑定并绘制 visibleDraws
+    };
+
+    // 一次实例化绘制：网格 mesh 的实例 [firstInstance, firstInstance + instanceCount)
+    struct VisibleDraw {
+        uint32_t mesh;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+    };
+
+    // 一个飞行中帧的命令池：主命令池和每个录制线程各自的二级命令池，每个池只分配一个命令缓冲区
+    struct FrameCommandPools {
+        VkCommandPool primaryPool = VK_NULL_HANDLE;
+        std::vector<VkCommandPool> secondaryPools;
+        std::vector<VkCommandBuffer> secondaries;
+    };
+
+    // 窗口模式和无窗口模式共用的初始化，区别只在表面、交换链和渲染目标
+    void initVulkan() {
+        initStartTime = std::chrono::steady_clock::now();
+        createInstance();
+        setupDebugMessenger();
+        if (!headless) {
+            createSurface();
+        }
+        createDevice();
+        createAllocator();
+        createPipelineCache();
+        if (headless) {
+            createOffscreenTargets();
+        } else {
+            createSwapChain();
+        }
+        createImageViews();
+        createDepthResources();
+        createRenderPass();
+        createFramebuffers();
+        createGraphicsPipeline();
+        setupThreadPool();
+        createCommandPool();
+        createGpuCuller();
+        createGpuProfiler();
+        createCommandBuffers();
+        createSemaphores();
+    }
 
     void createInstance() {
         VkApplicationInfo appInfo = {};
@@ -144,13 +497,17 @@ private:
         createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
         createInfo.pApplicationInfo = &appInfo;
 
-        uint32_t extensionCount = 0;
-        const char** extensions = getRequiredExtensions(&extensionCount);
-        createInfo.enabledExtensionCount = extensionCount;
-        createInfo.ppEnabledExtensionNames = extensions;
+        validationEnabled = enableValidationLayers && isLayerSupported(validationLayers[0]);
+        if (enableValidationLayers && !validationEnabled) {
+            std::cerr << "警告: 未安装 " << validationLayers[0] << "，不开启验证层" << std::endl;
+        }
+
+        std::vector<const char*> extensions = getRequiredExtensions();
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames = extensions.data();
 
         VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo;
-        if (enableValidationLayers) {
+        if (validationEnabled) {
             createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
             createInfo.ppEnabledLayerNames = validationLayers.data();
 
@@ -166,13 +523,29 @@ private:
         }
     }
 
+    bool isLayerSupported(const char* layerName) {
+        uint32_t layerCount = 0;
+        vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+        std::vector<VkLayerProperties> layers(layerCount);
+        vkEnumerateInstanceLayerProperties(&layerCount, layers.data());
+        for (const auto& layer : layers) {
+            if (strcmp(layer.layerName, layerName) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // debug utils 是实例扩展，入口需要从实例查询
     void setupDebugMessenger() {
-        if (!enableValidationLayers) return;
+        if (!validationEnabled) return;
 
         VkDebugUtilsMessengerCreateInfoEXT createInfo;
         populateDebugMessengerCreateInfo(createInfo);
 
-        if (vkCreateDebugUtilsMessengerEXT(instance, &createInfo, nullptr, &debugMessenger) != VK_SUCCESS) {
+        auto createDebugMessenger = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(
+            vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT"));
+        if (!createDebugMessenger || createDebugMessenger(instance, &createInfo, nullptr, &debugMessenger) != VK_SUCCESS) {
             throw std::runtime_error("创建调试 messenger 失败！");
         }
     }
@@ -184,23 +557,74 @@ private:
     }
 
     void createDevice() {
-        VkPhysicalDevice physicalDevice = pickPhysicalDevice();
+        physicalDevice = pickPhysicalDevice();
+
+        // 图形、呈现和传输队列族各创建一个队列，相同的队列族只创建一次
+        uint32_t graphicsFamily = static_cast<uint32_t>(findGraphicsQueueFamily(physicalDevice));
+        uint32_t presentFamily = static_cast<uint32_t>(findPresentQueueFamily(physicalDevice));
+        transferQueueFamily = findTransferQueueFamily(physicalDevice);
+        if (transferQueueFamily >= 0 && static_cast<uint32_t>(transferQueueFamily) == presentFamily) {
+            transferQueueFamily = -1;  // 呈现队列由渲染线程独占提交，不与上传共用
+        }
+
+        std::vector<uint32_t> queueFamilies = { graphicsFamily };
+        if (presentFamily != graphicsFamily) {
+            queueFamilies.push_back(presentFamily);
+        }
+        if (transferQueueFamily >= 0) {
+            queueFamilies.push_back(static_cast<uint32_t>(transferQueueFamily));
+        }
 
-        VkDeviceQueueCreateInfo queueCreateInfo = {};
-        queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        queueCreateInfo.queueFamilyIndex = findGraphicsQueueFamily(physicalDevice);
-        queueCreateInfo.queueCount = 1;
         float queuePriority = 1.0f;
-        queueCreateInfo.pQueuePriorities = &queuePriority;
+        std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+        for (uint32_t queueFamily : queueFamilies) {
+            VkDeviceQueueCreateInfo queueCreateInfo = {};
+            queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueCreateInfo.queueFamilyIndex = queueFamily;
+            queueCreateInfo.queueCount = 1;
+            queueCreateInfo.pQueuePriorities = &queuePriority;
+            queueCreateInfos.push_back(queueCreateInfo);
+        }
 
         VkDeviceCreateInfo createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        createInfo.queueCreateInfoCount = 1;
-        createInfo.pQueueCreateInfos = &queueCreateInfo;
+        createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
+        createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
+        // 支持时开启 multiDrawIndirect，共享几何缓冲区可以一次间接绘制所有网格
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
         VkPhysicalDeviceFeatures deviceFeatures = {};
+        deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+        multiDrawIndirectSupported = supportedFeatures.multiDrawIndirect == VK_TRUE;
+        // 间接绘制命令用 firstInstance 指向网格在实例缓冲区中的首个实例
+        deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+        drawIndirectFirstInstanceSupported = supportedFeatures.drawIndirectFirstInstance == VK_TRUE;
+        // 支持时开启各向异性过滤，ModelLoader 按设备上限创建纹理采样器
+        deviceFeatures.samplerAnisotropy = supportedFeatures.samplerAnisotropy;
+        if (supportedFeatures.samplerAnisotropy) {
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+            maxSamplerAnisotropy = properties.limits.maxSamplerAnisotropy;
+        }
         createInfo.pEnabledFeatures = &deviceFeatures;
 
+        // GPU 剔除压缩后的命令数量由设备写入，支持 VK_KHR_draw_indirect_count 时直接按该数量绘制
+        std::vector<const char*> deviceExtensions;
+        if (!headless) {
+            deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
+        drawIndirectCountSupported = multiDrawIndirectSupported
+            && isDeviceExtensionSupported(physicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        if (drawIndirectCountSupported) {
+            deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        }
+        // 流式纹理按 VK_EXT_memory_budget 给出的剩余显存确定默认预算
+        memoryBudgetSupported = memoryProperties2Supported
+            && isDeviceExtensionSupported(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (memoryBudgetSupported) {
+            deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
         createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
         createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
@@ -208,8 +632,72 @@ private:
             throw std::runtime_error("创建逻辑设备失败！");
         }
 
-        vkGetDeviceQueue(device, findGraphicsQueueFamily(physicalDevice), 0, &graphicsQueue);
-        vkGetDeviceQueue(device, findPresentQueueFamily(physicalDevice), 0, &presentQueue);
+        if (drawIndirectCountSupported) {
+            cmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+            drawIndirectCountSupported = cmdDrawIndexedIndirectCount != nullptr;
+        }
+
+        vkGetDeviceQueue(device, graphicsFamily, 0, &graphicsQueue);
+        vkGetDeviceQueue(device, presentFamily, 0, &presentQueue);
+        if (transferQueueFamily >= 0) {
+            vkGetDeviceQueue(device, static_cast<uint32_t>(transferQueueFamily), 0, &transferQueue);
+        }
+    }
+
+    bool isInstanceExtensionSupported(const char* extensionName) {
+        uint32_t extensionCount = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+        for (const auto& extension : extensions) {
+            if (strcmp(extension.extensionName, extensionName) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isDeviceExtensionSupported(VkPhysicalDevice device, const char* extensionName) {
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+        for (const auto& extension : extensions) {
+            if (strcmp(extension.extensionName, extensionName) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 有编译好的剔除着色器时创建 GPU 剔除，否则视锥剔除在 CPU 上执行
+    void createGpuCuller() {
+        if (!std::ifstream("shaders/cull.spv", std::ios::binary)) {
+            std::cerr << "警告: 缺少 shaders/cull.spv，视锥剔除将在 CPU 上执行" << std::endl;
+            return;
+        }
+        std::vector<char> shaderCode;
+        readFile("shaders/cull.spv", shaderCode);
+        gpuCuller = std::make_unique<GpuCuller>(device, allocator.get(), pipelineCache->get(),
+            static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT), shaderCode, drawIndirectCountSupported);
+    }
+
+    // 图形队列不支持时间戳时分析器只记录 CPU 区域
+    void createGpuProfiler() {
+        uint32_t graphicsFamily = static_cast<uint32_t>(findGraphicsQueueFamily(physicalDevice));
+        gpuProfiler = std::make_unique<GpuProfiler>(device, physicalDevice, graphicsFamily, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT));
+    }
+
+    void createAllocator() {
+        allocator = std::make_unique<DeviceMemoryAllocator>(device, physicalDevice);
+        resourceCache = std::make_shared<ResourceCache>(device, allocator.get(),
+            [this](std::function<void()> destroy) { deferDestroy(std::move(destroy)); });
+    }
+
+    // 从磁盘读取管线缓存，文件不存在或与当前设备/驱动不匹配时从空缓存开始
+    void createPipelineCache() {
+        pipelineCache = std::make_unique<PersistentPipelineCache>(device, physicalDevice, pipelineCachePath);
     }
 
     VkPhysicalDevice pickPhysicalDevice() {
@@ -256,7 +744,37 @@ private:
         return -1;
     }
 
+    // 查找只支持传输、不支持图形的队列族（通常对应独立的 DMA 引擎），优先不带计算能力的，没有则返回 -1
+    int findTransferQueueFamily(VkPhysicalDevice device) {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+
+        int candidate = -1;
+        int i = 0;
+        for (const auto& queueFamily : queueFamilies) {
+            if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+                if (!(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)) {
+                    return i;
+                }
+                if (candidate < 0) {
+                    candidate = i;
+                }
+            }
+            i++;
+        }
+
+        return candidate;
+    }
+
+    // 无窗口模式没有表面，"呈现"队列就是图形队列
     int findPresentQueueFamily(VkPhysicalDevice device) {
+        if (headless) {
+            return findGraphicsQueueFamily(device);
+        }
+
         uint32_t queueFamilyCount = 0;
         vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
 
@@ -277,7 +795,7 @@ private:
     }
 
     void createSwapChain() {
-        SwapChainSupportDetails swapChainSupport = querySwapChainSupport(pickPhysicalDevice());
+        SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
 
         VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
         VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
@@ -299,10 +817,10 @@ private:
         createInfo.imageArrayLayers = 1;
         createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
-        VkQueueFamilyIndices indices = findQueueFamilies(pickPhysicalDevice());
-        uint32_t queueFamilyIndices[] = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+        uint32_t queueFamilyIndices[] = { static_cast<uint32_t>(findGraphicsQueueFamily(physicalDevice)),
+            static_cast<uint32_t>(findPresentQueueFamily(physicalDevice)) };
 
-        if (indices.graphicsFamily != indices.presentFamily) {
+        if (queueFamilyIndices[0] != queueFamilyIndices[1]) {
             createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
             createInfo.queueFamilyIndexCount = 2;
             createInfo.pQueueFamilyIndices = queueFamilyIndices;
@@ -354,6 +872,103 @@ private:
         }
     }
 
+    // 无窗口模式：每个飞行中的帧一张离屏颜色图像，可作为复制源以便读回，另配一个主机可见的读回缓冲区
+    void createOffscreenTargets() {
+        swapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+        swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+        offscreenImageAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+        readbackBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+        readbackAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+        readbackRecorded.assign(MAX_FRAMES_IN_FLIGHT, false);
+
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = swapChainImageFormat;
+        imageInfo.extent = { swapChainExtent.width, swapChainExtent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VkDeviceSize readbackSize = static_cast<VkDeviceSize>(swapChainExtent.width) * swapChainExtent.height * 4;
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            allocator->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, swapChainImages[i], offscreenImageAllocations[i]);
+            allocator->createBuffer(readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                readbackBuffers[i], readbackAllocations[i]);
+        }
+    }
+
+    // 所有帧共用一个深度缓冲区，帧之间的写后写由渲染通道的外部依赖保证顺序
+    void createDepthResources() {
+        depthFormat = findDepthFormat();
+
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = depthFormat;
+        imageInfo.extent = { swapChainExtent.width, swapChainExtent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        allocator->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImage, depthImageAllocation);
+
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = depthImage;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = depthFormat;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &depthImageView) != VK_SUCCESS) {
+            throw std::runtime_error("创建深度图像视图失败！");
+        }
+    }
+
+    // 选择设备支持的深度格式，D32_SFLOAT 和 D24_UNORM_S8_UINT 至少有一个是规范要求必须支持的
+    VkFormat findDepthFormat() {
+        const VkFormat candidates[] = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT };
+        for (VkFormat format : candidates) {
+            VkFormatProperties properties;
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+            if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+                return format;
+            }
+        }
+        throw std::runtime_error("没有找到支持的深度格式！");
+    }
+
+    void createFramebuffers() {
+        swapChainFramebuffers.resize(swapChainImageViews.size());
+        for (size_t i = 0; i < swapChainImageViews.size(); i++) {
+            VkImageView attachments[] = { swapChainImageViews[i], depthImageView };
+
+            VkFramebufferCreateInfo framebufferInfo = {};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = renderPass;
+            framebufferInfo.attachmentCount = 2;
+            framebufferInfo.pAttachments = attachments;
+            framebufferInfo.width = swapChainExtent.width;
+            framebufferInfo.height = swapChainExtent.height;
+            framebufferInfo.layers = 1;
+
+            if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &swapChainFramebuffers[i]) != VK_SUCCESS) {
+                throw std::runtime_error("创建帧缓冲失败！");
+            }
+        }
+    }
+
     void createRenderPass() {
         VkAttachmentDescription colorAttachment = {};
         colorAttachment.format = swapChainImageFormat;
@@ -363,23 +978,57 @@ private:
         colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        // 离屏图像在渲染通道结束时转为复制源，供读回使用
+        colorAttachment.finalLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        VkAttachmentDescription depthAttachment = {};
+        depthAttachment.format = depthFormat;
+        depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
         VkAttachmentReference colorAttachmentRef = {};
         colorAttachmentRef.attachment = 0;
         colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+        VkAttachmentReference depthAttachmentRef = {};
+        depthAttachmentRef.attachment = 1;
+        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
         VkSubpassDescription subpass = {};
         subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
         subpass.colorAttachmentCount = 1;
         subpass.pColorAttachments = &colorAttachmentRef;
-
+        subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+        // 进入：排在上一帧写共享深度缓冲区和等待交换链图像之后。离开：无窗口模式下读回复制要等颜色写入完成
+        VkSubpassDependency dependencies[2] = {};
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass = 0;
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[1].srcSubpass = 0;
+        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        VkAttachmentDescription attachments[] = { colorAttachment, depthAttachment };
         VkRenderPassCreateInfo renderPassInfo = {};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderPassInfo.attachmentCount = 1;
-        renderPassInfo.pAttachments = &colorAttachment;
+        renderPassInfo.attachmentCount = 2;
+        renderPassInfo.pAttachments = attachments;
         renderPassInfo.subpassCount = 1;
         renderPassInfo.pSubpasses = &subpass;
+        renderPassInfo.dependencyCount = headless ? 2 : 1;
+        renderPassInfo.pDependencies = dependencies;
 
         if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
             throw std::runtime_error("创建渲染通道失败！");
@@ -387,8 +1036,54 @@ private:
     }
 
     void createGraphicsPipeline() {
-        auto vertShaderCode = readFile("shaders/vert.spv");
-        auto fragShaderCode = readFile("shaders/frag.spv");
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 0;
+        pipelineLayoutInfo.pSetLayouts = nullptr;
+        pipelineLayoutInfo.pushConstantRangeCount = 0;
+        pipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("创建管线布局失败！");
+        }
+
+        auto bindingDescriptions = Vertex::getBindingDescriptions();
+        auto attributeDescriptions = Vertex::getAttributeDescriptions();
+
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+        vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+        vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+        graphicsPipeline = createPipeline("shaders/vert.spv", vertexInputInfo);
+
+        // 紧凑顶点格式需要解码量化属性的顶点着色器，没有编译该着色器时不创建，使用紧凑格式的模型不会被绘制
+        if (!std::ifstream("shaders/vert_packed.spv", std::ios::binary)) {
+            std::cerr << "警告: 缺少 shaders/vert_packed.spv，紧凑顶点格式的模型将不会被绘制" << std::endl;
+            return;
+        }
+
+        auto packedBindingDescriptions = PackedVertex::getBindingDescriptions();
+        auto packedAttributeDescriptions = PackedVertex::getAttributeDescriptions();
+
+        VkPipelineVertexInputStateCreateInfo packedVertexInputInfo = {};
+        packedVertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        packedVertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(packedBindingDescriptions.size());
+        packedVertexInputInfo.pVertexBindingDescriptions = packedBindingDescriptions.data();
+        packedVertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(packedAttributeDescriptions.size());
+        packedVertexInputInfo.pVertexAttributeDescriptions = packedAttributeDescriptions.data();
+
+        packedPipeline = createPipeline("shaders/vert_packed.spv", packedVertexInputInfo);
+    }
+
+    // 用给定的顶点着色器和顶点输入创建图形管线，其余状态所有管线相同
+    VkPipeline createPipeline(const std::string& vertShaderPath, const VkPipelineVertexInputStateCreateInfo& vertexInputInfo) {
+        std::vector<char> vertShaderCode;
+        std::vector<char> fragShaderCode;
+        readFile(vertShaderPath, vertShaderCode);
+        readFile("shaders/frag.spv", fragShaderCode);
 
         VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
         VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
@@ -407,11 +1102,6 @@ private:
 
         VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
 
-        VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputInfo.vertexAttributeDescriptionCount = 0;
-        vertexInputInfo.vertexBindingDescriptionCount = 0;
-
         VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
         inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
         inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
@@ -437,6 +1127,14 @@ private:
         multisampling.sampleShadingEnable = VK_FALSE;
         multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 
+        VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencil.depthTestEnable = VK_TRUE;
+        depthStencil.depthWriteEnable = VK_TRUE;
+        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+        depthStencil.depthBoundsTestEnable = VK_FALSE;
+        depthStencil.stencilTestEnable = VK_FALSE;
+
         VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
         colorBlendAttachment.blendEnable = VK_FALSE;
         colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
@@ -448,16 +1146,12 @@ private:
         colorBlending.attachmentCount = 1;
         colorBlending.pAttachments = &colorBlendAttachment;
 
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 0;
-        pipelineLayoutInfo.pSetLayouts = nullptr;
-        pipelineLayoutInfo.pushConstantRangeCount = 0;
-        pipelineLayoutInfo.pPushConstantRanges = nullptr;
-
-        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-            throw std::runtime_error("创建管线布局失败！");
-        }
+        // 视口和裁剪区域在录制时设置
+        VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+        VkPipelineDynamicStateCreateInfo dynamicState = {};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = 2;
+        dynamicState.pDynamicStates = dynamicStates;
 
         VkGraphicsPipelineCreateInfo pipelineInfo = {};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -468,20 +1162,23 @@ private:
         pipelineInfo.pViewportState = &viewportState;
         pipelineInfo.pRasterizationState = &rasterizer;
         pipelineInfo.pMultisampleState = &multisampling;
+        pipelineInfo.pDepthStencilState = &depthStencil;
         pipelineInfo.pColorBlendState = &colorBlending;
-        pipelineInfo.pDynamicState = nullptr;
+        pipelineInfo.pDynamicState = &dynamicState;
         pipelineInfo.layout = pipelineLayout;
         pipelineInfo.renderPass = renderPass;
         pipelineInfo.subpass = 0;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
         pipelineInfo.basePipelineIndex = -1;
 
-        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+        VkPipeline pipeline;
+        if (vkCreateGraphicsPipelines(device, pipelineCache->get(), 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
             throw std::runtime_error("创建图形管线失败！");
         }
 
         vkDestroyShaderModule(device, fragShaderModule, nullptr);
         vkDestroyShaderModule(device, vertShaderModule, nullptr);
+        return pipeline;
     }
 
     VkShaderModule createShaderModule(const std::vector<char>& code) {
@@ -498,60 +1195,461 @@ private:
         return shaderModule;
     }
 
+    // 每个飞行中的帧一个主命令池，外加每个录制线程（工作线程和渲染线程）一个二级命令池。
+    // 池在该帧栅栏等待后整体重置而不是逐个释放命令缓冲区；同一个池只被一个线程使用，不需要加锁
     void createCommandPool() {
         VkCommandPoolCreateInfo poolInfo = {};
         poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-        poolInfo.queueFamilyIndex = findGraphicsQueueFamily(pickPhysicalDevice());
-
-        if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
-            throw std::runtime_error("创建命令池失败！");
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = static_cast<uint32_t>(findGraphicsQueueFamily(physicalDevice));
+
+        size_t recordingThreads = jobSystem->getWorkerCount() + 1;
+        frameCommandPools.resize(MAX_FRAMES_IN_FLIGHT);
+        for (auto& frame : frameCommandPools) {
+            if (vkCreateCommandPool(device, &poolInfo, nullptr, &frame.primaryPool) != VK_SUCCESS) {
+                throw std::runtime_error("创建命令池失败！");
+            }
+            frame.secondaryPools.resize(recordingThreads);
+            for (auto& pool : frame.secondaryPools) {
+                if (vkCreateCommandPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+                    throw std::runtime_error("创建命令池失败！");
+                }
+            }
         }
     }
 
     void createCommandBuffers() {
-        commandBuffers.resize(swapChainFramebuffers.size());
+        commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            FrameCommandPools& frame = frameCommandPools[i];
+            VkCommandBufferAllocateInfo allocInfo = {};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = frame.primaryPool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = 1;
+
+            if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffers[i]) != VK_SUCCESS) {
+                throw std::runtime_error("分配命令缓冲区失败！");
+            }
+
+            frame.secondaries.resize(frame.secondaryPools.size());
+            for (size_t j = 0; j < frame.secondaryPools.size(); j++) {
+                allocInfo.commandPool = frame.secondaryPools[j];
+                allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+                if (vkAllocateCommandBuffers(device, &allocInfo, &frame.secondaries[j]) != VK_SUCCESS) {
+                    throw std::runtime_error("分配二级命令缓冲区失败！");
+                }
+            }
+        }
+    }
+
+    // 重置一帧的全部命令池，调用前该帧的栅栏必须已等待
+    void resetFrameCommandPools(size_t frameIndex) {
+        FrameCommandPools& frame = frameCommandPools[frameIndex];
+        vkResetCommandPool(device, frame.primaryPool, 0);
+        for (auto pool : frame.secondaryPools) {
+            vkResetCommandPool(device, pool, 0);
+        }
+    }
+
+    void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("开始命令缓冲区失败！");
+        }
+
+        gpuProfiler->beginFrame(commandBuffer, static_cast<uint32_t>(currentFrame));
 
-        VkCommandBufferAllocateInfo allocInfo = {};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.commandPool = commandPool;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+        // 只读取已发布的快照，异步加载中的资源不会出现在这里。计算剔除必须在渲染通道之外录制
+        std::shared_ptr<const ModelDrawData> drawData = model ? model->getDrawData() : nullptr;
+        bool gpuCulled = drawData && recordGpuCulling(commandBuffer, *drawData);
+        DrawMode mode = drawData ? planDraws(*drawData, gpuCulled) : DrawMode::None;
+        if (drawData) {
+            updateTextureStreaming(*drawData, mode);
+        }
+
+        // 直接绘制的数量足够多时拆成若干段，由工作线程并行录制到二级命令缓冲区
+        uint32_t chunkCount = 1;
+        if (mode == DrawMode::Direct || mode == DrawMode::PerMesh) {
+            size_t maxChunks = frameCommandPools[currentFrame].secondaries.size();
+            chunkCount = static_cast<uint32_t>(std::min(maxChunks,
+                (visibleDraws.size() + MIN_DRAWS_PER_SECONDARY - 1) / MIN_DRAWS_PER_SECONDARY));
+        }
+        if (chunkCount > 1) {
+            CpuProfileScope scope(gpuProfiler.get(), "并行录制");
+            recordSecondaryCommandBuffers(*drawData, mode, imageIndex, chunkCount);
+        }
+
+        VkRenderPassBeginInfo renderPassInfo = {};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = renderPass;
+        renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];
+        renderPassInfo.renderArea.offset = { 0, 0 };
+        renderPassInfo.renderArea.extent = swapChainExtent;
+
+        VkClearValue clearValues[2] = {};
+        clearValues[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+        clearValues[1].depthStencil = { 1.0f, 0 };
+        renderPassInfo.clearValueCount = 2;
+        renderPassInfo.pClearValues = clearValues;
+
+        uint32_t renderPassScope = gpuProfiler->beginScope(commandBuffer, "渲染通道");
+        if (chunkCount > 1) {
+            vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            vkCmdExecuteCommands(commandBuffer, chunkCount, frameCommandPools[currentFrame].secondaries.data());
+        } else {
+            vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+            if (mode != DrawMode::None) {
+                recordDraws(commandBuffer, *drawData, mode, 0, visibleDraws.size());
+            }
+        }
+
+        vkCmdEndRenderPass(commandBuffer);
+        gpuProfiler->endScope(commandBuffer, renderPassScope);
+
+        if (headless) {
+            readbackRecorded[currentFrame] = frameReadbackEnabled;
+            if (frameReadbackEnabled) {
+                recordReadback(commandBuffer, imageIndex);
+            }
+        }
+        gpuProfiler->endFrame(commandBuffer);
+
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("结束命令缓冲区失败！");
+        }
+    }
+
+    // 把离屏颜色图像复制到本帧的读回缓冲区。渲染通道已把图像转为复制源布局，
+    // 之后的屏障使复制结果在栅栏发出后对主机可见
+    void recordReadback(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+        VkBufferImageCopy region = {};
+        region.bufferOffset = 0;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = { swapChainExtent.width, swapChainExtent.height, 1 };
+        vkCmdCopyImageToBuffer(commandBuffer, swapChainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            readbackBuffers[currentFrame], 1, &region);
+
+        VkBufferMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = readbackBuffers[currentFrame];
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+            0, nullptr, 1, &barrier, 0, nullptr);
+    }
+
+    // 满足条件时录制计算剔除：共享几何缓冲区、场景与命令和实例缓冲区一一对应、不需要逐网格选择 LOD，
+    // 并且间接命令可以携带 firstInstance（输出实例缓冲区中该网格的区间）。剔除统计取该帧上一次执行的结果
+    bool recordGpuCulling(VkCommandBuffer commandBuffer, const ModelDrawData& geometry) {
+        const SceneData* scene = geometry.scene.get();
+        if (!gpuCuller || !gpuCullingEnabled || !cullingEnabled || geometry.drawCount == 0 || !scene
+            || scene->worldBoundsMin.size() != geometry.drawCount || scene->instanceMeshes.empty()
+            || geometry.instanceBuffer == VK_NULL_HANDLE || (geometry.hasLods && lodCameraSet)
+            || !drawIndirectFirstInstanceSupported) {
+            return false;
+        }
+        GpuProfileScope scope(gpuProfiler.get(), commandBuffer, "计算剔除");
+        uint32_t frame = static_cast<uint32_t>(currentFrame);
+        uint32_t instanceCount = static_cast<uint32_t>(scene->instanceMeshes.size());
+        uint32_t visible;
+        if (gpuCuller->readVisibleCount(frame, visible)) {
+            cullingStats.visible = std::min(visible, instanceCount);
+            cullingStats.culled = instanceCount - cullingStats.visible;
+        }
+        gpuCuller->record(commandBuffer, frame, geometry.indirectBuffer, geometry.drawCount, geometry.instanceBuffer,
+            geometry.scene, cullingFrustum);
+        return true;
+    }
+
+    // 确定本帧的绘制方式，需要时在 CPU 上剔除并填充 visibleDraws
+    DrawMode planDraws(const ModelDrawData& geometry, bool gpuCulled) {
+        if (geometry.packedVertices && packedPipeline == VK_NULL_HANDLE) {
+            return DrawMode::None;
+        }
+        if (geometry.drawCount > 0) {
+            if (gpuCulled) {
+                return DrawMode::GpuCulled;
+            }
+            bool culling = collectVisibleDraws(geometry);
+            // 剔除后只绘制可见网格、需要逐网格选择 LOD，或间接命令中的 firstInstance 必须为 0 时，改为直接绘制
+            if (culling || (geometry.hasLods && lodCameraSet) || !drawIndirectFirstInstanceSupported) {
+                return DrawMode::Direct;
+            }
+            return DrawMode::Indirect;
+        }
+        collectVisibleDraws(geometry);
+        return DrawMode::PerMesh;
+    }
+
+    // 录制 visibleDraws[begin, end) 的绘制，间接绘制方式忽略范围。主命令缓冲区和二级命令缓冲区共用，
+    // 二级命令缓冲区不继承管线和动态状态，因此每次都重新设置
+    void recordDraws(VkCommandBuffer commandBuffer, const ModelDrawData& geometry, DrawMode mode, size_t begin, size_t end) const {
+        VkDeviceSize offsets[2] = { 0, 0 };
+
+        // 绑定 1 为实例缓冲区，每个网格以实例化绘制引用它的可见节点，紧凑顶点格式使用对应管线。
+        // 计算剔除时绑定其输出实例缓冲区，各网格的可见实例已压缩到 firstInstance 开始的区间
+        VkBuffer buffers[2] = { VK_NULL_HANDLE, geometry.instanceBuffer };
+        if (mode == DrawMode::GpuCulled) {
+            buffers[1] = gpuCuller->getInstanceBuffer(static_cast<uint32_t>(currentFrame));
+        }
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, geometry.packedVertices ? packedPipeline : graphicsPipeline);
+
+        VkViewport viewport = {};
+        viewport.width = static_cast<float>(swapChainExtent.width);
+        viewport.height = static_cast<float>(swapChainExtent.height);
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+        VkRect2D scissor = {};
+        scissor.extent = swapChainExtent;
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+        // 逐网格缓冲区
+        if (mode == DrawMode::PerMesh) {
+            for (size_t k = begin; k < end; k++) {
+                const VisibleDraw& draw = visibleDraws[k];
+                buffers[0] = geometry.vertexBuffers[draw.mesh];
+                vkCmdBindVertexBuffers(commandBuffer, 0, 2, buffers, offsets);
+                vkCmdBindIndexBuffer(commandBuffer, geometry.indexBuffers[draw.mesh], 0, geometry.meshRanges[draw.mesh].indexType);
+                const MeshLod& lod = selectLod(geometry, draw.mesh);
+                vkCmdDrawIndexed(commandBuffer, lod.indexCount, draw.instanceCount, lod.firstIndex, 0, draw.firstInstance);
+            }
+            return;
+        }
+
+        // 共享几何缓冲区：一次绑定，间接绘制时一次提交所有网格
+        buffers[0] = geometry.unifiedVertexBuffer;
+        vkCmdBindVertexBuffers(commandBuffer, 0, 2, buffers, offsets);
+        vkCmdBindIndexBuffer(commandBuffer, geometry.unifiedIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+        if (mode == DrawMode::GpuCulled) {
+            // 计算剔除的输出：压缩后按设备写入的数量绘制，否则按固定数量绘制，没有可见实例的命令实例数为 0
+            VkBuffer commands = gpuCuller->getCommandBuffer(static_cast<uint32_t>(currentFrame));
+            if (gpuCuller->isCompact()) {
+                cmdDrawIndexedIndirectCount(commandBuffer, commands, 0, gpuCuller->getCountBuffer(static_cast<uint32_t>(currentFrame)),
+                    0, geometry.drawCount, sizeof(VkDrawIndexedIndirectCommand));
+            } else {
+                drawIndexedIndirect(commandBuffer, commands, geometry.drawCount);
+            }
+        } else if (mode == DrawMode::Direct) {
+            for (size_t k = begin; k < end; k++) {
+                const VisibleDraw& draw = visibleDraws[k];
+                const MeshLod& lod = selectLod(geometry, draw.mesh);
+                vkCmdDrawIndexed(commandBuffer, lod.indexCount, draw.instanceCount, lod.firstIndex,
+                    geometry.meshRanges[draw.mesh].vertexOffset, draw.firstInstance);
+            }
+        } else {
+            drawIndexedIndirect(commandBuffer, geometry.indirectBuffer, geometry.drawCount);
+        }
+    }
+
+    // 把 visibleDraws 均分为 chunkCount 段，作为帧关键任务并行录制到本帧的二级命令缓冲区。
+    // 渲染线程等待时也领取分段录制，工作线程被后台加载任务占满时不会卡住
+    void recordSecondaryCommandBuffers(const ModelDrawData& geometry, DrawMode mode, uint32_t imageIndex, uint32_t chunkCount) {
+        VkFramebuffer framebuffer = swapChainFramebuffers[imageIndex];
+        const VkCommandBuffer* secondaries = frameCommandPools[currentFrame].secondaries.data();
+        std::vector<std::exception_ptr> errors(chunkCount);
+
+        JobCounter counter;
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+            jobSystem->submit([this, &geometry, &errors, mode, framebuffer, secondaries, chunk, chunkCount]() {
+                try {
+                    size_t drawCount = visibleDraws.size();
+                    recordSecondaryCommandBuffer(secondaries[chunk], framebuffer, geometry, mode,
+                        drawCount * chunk / chunkCount, drawCount * (chunk + 1) / chunkCount);
+                }
+                catch (...) {
+                    errors[chunk] = std::current_exception();
+                }
+            }, JobPriority::Frame, &counter);
+        }
+        jobSystem->wait(counter);
+
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
 
-        if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
-            throw std::runtime_error("分配命令缓冲区失败！");
+    // 录制一段绘制到二级命令缓冲区。每段使用各自的命令池，不需要加锁
+    void recordSecondaryCommandBuffer(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, const ModelDrawData& geometry,
+        DrawMode mode, size_t begin, size_t end) const {
+        VkCommandBufferInheritanceInfo inheritanceInfo = {};
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass = renderPass;
+        inheritanceInfo.subpass = 0;
+        inheritanceInfo.framebuffer = framebuffer;
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("开始二级命令缓冲区失败！");
         }
+        recordDraws(commandBuffer, geometry, mode, begin, end);
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("结束二级命令缓冲区失败！");
+        }
+    }
 
-        for (size_t i = 0; i < commandBuffers.size(); i++) {
-            VkCommandBufferBeginInfo beginInfo = {};
-            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    // 按固定数量提交间接绘制命令
+    void drawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, uint32_t drawCount) const {
+        if (multiDrawIndirectSupported) {
+            vkCmdDrawIndexedIndirect(commandBuffer, buffer, 0, drawCount, sizeof(VkDrawIndexedIndirectCommand));
+        } else {
+            // 不支持 multiDrawIndirect 时 drawCount 只能为 1，逐条提交同一缓冲区中的命令
+            for (uint32_t i = 0; i < drawCount; i++) {
+                vkCmdDrawIndexedIndirect(commandBuffer, buffer, i * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+            }
+        }
+    }
 
-            if (vkBeginCommandBuffer(commandBuffers[i], &beginInfo) != VK_SUCCESS) {
-                throw std::runtime_error("开始命令缓冲区失败！");
+    // 收集本帧的绘制（按网格序号升序）并更新剔除统计，实际执行了视锥剔除时返回 true。
+    // 剔除以实例为单位，同一网格中序号连续的可见实例合并为一次实例化绘制
+    bool collectVisibleDraws(const ModelDrawData& geometry) {
+        uint32_t meshCount = static_cast<uint32_t>(geometry.meshRanges.size());
+        uint32_t instanceCount = 0;
+        for (const MeshRange& range : geometry.meshRanges) {
+            instanceCount += range.instanceCount;
+        }
+        const SceneData* scene = geometry.scene.get();
+        bool culling = cullingEnabled && scene && scene->worldBoundsMin.size() == meshCount
+            && scene->instanceMeshes.size() == instanceCount;
+
+        visibleDraws.clear();
+        if (culling) {
+            visibleInstances.clear();
+            scene->bvh.cull(cullingFrustum, scene->instanceBoundsMin, scene->instanceBoundsMax,
+                [this](uint32_t instance) { visibleInstances.push_back(instance); });
+            // 保持加载顺序绘制，避免可见集合变化时绘制顺序跳动；各网格的实例连续排列，排序后同一网格的实例相邻
+            std::sort(visibleInstances.begin(), visibleInstances.end());
+            for (uint32_t instance : visibleInstances) {
+                uint32_t mesh = scene->instanceMeshes[instance];
+                if (!visibleDraws.empty() && visibleDraws.back().mesh == mesh
+                    && visibleDraws.back().firstInstance + visibleDraws.back().instanceCount == instance) {
+                    visibleDraws.back().instanceCount++;
+                } else {
+                    visibleDraws.push_back({ mesh, instance, 1 });
+                }
+            }
+            cullingStats.visible = static_cast<uint32_t>(visibleInstances.size());
+        }
+        else {
+            for (uint32_t i = 0; i < meshCount; i++) {
+                const MeshRange& range = geometry.meshRanges[i];
+                visibleDraws.push_back({ i, range.firstInstance, range.instanceCount });
             }
+            cullingStats.visible = instanceCount;
+        }
+        cullingStats.culled = instanceCount - cullingStats.visible;
+        return culling;
+    }
 
-            VkRenderPassBeginInfo renderPassInfo = {};
-            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderPassInfo.renderPass = renderPass;
-            renderPassInfo.framebuffer = swapChainFramebuffers[i];
-            renderPassInfo.renderArea.offset = { 0, 0 };
-            renderPassInfo.renderArea.extent = swapChainExtent;
+    // 按本帧绘制的网格在屏幕上的投影大小上报流式纹理的需求，并推进流式纹理的提升和淘汰。
+    // GPU 剔除时 CPU 上没有可见集合，按全部网格上报
+    void updateTextureStreaming(const ModelDrawData& geometry, DrawMode mode) {
+        TextureStreamer* streamer = geometry.textureStreamer;
+        if (!streamer || geometry.meshTextureOffsets.size() != geometry.meshRanges.size() + 1) {
+            return;
+        }
 
-            VkClearValue clearColor = {};
-            clearColor.color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-            renderPassInfo.clearValueCount = 1;
-            renderPassInfo.pClearValues = &clearColor;
+        textureUsage.clear();
+        auto reportMesh = [&](uint32_t mesh) {
+            uint32_t begin = geometry.meshTextureOffsets[mesh];
+            uint32_t end = geometry.meshTextureOffsets[mesh + 1];
+            if (begin == end) {
+                return;
+            }
+            uint32_t size = projectedMeshSize(geometry, mesh);
+            for (uint32_t k = begin; k < end; k++) {
+                textureUsage.push_back({ geometry.meshTextures[k], size });
+            }
+        };
+        if (mode == DrawMode::GpuCulled) {
+            for (uint32_t i = 0; i < geometry.meshRanges.size(); i++) {
+                reportMesh(i);
+            }
+        } else if (mode != DrawMode::None) {
+            // 同一网格的多段绘制相邻，只上报一次
+            for (size_t k = 0; k < visibleDraws.size(); k++) {
+                if (k == 0 || visibleDraws[k].mesh != visibleDraws[k - 1].mesh) {
+                    reportMesh(visibleDraws[k].mesh);
+                }
+            }
+        }
+        streamer->reportUsage(textureUsage, frameCounter);
+        streamer->update(frameCounter);
+    }
 
-            vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-            vkCmdBindPipeline(commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-            vkCmdDraw(commandBuffers[i], 3, 1, 0, 0);
-            vkCmdEndRenderPass(commandBuffers[i]);
+    // 网格包围盒对角线投影到屏幕上的长度（像素），与 selectLod 使用相同的相机和距离。
+    // 未设置相机或相机在包围盒内时返回 UINT32_MAX，即请求最精细的层级
+    uint32_t projectedMeshSize(const ModelDrawData& geometry, uint32_t mesh) const {
+        if (!lodCameraSet) {
+            return UINT32_MAX;
+        }
+        const MeshRange& range = geometry.meshRanges[mesh];
+        glm::vec3 boundsMin = range.boundsMin;
+        glm::vec3 boundsMax = range.boundsMax;
+        const SceneData* scene = geometry.scene.get();
+        if (scene && mesh < scene->worldBoundsMin.size()) {
+            boundsMin = scene->worldBoundsMin[mesh];
+            boundsMax = scene->worldBoundsMax[mesh];
+        }
+        glm::vec3 closest = glm::clamp(lodCameraPosition, boundsMin, boundsMax);
+        float distance = glm::length(closest - lodCameraPosition);
+        if (distance <= 0.0f) {
+            return UINT32_MAX;
+        }
+        float pixelsPerUnit = static_cast<float>(swapChainExtent.height) / (2.0f * std::tan(lodVerticalFov * 0.5f) * distance);
+        float size = std::ceil(glm::length(boundsMax - boundsMin) * pixelsPerUnit);
+        return size >= 4294967040.0f ? UINT32_MAX : std::max(1u, static_cast<uint32_t>(size));
+    }
 
-            if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS) {
-                throw std::runtime_error("结束命令缓冲区失败！");
+    // 选择投影到屏幕上的简化误差不超过阈值的最粗 LOD，误差按相机到网格包围盒的最近距离投影。
+    // 有场景数据时使用全部实例的世界空间包围盒，误差按各实例中最大的缩放换算，即按离相机最近的实例选择
+    const MeshLod& selectLod(const ModelDrawData& geometry, uint32_t mesh) const {
+        const MeshRange& range = geometry.meshRanges[mesh];
+        if (!lodCameraSet || range.lodCount <= 1) {
+            return range.lods[0];
+        }
+        glm::vec3 boundsMin = range.boundsMin;
+        glm::vec3 boundsMax = range.boundsMax;
+        float scale = 1.0f;
+        const SceneData* scene = geometry.scene.get();
+        if (scene && mesh < scene->worldScales.size()) {
+            boundsMin = scene->worldBoundsMin[mesh];
+            boundsMax = scene->worldBoundsMax[mesh];
+            scale = scene->worldScales[mesh];
+        }
+        glm::vec3 closest = glm::clamp(lodCameraPosition, boundsMin, boundsMax);
+        float distance = glm::length(closest - lodCameraPosition);
+        if (distance <= 0.0f) {
+            return range.lods[0];
+        }
+        float pixelsPerUnit = static_cast<float>(swapChainExtent.height) / (2.0f * std::tan(lodVerticalFov * 0.5f) * distance);
+        for (uint32_t i = range.lodCount - 1; i > 0; i--) {
+            if (range.lods[i].error * scale * pixelsPerUnit <= lodErrorThreshold) {
+                return range.lods[i];
             }
         }
+        return range.lods[0];
     }
 
     void createSemaphores() {
@@ -576,19 +1674,26 @@ private:
     }
 
     void setupThreadPool() {
-        for (size_t i = 0; i < std::thread::hardware_concurrency(); ++i) {
-            threadPool.emplace_back([this]() {
-                while (true) {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> lock(resourceMutex);
-                        resourceCondition.wait(lock, [this]() { return !resourceTasks.empty(); });
-                        task = std::move(resourceTasks.front());
-                        resourceTasks.pop();
-                    }
-                    task();
+        jobSystem = std::make_unique<JobSystem>(std::thread::hardware_concurrency());
+    }
+
+    // 执行已到期的延迟销毁，force 为 true 时全部执行
+    void runDeferredDestroys(bool force) {
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(destroyMutex);
+            auto it = pendingDestroys.begin();
+            while (it != pendingDestroys.end()) {
+                if (force || it->first + MAX_FRAMES_IN_FLIGHT <= frameCounter) {
+                    ready.push_back(std::move(it->second));
+                    it = pendingDestroys.erase(it);
+                } else {
+                    ++it;
                 }
-            });
+            }
+        }
+        for (auto& destroy : ready) {
+            destroy();
         }
     }
 
@@ -603,12 +1708,27 @@ private:
         file.read(buffer.data(), fileSize);
     }
 
-    const char** getRequiredExtensions(uint32_t* extensionCount) {
-        static std::vector<const char*> extensions;
-        extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
-        extensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
-        *extensionCount = static_cast<uint32_t>(extensions.size());
-        return extensions.data();
+    // 窗口模式使用 GLFW 给出的表面扩展（Windows 上是 win32，Linux 上是 xcb/xlib/wayland 中的一个），
+    // 无窗口模式不需要任何表面扩展。开启验证层时额外需要 debug utils，
+    // 支持时开启 VK_KHR_get_physical_device_properties2 以查询显存预算
+    std::vector<const char*> getRequiredExtensions() {
+        std::vector<const char*> extensions;
+        if (!headless) {
+            uint32_t glfwExtensionCount = 0;
+            const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+            if (glfwExtensions == nullptr) {
+                throw std::runtime_error("GLFW 无法为当前平台提供 Vulkan 表面扩展！");
+            }
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
+        if (validationEnabled) {
+            extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        }
+        memoryProperties2Supported = isInstanceExtensionSupported(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        if (memoryProperties2Supported) {
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        }
+        return extensions;
     }
 
     void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) {
@@ -672,51 +1792,91 @@ private:
         if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
             return capabilities.currentExtent;
         } else {
-            VkExtent2D actualExtent = { width, height };
+            int width = 0;
+            int height = 0;
+            glfwGetFramebufferSize(window, &width, &height);
+            VkExtent2D actualExtent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
             actualExtent.width = std::max(capabilities.minImageExtent.width, std::min(capabilities.maxImageExtent.width, actualExtent.width));
             actualExtent.height = std::max(capabilities.minImageExtent.height, std::min(capabilities.maxImageExtent.height, actualExtent.height));
             return actualExtent;
         }
     }
 
-    struct QueueFamilyIndices {
-        std::optional<uint32_t> graphicsFamily;
-        std::optional<uint32_t> presentFamily;
-
-        bool isComplete() {
-            return graphicsFamily.has_value() && presentFamily.has_value();
-        }
-    };
-
-    struct SwapChainSupportDetails {
-        VkSurfaceCapabilitiesKHR capabilities;
-        std::vector<VkSurfaceFormatKHR> formats;
-        std::vector<VkPresentModeKHR> presentModes;
-    };
+    // 每个二级命令缓冲区至少录制的绘制数量，绘制较少时并行录制的调度开销大于收益
+    static constexpr size_t MIN_DRAWS_PER_SECONDARY = 256;
 
     VkInstance instance;
+    VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;  // 未开启验证层时为空
+    bool validationEnabled = false;  // 是否开启了验证层
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkDevice device;
-    VkSurfaceKHR surface;
-    VkSwapchainKHR swapChain;
+    VkQueue graphicsQueue;
+    VkQueue presentQueue;  // 无窗口模式下与图形队列相同
+    GLFWwindow* window = nullptr;  // 无窗口模式下为空
+    VkSurfaceKHR surface = VK_NULL_HANDLE;  // 无窗口模式下为空
+    VkSwapchainKHR swapChain = VK_NULL_HANDLE;  // 无窗口模式下为空
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
-    std::vector<VkImage> swapChainImages;
+    std::vector<VkImage> swapChainImages;  // 交换链图像，无窗口模式下为离屏颜色图像
     std::vector<VkImageView> swapChainImageViews;
+    bool headless = false;  // 无窗口模式：渲染到离屏图像，不创建表面和交换链
+    std::vector<MemoryAllocation> offscreenImageAllocations;  // 离屏颜色图像的内存
+    std::vector<VkBuffer> readbackBuffers;  // 每个飞行中帧的读回缓冲区，仅无窗口模式
+    std::vector<MemoryAllocation> readbackAllocations;
+    std::vector<bool> readbackRecorded;  // 该帧最近一次录制是否包含读回复制
+    bool frameReadbackEnabled = false;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    VkImage depthImage = VK_NULL_HANDLE;
+    MemoryAllocation depthImageAllocation;
+    VkImageView depthImageView = VK_NULL_HANDLE;
     VkRenderPass renderPass;
     VkPipelineLayout pipelineLayout;
     VkPipeline graphicsPipeline;
-    VkCommandPool commandPool;
-    std::vector<VkCommandBuffer> commandBuffers;
+    VkPipeline packedPipeline = VK_NULL_HANDLE;  // PackedVertex 格式的管线，缺少对应着色器时为空
+    std::vector<VkCommandBuffer> commandBuffers;  // 每帧的主命令缓冲区，分配自该帧的主命令池
     std::vector<VkFramebuffer> swapChainFramebuffers;
     std::vector<VkSemaphore> imageAvailableSemaphore;
     std::vector<VkSemaphore> renderFinishedSemaphore;
     std::vector<VkFence> inFlightFences;
+    std::unique_ptr<DeviceMemoryAllocator> allocator;
+    std::shared_ptr<ResourceCache> resourceCache;  // 按内容去重的纹理和网格，所有 ModelLoader 共享
+    const ModelLoader* model = nullptr;
+    bool lodCameraSet = false;  // 是否设置了 LOD 选择使用的相机
+    glm::vec3 lodCameraPosition = glm::vec3(0.0f);
+    float lodVerticalFov = 0.785398f;  // 垂直视场角（弧度）
+    float lodErrorThreshold = 1.0f;  // 允许的屏幕空间误差（像素）
+    bool cullingEnabled = false;  // 是否设置了视锥剔除使用的相机
+    Frustum cullingFrustum = {};  // 世界空间视锥
+    std::vector<VisibleDraw> visibleDraws;  // 本帧的绘制，跨帧复用
+    std::vector<uint32_t> visibleInstances;  // 本帧可见的实例序号，跨帧复用
+    CullingStats cullingStats;  // 最近一帧的剔除统计
+    bool multiDrawIndirectSupported = false;
+    bool drawIndirectFirstInstanceSupported = false;
+    bool drawIndirectCountSupported = false;  // 是否启用了 VK_KHR_draw_indirect_count
+    PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount = nullptr;
+    std::unique_ptr<GpuCuller> gpuCuller;  // 计算着色器剔除，缺少剔除着色器时为空
+    bool gpuCullingEnabled = true;  // 是否优先使用 GPU 剔除
+    std::vector<FrameCommandPools> frameCommandPools;  // 每个飞行中帧的命令池
+    std::unique_ptr<GpuProfiler> gpuProfiler;  // 时间戳查询和 CPU 区域计时
+    std::unique_ptr<PersistentPipelineCache> pipelineCache;  // 所有管线创建共用的缓存
+    std::string pipelineCachePath = "pipeline_cache.bin";  // 管线缓存文件
+    std::chrono::steady_clock::time_point initStartTime;  // init 开始时间
+    double firstFrameMilliseconds = 0.0;  // 首帧耗时
+    float maxSamplerAnisotropy = 0.0f;
+    bool memoryProperties2Supported = false;  // 是否启用了 VK_KHR_get_physical_device_properties2
+    bool memoryBudgetSupported = false;  // 是否启用了 VK_EXT_memory_budget
+    std::vector<TextureUsage> textureUsage;  // 本帧上报给流式纹理的使用情况，跨帧复用
+    std::mutex queueMutex;  // 图形队列提交锁，与 ModelLoader 共享
+    VkQueue transferQueue = VK_NULL_HANDLE;  // 独立传输队列，设备没有时为空
+    int transferQueueFamily = -1;
+    std::mutex transferQueueMutex;  // 传输队列提交锁，多个 ModelLoader 共享
+    std::vector<VkCommandPool> loaderCommandPools;
+    size_t currentFrame = 0;
+    std::atomic<uint64_t> frameCounter{ 0 };  // 已提交的帧数，渲染线程递增，加载线程在 deferDestroy 中读取
+    std::mutex destroyMutex;
+    std::vector<std::pair<uint64_t, std::function<void()>>> pendingDestroys;
 
-    static const int MAX_FRAMES_IN_FLIGHT = 2;
+    static constexpr size_t MAX_FRAMES_IN_FLIGHT = 2;
 
-    std::vector<std::thread> threadPool;
-    std::queue<std::function<void()>> resourceTasks;
-    std::mutex resourceMutex;
-    std::condition_variable resourceCondition;
+    std::unique_ptr<JobSystem> jobSystem;  // 工作窃取任务系统，负责加载任务和并行命令录制
 };